@@ -69,6 +69,10 @@ extern "C" {
 #define ZIP_CHECKCONS 4
 #define ZIP_TRUNCATE 8
 #define ZIP_RDONLY 16
+#define ZIP_LAZY 32
+#define ZIP_PARALLEL 64
+#define ZIP_INDEX 128
+#define ZIP_MMAP 256
 
 
 /* flags for zip_name_locate, zip_fopen, zip_stat, ... */
@@ -88,6 +92,8 @@ extern "C" {
 #define ZIP_FL_ENC_UTF_8 2048u /* string is UTF-8 encoded */
 #define ZIP_FL_ENC_CP437 4096u /* string is CP437 encoded */
 #define ZIP_FL_OVERWRITE 8192u /* zip_file_add: if file with name exists, overwrite (replace) it */
+#define ZIP_FL_RECURSIVE 16384u /* zip_dir_list_open: list all entries below directory */
+#define ZIP_FL_UNORDERED 32768u /* zip_read_files: report files as they are read, not in order */
 
 /* archive global flags flags */
 
@@ -173,6 +179,10 @@ extern "C" {
 #define ZIP_CM_WAVPACK 97 /* WavPack compressed data */
 #define ZIP_CM_PPMD 98    /* PPMd version I, Rev 1 */
 
+/* compression flags for ZIP_CM_ZSTD, or'ed with compression level */
+
+#define ZIP_CF_ZSTD_FRAME_SIZE(kb) (((zip_uint32_t)(kb)&0x7fffu) << 16) /* independent frames of kb KiB with seek table */
+
 /* encryption methods */
 
 #define ZIP_EM_NONE 0         /* not encrypted */
@@ -238,7 +248,10 @@ enum zip_source_cmd {
     ZIP_SOURCE_BEGIN_WRITE_CLONING, /* like ZIP_SOURCE_BEGIN_WRITE, but keep part of original file */
     ZIP_SOURCE_ACCEPT_EMPTY,        /* whether empty files are valid archives */
     ZIP_SOURCE_GET_FILE_ATTRIBUTES, /* get additional file attributes */
-    ZIP_SOURCE_SUPPORTS_REOPEN      /* allow reading from changed entry */
+    ZIP_SOURCE_SUPPORTS_REOPEN,     /* allow reading from changed entry */
+    ZIP_SOURCE_READ_AT,             /* read data at offset, without changing read position */
+    ZIP_SOURCE_GET_DATA,            /* get pointer to data at offset, without copying */
+    ZIP_SOURCE_ADVISE               /* hint that data will be read soon */
 };
 typedef enum zip_source_cmd zip_source_cmd_t;
 
@@ -278,6 +291,33 @@ struct zip_source_args_seek {
 };
 
 typedef struct zip_source_args_seek zip_source_args_seek_t;
+
+struct zip_source_args_read_at {
+    void *_Nonnull data;  /* buffer to read into */
+    zip_uint64_t length;  /* number of bytes to read */
+    zip_uint64_t offset;  /* offset to read from, relative to start of data */
+};
+
+typedef struct zip_source_args_read_at zip_source_args_read_at_t;
+
+struct zip_source_args_get_data {
+    const void *_Nullable data; /* set by source to data at offset */
+    zip_uint64_t length;        /* number of bytes needed */
+    zip_uint64_t offset;        /* offset of data, relative to start of data */
+};
+
+typedef struct zip_source_args_get_data zip_source_args_get_data_t;
+
+#define ZIP_SOURCE_ADVICE_WILLNEED 0   /* data will be read soon */
+#define ZIP_SOURCE_ADVICE_SEQUENTIAL 1 /* data will be read soon, from start to end */
+
+struct zip_source_args_advise {
+    zip_uint64_t offset; /* offset of data, relative to start of data */
+    zip_uint64_t length; /* length of data */
+    int advice;          /* ZIP_SOURCE_ADVICE_* */
+};
+
+typedef struct zip_source_args_advise zip_source_args_advise_t;
 #define ZIP_SOURCE_GET_ARGS(type, data, len, error) ((len) < sizeof(type) ? zip_error_set((error), ZIP_ER_INVAL, 0), (type *)NULL : (type *)(data))
 
 
@@ -334,16 +374,35 @@ struct zip_file_attributes {
 #define ZIP_FILE_ATTRIBUTES_EXTERNAL_FILE_ATTRIBUTES 0x0008u
 #define ZIP_FILE_ATTRIBUTES_GENERAL_PURPOSE_BIT_FLAGS 0x0010u
 
+struct zip_memory_usage {
+    zip_uint64_t size;              /* set by caller to sizeof(zip_memory_usage_t) */
+    zip_uint64_t archive;           /* archive structure, archive comment, open source list */
+    zip_uint64_t entries;           /* entry table and directory entries */
+    zip_uint64_t strings;           /* file names and comments, including converted copies */
+    zip_uint64_t extra_fields;      /* parsed extra fields */
+    zip_uint64_t name_lookup;       /* name hash table and indexes for name lookup and directory listing */
+    zip_uint64_t central_directory; /* raw central directory kept for ZIP_LAZY */
+    zip_uint64_t sources;           /* archive source and sources of added or replaced entries */
+    zip_uint64_t checkpoints;       /* checkpoints for reading deflated files from the middle */
+    zip_uint64_t unused;            /* allocated for directory entries but not in use */
+    zip_uint64_t total;             /* sum of all of the above */
+};
+
 struct zip;
+struct zip_dir_list;
 struct zip_file;
 struct zip_source;
+struct zip_stream;
 
 typedef struct zip zip_t;
+typedef struct zip_dir_list zip_dir_list_t;
 typedef struct zip_error zip_error_t;
 typedef struct zip_file zip_file_t;
 typedef struct zip_file_attributes zip_file_attributes_t;
+typedef struct zip_memory_usage zip_memory_usage_t;
 typedef struct zip_source zip_source_t;
 typedef struct zip_stat zip_stat_t;
+typedef struct zip_stream zip_stream_t;
 typedef struct zip_buffer_fragment zip_buffer_fragment_t;
 
 typedef zip_uint32_t zip_flags_t;
@@ -352,6 +411,7 @@ typedef zip_int64_t (*zip_source_callback)(void *_Nullable, void *_Nullable, zip
 typedef zip_int64_t (*zip_source_layered_callback)(zip_source_t *_Nonnull, void *_Nullable, void *_Nullable, zip_uint64_t, enum zip_source_cmd);
 typedef void (*zip_progress_callback)(zip_t *_Nonnull, double, void *_Nullable);
 typedef int (*zip_cancel_callback)(zip_t *_Nonnull, void *_Nullable);
+typedef int (*zip_read_files_callback)(zip_t *_Nonnull, zip_uint64_t, const void *_Nullable, zip_uint64_t, void *_Nullable);
 
 #ifndef ZIP_DISABLE_DEPRECATED
 typedef void (*zip_progress_callback_t)(double);
@@ -373,6 +433,10 @@ ZIP_EXTERN void zip_file_error_get(zip_file_t *_Nonnull, int *_Nullable, int *_N
 ZIP_EXTERN int zip_close(zip_t *_Nonnull);
 ZIP_EXTERN int zip_delete(zip_t *_Nonnull, zip_uint64_t);
 ZIP_EXTERN zip_int64_t zip_dir_add(zip_t *_Nonnull, const char *_Nonnull, zip_flags_t);
+ZIP_EXTERN int zip_dir_exists(zip_t *_Nonnull, const char *_Nonnull, zip_flags_t);
+ZIP_EXTERN void zip_dir_list_close(zip_dir_list_t *_Nullable);
+ZIP_EXTERN const char *_Nullable zip_dir_list_next(zip_dir_list_t *_Nonnull, zip_int64_t *_Nullable);
+ZIP_EXTERN zip_dir_list_t *_Nullable zip_dir_list_open(zip_t *_Nonnull, const char *_Nullable, zip_flags_t);
 ZIP_EXTERN void zip_discard(zip_t *_Nonnull);
 
 ZIP_EXTERN zip_error_t *_Nonnull zip_get_error(zip_t *_Nonnull);
@@ -401,11 +465,16 @@ ZIP_EXTERN zip_int16_t zip_file_extra_fields_count_by_id(zip_t *_Nonnull, zip_ui
 ZIP_EXTERN const zip_uint8_t *_Nullable zip_file_extra_field_get(zip_t *_Nonnull, zip_uint64_t, zip_uint16_t, zip_uint16_t *_Nullable, zip_uint16_t *_Nullable, zip_flags_t);
 ZIP_EXTERN const zip_uint8_t *_Nullable zip_file_extra_field_get_by_id(zip_t *_Nonnull, zip_uint64_t, zip_uint16_t, zip_uint16_t, zip_uint16_t *_Nullable, zip_flags_t);
 ZIP_EXTERN const char *_Nullable zip_file_get_comment(zip_t *_Nonnull, zip_uint64_t, zip_uint32_t *_Nullable, zip_flags_t);
+ZIP_EXTERN zip_int64_t zip_file_get_checkpoints(zip_t *_Nonnull, zip_uint64_t, void *_Nullable, zip_uint64_t);
+ZIP_EXTERN const void *_Nullable zip_file_get_data(zip_t *_Nonnull, zip_uint64_t, zip_uint64_t *_Nullable, zip_flags_t);
 ZIP_EXTERN zip_error_t *_Nonnull zip_file_get_error(zip_file_t *_Nonnull);
 ZIP_EXTERN int zip_file_get_external_attributes(zip_t *_Nonnull, zip_uint64_t, zip_flags_t, zip_uint8_t *_Nullable, zip_uint32_t *_Nullable);
+ZIP_EXTERN zip_uint64_t zip_file_get_memory_usage(zip_file_t *_Nonnull);
 ZIP_EXTERN int zip_file_is_seekable(zip_file_t *_Nonnull);
+ZIP_EXTERN zip_int64_t zip_file_read_all(zip_t *_Nonnull, zip_uint64_t, void *_Nullable, zip_uint64_t, zip_flags_t);
 ZIP_EXTERN int zip_file_rename(zip_t *_Nonnull, zip_uint64_t, const char *_Nonnull, zip_flags_t);
 ZIP_EXTERN int zip_file_replace(zip_t *_Nonnull, zip_uint64_t, zip_source_t *_Nonnull, zip_flags_t);
+ZIP_EXTERN int zip_file_set_checkpoints(zip_t *_Nonnull, zip_uint64_t, const void *_Nonnull, zip_uint64_t);
 ZIP_EXTERN int zip_file_set_comment(zip_t *_Nonnull, zip_uint64_t, const char *_Nullable, zip_uint16_t, zip_flags_t);
 ZIP_EXTERN int zip_file_set_dostime(zip_t *_Nonnull, zip_uint64_t, zip_uint16_t, zip_uint16_t, zip_flags_t);
 ZIP_EXTERN int zip_file_set_encryption(zip_t *_Nonnull, zip_uint64_t, zip_uint16_t, const char *_Nullable);
@@ -422,17 +491,25 @@ ZIP_EXTERN zip_int64_t zip_ftell(zip_file_t *_Nonnull);
 ZIP_EXTERN const char *_Nullable zip_get_archive_comment(zip_t *_Nonnull, int *_Nullable, zip_flags_t);
 ZIP_EXTERN int zip_get_archive_flag(zip_t *_Nonnull, zip_flags_t, zip_flags_t);
 ZIP_EXTERN const char *_Nullable zip_get_name(zip_t *_Nonnull, zip_uint64_t, zip_flags_t);
+ZIP_EXTERN zip_int64_t zip_get_index(zip_t *_Nonnull, void *_Nullable, zip_uint64_t);
+ZIP_EXTERN int zip_get_memory_usage(zip_t *_Nonnull, zip_memory_usage_t *_Nonnull);
 ZIP_EXTERN zip_int64_t zip_get_num_entries(zip_t *_Nonnull, zip_flags_t);
 ZIP_EXTERN const char *_Nonnull zip_libzip_version(void);
 ZIP_EXTERN zip_int64_t zip_name_locate(zip_t *_Nonnull, const char *_Nonnull, zip_flags_t);
+ZIP_EXTERN zip_int64_t zip_name_locate_many(zip_t *_Nonnull, const char *_Nonnull const *_Nullable, zip_uint64_t, zip_int64_t *_Nullable, zip_flags_t);
 ZIP_EXTERN zip_t *_Nullable zip_open(const char *_Nonnull, int, int *_Nullable);
 ZIP_EXTERN zip_t *_Nullable zip_open_from_source(zip_source_t *_Nonnull, int, zip_error_t *_Nullable);
+ZIP_EXTERN zip_t *_Nullable zip_open_from_source_with_index(zip_source_t *_Nonnull, int, const void *_Nullable, zip_uint64_t, zip_error_t *_Nullable);
+ZIP_EXTERN int zip_read_files(zip_t *_Nonnull, const zip_uint64_t *_Nonnull, zip_uint64_t, zip_flags_t, zip_uint64_t, zip_read_files_callback _Nonnull, void *_Nullable);
+ZIP_EXTERN int zip_refresh(zip_t *_Nonnull, zip_source_t *_Nullable);
 ZIP_EXTERN int zip_register_progress_callback_with_state(zip_t *_Nonnull, double, zip_progress_callback _Nullable, void (*_Nullable)(void *_Nullable), void *_Nullable);
 ZIP_EXTERN int zip_register_cancel_callback_with_state(zip_t *_Nonnull, zip_cancel_callback _Nullable, void (*_Nullable)(void *_Nullable), void *_Nullable);
 ZIP_EXTERN int zip_set_archive_comment(zip_t *_Nonnull, const char *_Nullable, zip_uint16_t);
 ZIP_EXTERN int zip_set_archive_flag(zip_t *_Nonnull, zip_flags_t, int);
+ZIP_EXTERN int zip_set_checkpoint_interval(zip_t *_Nonnull, zip_uint64_t);
 ZIP_EXTERN int zip_set_default_password(zip_t *_Nonnull, const char *_Nullable);
 ZIP_EXTERN int zip_set_file_compression(zip_t *_Nonnull, zip_uint64_t, zip_int32_t, zip_uint32_t);
+ZIP_EXTERN int zip_set_readahead(zip_t *_Nonnull, zip_uint64_t);
 ZIP_EXTERN int zip_source_begin_write(zip_source_t *_Nonnull);
 ZIP_EXTERN int zip_source_begin_write_cloning(zip_source_t *_Nonnull, zip_uint64_t);
 ZIP_EXTERN zip_source_t *_Nullable zip_source_buffer(zip_t *_Nonnull, const void *_Nullable, zip_uint64_t, int);
@@ -458,6 +535,7 @@ ZIP_EXTERN zip_int64_t zip_source_make_command_bitmap(zip_source_cmd_t, ...);
 ZIP_EXTERN int zip_source_open(zip_source_t *_Nonnull);
 ZIP_EXTERN zip_int64_t zip_source_pass_to_lower_layer(zip_source_t *_Nonnull, void *_Nullable, zip_uint64_t, zip_source_cmd_t);
 ZIP_EXTERN zip_int64_t zip_source_read(zip_source_t *_Nonnull, void *_Nonnull, zip_uint64_t);
+ZIP_EXTERN zip_int64_t zip_source_read_at(zip_source_t *_Nonnull, void *_Nonnull, zip_uint64_t, zip_uint64_t);
 ZIP_EXTERN void zip_source_rollback_write(zip_source_t *_Nonnull);
 ZIP_EXTERN int zip_source_seek(zip_source_t *_Nonnull, zip_int64_t, int);
 ZIP_EXTERN zip_int64_t zip_source_seek_compute_offset(zip_uint64_t, zip_uint64_t, void *_Nonnull, zip_uint64_t, zip_error_t *_Nullable);
@@ -480,10 +558,17 @@ ZIP_EXTERN zip_source_t *_Nullable zip_source_zip_create(zip_t *_Nonnull, zip_ui
 ZIP_EXTERN int zip_stat(zip_t *_Nonnull, const char *_Nonnull, zip_flags_t, zip_stat_t *_Nonnull);
 ZIP_EXTERN int zip_stat_index(zip_t *_Nonnull, zip_uint64_t, zip_flags_t, zip_stat_t *_Nonnull);
 ZIP_EXTERN void zip_stat_init(zip_stat_t *_Nonnull);
+ZIP_EXTERN void zip_stream_close(zip_stream_t *_Nullable);
+ZIP_EXTERN zip_file_t *_Nullable zip_stream_fopen(zip_stream_t *_Nonnull, zip_flags_t);
+ZIP_EXTERN zip_error_t *_Nonnull zip_stream_get_error(zip_stream_t *_Nonnull);
+ZIP_EXTERN int zip_stream_next(zip_stream_t *_Nonnull, zip_stat_t *_Nullable);
+ZIP_EXTERN zip_stream_t *_Nullable zip_stream_open(zip_source_t *_Nonnull, zip_error_t *_Nullable);
+ZIP_EXTERN int zip_stream_set_default_password(zip_stream_t *_Nonnull, const char *_Nullable);
 ZIP_EXTERN const char *_Nonnull zip_strerror(zip_t *_Nonnull);
 ZIP_EXTERN int zip_unchange(zip_t *_Nonnull, zip_uint64_t);
 ZIP_EXTERN int zip_unchange_all(zip_t *_Nonnull);
 ZIP_EXTERN int zip_unchange_archive(zip_t *_Nonnull);
+ZIP_EXTERN int zip_write_index(zip_t *_Nonnull, const char *_Nonnull);
 ZIP_EXTERN int zip_compression_method_supported(zip_int32_t method, int compress);
 ZIP_EXTERN int zip_encryption_method_supported(zip_uint16_t method, int encode);
 
@@ -43,6 +43,7 @@ struct ctx {
     int compression_flags;
     bool end_of_input;
     bz_stream zstr;
+    zip_uint64_t memory; /* memory allocated by libbz2 */
 };
 
 
@@ -57,6 +58,25 @@ maximum_compressed_size(zip_uint64_t uncompressed_size) {
 }
 
 
+static void *
+bzip2_alloc(void *opaque, int items, int size) {
+    struct ctx *ctx = (struct ctx *)opaque;
+
+    if (items < 0 || size < 0) {
+        return NULL;
+    }
+    return _zip_memory_alloc(&ctx->memory, (zip_uint64_t)items * (zip_uint64_t)size);
+}
+
+
+static void
+bzip2_free(void *opaque, void *ptr) {
+    struct ctx *ctx = (struct ctx *)opaque;
+
+    _zip_memory_free(&ctx->memory, ptr);
+}
+
+
 static void *
 allocate(bool compress, int compression_flags, zip_error_t *error) {
     struct ctx *ctx;
@@ -73,9 +93,10 @@ allocate(bool compress, int compression_flags, zip_error_t *error) {
     }
     ctx->end_of_input = false;
 
-    ctx->zstr.bzalloc = NULL;
-    ctx->zstr.bzfree = NULL;
-    ctx->zstr.opaque = NULL;
+    ctx->memory = 0;
+    ctx->zstr.bzalloc = bzip2_alloc;
+    ctx->zstr.bzfree = bzip2_free;
+    ctx->zstr.opaque = ctx;
 
     return ctx;
 }
@@ -144,6 +165,7 @@ start(void *ud, zip_stat_t *st, zip_file_attributes_t *attributes) {
     struct ctx *ctx = (struct ctx *)ud;
     int ret;
 
+    ctx->end_of_input = false;
     ctx->zstr.avail_in = 0;
     ctx->zstr.next_in = NULL;
     ctx->zstr.avail_out = 0;
@@ -255,6 +277,14 @@ process(void *ud, zip_uint8_t *data, zip_uint64_t *length) {
     }
 }
 
+
+static zip_uint64_t
+memory_usage(void *ud) {
+    struct ctx *ctx = (struct ctx *)ud;
+
+    return sizeof(*ctx) + ctx->memory;
+}
+
 /* clang-format off */
 
 zip_compression_algorithm_t zip_algorithm_bzip2_compress = {
@@ -267,7 +297,8 @@ zip_compression_algorithm_t zip_algorithm_bzip2_compress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 
@@ -281,7 +312,8 @@ zip_compression_algorithm_t zip_algorithm_bzip2_decompress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 /* clang-format on */
@@ -42,7 +42,9 @@ struct ctx {
     bool compress;
     int compression_flags;
     bool end_of_input;
+    bool initialized; /* inflate state is kept between uses and only reset */
     z_stream zstr;
+    zip_uint64_t memory; /* memory allocated by zlib */
 };
 
 
@@ -59,6 +61,22 @@ maximum_compressed_size(zip_uint64_t uncompressed_size) {
 }
 
 
+static voidpf
+zlib_alloc(voidpf opaque, uInt items, uInt size) {
+    struct ctx *ctx = (struct ctx *)opaque;
+
+    return _zip_memory_alloc(&ctx->memory, (zip_uint64_t)items * size);
+}
+
+
+static void
+zlib_free(voidpf opaque, voidpf ptr) {
+    struct ctx *ctx = (struct ctx *)opaque;
+
+    _zip_memory_free(&ctx->memory, ptr);
+}
+
+
 static void *
 allocate(bool compress, int compression_flags, zip_error_t *error) {
     struct ctx *ctx;
@@ -75,10 +93,12 @@ allocate(bool compress, int compression_flags, zip_error_t *error) {
         ctx->compression_flags = Z_BEST_COMPRESSION;
     }
     ctx->end_of_input = false;
+    ctx->initialized = false;
 
-    ctx->zstr.zalloc = Z_NULL;
-    ctx->zstr.zfree = Z_NULL;
-    ctx->zstr.opaque = NULL;
+    ctx->memory = 0;
+    ctx->zstr.zalloc = zlib_alloc;
+    ctx->zstr.zfree = zlib_free;
+    ctx->zstr.opaque = ctx;
 
     return ctx;
 }
@@ -100,6 +120,9 @@ static void
 deallocate(void *ud) {
     struct ctx *ctx = (struct ctx *)ud;
 
+    if (ctx->initialized) {
+        (void)inflateEnd(&ctx->zstr);
+    }
     free(ctx);
 }
 
@@ -127,6 +150,7 @@ start(void *ud, zip_stat_t *st, zip_file_attributes_t *attributes) {
     struct ctx *ctx = (struct ctx *)ud;
     int ret;
 
+    ctx->end_of_input = false;
     ctx->zstr.avail_in = 0;
     ctx->zstr.next_in = NULL;
     ctx->zstr.avail_out = 0;
@@ -136,6 +160,9 @@ start(void *ud, zip_stat_t *st, zip_file_attributes_t *attributes) {
         /* negative value to tell zlib not to write a header */
         ret = deflateInit2(&ctx->zstr, ctx->compression_flags, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
     }
+    else if (ctx->initialized) {
+        ret = inflateReset(&ctx->zstr);
+    }
     else {
         ret = inflateInit2(&ctx->zstr, -MAX_WBITS);
     }
@@ -144,7 +171,9 @@ start(void *ud, zip_stat_t *st, zip_file_attributes_t *attributes) {
         zip_error_set(ctx->error, ZIP_ER_ZLIB, ret);
         return false;
     }
-
+    if (!ctx->compress) {
+        ctx->initialized = true;
+    }
 
     return true;
 }
@@ -155,13 +184,13 @@ end(void *ud) {
     struct ctx *ctx = (struct ctx *)ud;
     int err;
 
-    if (ctx->compress) {
-        err = deflateEnd(&ctx->zstr);
-    }
-    else {
-        err = inflateEnd(&ctx->zstr);
+    if (!ctx->compress) {
+        /* keep window and state for next start, freed in deallocate */
+        return true;
     }
 
+    err = deflateEnd(&ctx->zstr);
+
     if (err != Z_OK) {
         zip_error_set(ctx->error, ZIP_ER_ZLIB, err);
         return false;
@@ -235,6 +264,14 @@ process(void *ud, zip_uint8_t *data, zip_uint64_t *length) {
     }
 }
 
+
+static zip_uint64_t
+memory_usage(void *ud) {
+    struct ctx *ctx = (struct ctx *)ud;
+
+    return sizeof(*ctx) + ctx->memory;
+}
+
 /* clang-format off */
 
 zip_compression_algorithm_t zip_algorithm_deflate_compress = {
@@ -247,7 +284,8 @@ zip_compression_algorithm_t zip_algorithm_deflate_compress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 
@@ -261,7 +299,8 @@ zip_compression_algorithm_t zip_algorithm_deflate_decompress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 /* clang-format on */
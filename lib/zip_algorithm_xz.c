@@ -56,6 +56,8 @@ struct ctx {
     zip_uint32_t compression_flags;
     bool end_of_input;
     lzma_stream zstr;
+    lzma_allocator allocator;
+    zip_uint64_t memory; /* memory allocated by liblzma */
     zip_uint16_t method;
     /* header member is used for converting from zip to "lzma alone"
      * format
@@ -103,6 +105,25 @@ maximum_compressed_size(zip_uint64_t uncompressed_size) {
 }
 
 
+static void *
+xz_alloc(void *opaque, size_t items, size_t size) {
+    struct ctx *ctx = (struct ctx *)opaque;
+
+    if (size != 0 && items > SIZE_MAX / size) {
+        return NULL;
+    }
+    return _zip_memory_alloc(&ctx->memory, (zip_uint64_t)items * size);
+}
+
+
+static void
+xz_free(void *opaque, void *ptr) {
+    struct ctx *ctx = (struct ctx *)opaque;
+
+    _zip_memory_free(&ctx->memory, ptr);
+}
+
+
 static void *
 allocate(bool compress, int compression_flags, zip_error_t *error, zip_uint16_t method) {
     struct ctx *ctx;
@@ -123,13 +144,13 @@ allocate(bool compress, int compression_flags, zip_error_t *error, zip_uint16_t
     ctx->end_of_input = false;
     memset(ctx->header, 0, sizeof(ctx->header));
     ctx->header_bytes_offset = 0;
-    if (ZIP_CM_LZMA) {
-        ctx->header_state = INCOMPLETE;
-    }
-    else {
-        ctx->header_state = DONE;
-    }
+    ctx->header_state = INCOMPLETE;
     memset(&ctx->zstr, 0, sizeof(ctx->zstr));
+    ctx->memory = 0;
+    ctx->allocator.alloc = xz_alloc;
+    ctx->allocator.free = xz_free;
+    ctx->allocator.opaque = ctx;
+    ctx->zstr.allocator = &ctx->allocator;
     ctx->method = method;
     return ctx;
 }
@@ -150,6 +171,7 @@ decompress_allocate(zip_uint16_t method, int compression_flags, zip_error_t *err
 static void
 deallocate(void *ud) {
     struct ctx *ctx = (struct ctx *)ud;
+    lzma_end(&ctx->zstr);
     free(ctx);
 }
 
@@ -201,11 +223,15 @@ start(void *ud, zip_stat_t *st, zip_file_attributes_t *attributes) {
         {.id = LZMA_VLI_UNKNOWN, .options = NULL},
     };
 
+    ctx->end_of_input = false;
+    ctx->header_bytes_offset = 0;
+    ctx->header_state = INCOMPLETE;
     ctx->zstr.avail_in = 0;
     ctx->zstr.next_in = NULL;
     ctx->zstr.avail_out = 0;
     ctx->zstr.next_out = NULL;
 
+    /* for decompression, liblzma reuses the memory of the previous decoder */
     if (ctx->compress) {
         if (ctx->method == ZIP_CM_LZMA)
             ret = lzma_alone_encoder(&ctx->zstr, filters[0].options);
@@ -240,7 +266,10 @@ static bool
 end(void *ud) {
     struct ctx *ctx = (struct ctx *)ud;
 
-    lzma_end(&ctx->zstr);
+    if (ctx->compress) {
+        lzma_end(&ctx->zstr);
+    }
+    /* decoder is kept for next start, freed in deallocate */
     return true;
 }
 
@@ -372,6 +401,15 @@ process(void *ud, zip_uint8_t *data, zip_uint64_t *length) {
     }
 }
 
+
+static zip_uint64_t
+memory_usage(void *ud) {
+    struct ctx *ctx = (struct ctx *)ud;
+
+    return sizeof(*ctx) + ctx->memory;
+}
+
+
 /* Version Required should be set to 63 (6.3) because this compression
    method was only defined in appnote.txt version 6.3.8, but Winzip
    does not unpack it if the value is not 20. */
@@ -388,7 +426,8 @@ zip_compression_algorithm_t zip_algorithm_xz_compress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 
@@ -402,7 +441,8 @@ zip_compression_algorithm_t zip_algorithm_xz_decompress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 /* clang-format on */
@@ -47,8 +47,21 @@ struct ctx {
     ZSTD_CStream *zcstream;
     ZSTD_outBuffer out;
     ZSTD_inBuffer in;
+
+    /* seekable format: independent frames followed by seek table */
+    zip_uint64_t frame_size;     /* uncompressed size of frames, 0 for one frame */
+    zip_uint64_t frame_in;       /* uncompressed data in current frame */
+    zip_uint64_t frame_out;      /* compressed data of current frame */
+    zip_uint32_t *frames;        /* compressed and uncompressed size of finished frames */
+    zip_uint64_t nframes;
+    zip_uint64_t nframes_alloc;
+    zip_buffer_t *seek_table;    /* seek table frame being output, NULL before end of data */
 };
 
+static bool add_frame(struct ctx *ctx);
+static bool create_seek_table(struct ctx *ctx);
+static zip_compression_status_t process_seekable(struct ctx *ctx, zip_uint8_t *data, zip_uint64_t *length);
+
 static zip_uint64_t
 maximum_compressed_size(zip_uint64_t uncompressed_size) {
     return ZSTD_compressBound(uncompressed_size);
@@ -58,7 +71,9 @@ maximum_compressed_size(zip_uint64_t uncompressed_size) {
 static void *
 allocate(bool compress, int compression_flags, zip_error_t *error) {
     struct ctx *ctx;
+    zip_uint64_t frame_size = ((zip_uint32_t)compression_flags >> 16) * 1024;
 
+    compression_flags &= 0xffff;
     /* 0: let zstd choose */
     if (compression_flags < ZSTD_minCLevel() || compression_flags > ZSTD_maxCLevel()) {
         compression_flags = 0;
@@ -82,6 +97,14 @@ allocate(bool compress, int compression_flags, zip_error_t *error) {
     ctx->out.pos = 0;
     ctx->out.size = 0;
 
+    ctx->frame_size = compress ? frame_size : 0;
+    ctx->frame_in = 0;
+    ctx->frame_out = 0;
+    ctx->frames = NULL;
+    ctx->nframes = 0;
+    ctx->nframes_alloc = 0;
+    ctx->seek_table = NULL;
+
     return ctx;
 }
 
@@ -101,6 +124,9 @@ decompress_allocate(zip_uint16_t method, int compression_flags, zip_error_t *err
 static void
 deallocate(void *ud) {
     struct ctx *ctx = (struct ctx *)ud;
+    _zip_buffer_free(ctx->seek_table);
+    free(ctx->frames);
+    ZSTD_freeDStream(ctx->zdstream);
     free(ctx);
 }
 
@@ -139,12 +165,18 @@ map_error(size_t ret) {
 static bool
 start(void *ud, zip_stat_t *st, zip_file_attributes_t *attributes) {
     struct ctx *ctx = (struct ctx *)ud;
+    ctx->end_of_input = false;
     ctx->in.src = NULL;
     ctx->in.pos = 0;
     ctx->in.size = 0;
     ctx->out.dst = NULL;
     ctx->out.pos = 0;
     ctx->out.size = 0;
+    ctx->frame_in = 0;
+    ctx->frame_out = 0;
+    ctx->nframes = 0;
+    _zip_buffer_free(ctx->seek_table);
+    ctx->seek_table = NULL;
     if (ctx->compress) {
         size_t ret;
         ctx->zcstream = ZSTD_createCStream();
@@ -158,6 +190,14 @@ start(void *ud, zip_stat_t *st, zip_file_attributes_t *attributes) {
             return false;
         }
     }
+    else if (ctx->zdstream != NULL) {
+        /* reuse stream kept from previous use */
+        size_t ret = ZSTD_initDStream(ctx->zdstream);
+        if (ZSTD_isError(ret)) {
+            zip_error_set(ctx->error, map_error(ret), 0);
+            return false;
+        }
+    }
     else {
         ctx->zdstream = ZSTD_createDStream();
         if (ctx->zdstream == NULL) {
@@ -175,15 +215,14 @@ end(void *ud) {
     struct ctx *ctx = (struct ctx *)ud;
     size_t ret;
 
-    if (ctx->compress) {
-        ret = ZSTD_freeCStream(ctx->zcstream);
-        ctx->zcstream = NULL;
-    }
-    else {
-        ret = ZSTD_freeDStream(ctx->zdstream);
-        ctx->zdstream = NULL;
+    if (!ctx->compress) {
+        /* keep stream for next start, freed in deallocate */
+        return true;
     }
 
+    ret = ZSTD_freeCStream(ctx->zcstream);
+    ctx->zcstream = NULL;
+
     if (ZSTD_isError(ret)) {
         zip_error_set(ctx->error, map_error(ret), 0);
         return false;
@@ -230,6 +269,10 @@ process(void *ud, zip_uint8_t *data, zip_uint64_t *length) {
     ctx->out.pos = 0;
     ctx->out.size = ZIP_MIN(SIZE_MAX, *length);
 
+    if (ctx->frame_size > 0) {
+        return process_seekable(ctx, data, length);
+    }
+
     if (ctx->compress) {
         if (ctx->in.pos == ctx->in.size && ctx->end_of_input) {
             ret = ZSTD_endStream(ctx->zcstream, &ctx->out);
@@ -258,6 +301,163 @@ process(void *ud, zip_uint8_t *data, zip_uint64_t *length) {
     return ZIP_COMPRESSION_OK;
 }
 
+
+static zip_uint64_t
+memory_usage(void *ud) {
+    struct ctx *ctx = (struct ctx *)ud;
+    zip_uint64_t usage = sizeof(*ctx);
+
+#if ZSTD_VERSION_NUMBER >= 10400
+    if (ctx->zcstream) {
+        usage += ZSTD_sizeof_CStream(ctx->zcstream);
+    }
+    if (ctx->zdstream) {
+        usage += ZSTD_sizeof_DStream(ctx->zdstream);
+    }
+#endif
+    usage += ctx->nframes_alloc * 2 * sizeof(ctx->frames[0]);
+    if (ctx->seek_table) {
+        usage += _zip_buffer_size(ctx->seek_table);
+    }
+
+    return usage;
+}
+
+
+/* record size of finished frame for seek table */
+static bool
+add_frame(struct ctx *ctx) {
+    if (ctx->frame_out > ZIP_UINT32_MAX || ctx->frame_in > ZIP_UINT32_MAX) {
+        zip_error_set(ctx->error, ZIP_ER_INTERNAL, 0);
+        return false;
+    }
+
+    if (ctx->nframes == ctx->nframes_alloc) {
+        zip_uint64_t nalloc = ctx->nframes_alloc == 0 ? 16 : ctx->nframes_alloc * 2;
+        zip_uint32_t *frames;
+
+        if (nalloc > SIZE_MAX / (2 * sizeof(*frames)) || (frames = (zip_uint32_t *)realloc(ctx->frames, (size_t)nalloc * 2 * sizeof(*frames))) == NULL) {
+            zip_error_set(ctx->error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+        ctx->frames = frames;
+        ctx->nframes_alloc = nalloc;
+    }
+
+    ctx->frames[ctx->nframes * 2] = (zip_uint32_t)ctx->frame_out;
+    ctx->frames[ctx->nframes * 2 + 1] = (zip_uint32_t)ctx->frame_in;
+    ctx->nframes++;
+    ctx->frame_in = 0;
+    ctx->frame_out = 0;
+
+    return true;
+}
+
+
+/* create skippable frame containing seek table */
+static bool
+create_seek_table(struct ctx *ctx) {
+    zip_uint64_t i, size;
+
+    if (ctx->nframes > (ZIP_UINT32_MAX - ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE) / ZIP_ZSTD_SEEK_TABLE_ENTRY_SIZE) {
+        zip_error_set(ctx->error, ZIP_ER_INTERNAL, 0);
+        return false;
+    }
+    size = ctx->nframes * ZIP_ZSTD_SEEK_TABLE_ENTRY_SIZE + ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE;
+
+    if ((ctx->seek_table = _zip_buffer_new(NULL, 8 + size)) == NULL) {
+        zip_error_set(ctx->error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    _zip_buffer_put_32(ctx->seek_table, ZIP_ZSTD_SKIPPABLE_MAGIC);
+    _zip_buffer_put_32(ctx->seek_table, (zip_uint32_t)size);
+    for (i = 0; i < ctx->nframes; i++) {
+        _zip_buffer_put_32(ctx->seek_table, ctx->frames[i * 2]);
+        _zip_buffer_put_32(ctx->seek_table, ctx->frames[i * 2 + 1]);
+    }
+    _zip_buffer_put_32(ctx->seek_table, (zip_uint32_t)ctx->nframes);
+    _zip_buffer_put_8(ctx->seek_table, 0); /* no checksums */
+    _zip_buffer_put_32(ctx->seek_table, ZIP_ZSTD_SEEKABLE_MAGIC);
+
+    if (!_zip_buffer_ok(ctx->seek_table) || !_zip_buffer_eof(ctx->seek_table)) {
+        zip_error_set(ctx->error, ZIP_ER_INTERNAL, 0);
+        return false;
+    }
+    _zip_buffer_set_offset(ctx->seek_table, 0);
+
+    return true;
+}
+
+
+/* compress into frames of ctx->frame_size bytes, which can be decompressed independently */
+static zip_compression_status_t
+process_seekable(struct ctx *ctx, zip_uint8_t *data, zip_uint64_t *length) {
+    size_t ret;
+
+    if (ctx->seek_table == NULL) {
+        if (ctx->in.pos == ctx->in.size && ctx->end_of_input && ctx->frame_in == 0 && ctx->nframes > 0) {
+            /* data ended at frame boundary */
+            if (!create_seek_table(ctx)) {
+                return ZIP_COMPRESSION_ERROR;
+            }
+        }
+        else if ((ctx->in.pos == ctx->in.size && ctx->end_of_input) || ctx->frame_in == ctx->frame_size) {
+            ret = ZSTD_endStream(ctx->zcstream, &ctx->out);
+            if (ZSTD_isError(ret)) {
+                zip_error_set(ctx->error, map_error(ret), 0);
+                return ZIP_COMPRESSION_ERROR;
+            }
+            ctx->frame_out += ctx->out.pos;
+
+            if (ret == 0) {
+                if (!add_frame(ctx)) {
+                    return ZIP_COMPRESSION_ERROR;
+                }
+                if (ctx->in.pos == ctx->in.size && ctx->end_of_input) {
+                    if (!create_seek_table(ctx)) {
+                        return ZIP_COMPRESSION_ERROR;
+                    }
+                }
+                else {
+                    ret = ZSTD_initCStream(ctx->zcstream, ctx->compression_flags);
+                    if (ZSTD_isError(ret)) {
+                        zip_error_set(ctx->error, map_error(ret), 0);
+                        return ZIP_COMPRESSION_ERROR;
+                    }
+                }
+            }
+        }
+        else {
+            /* don't let frame grow past frame size */
+            ZSTD_inBuffer in = ctx->in;
+
+            in.size = in.pos + (size_t)ZIP_MIN(in.size - in.pos, ctx->frame_size - ctx->frame_in);
+            ret = ZSTD_compressStream(ctx->zcstream, &ctx->out, &in);
+            if (ZSTD_isError(ret)) {
+                zip_error_set(ctx->error, map_error(ret), 0);
+                return ZIP_COMPRESSION_ERROR;
+            }
+            ctx->frame_in += in.pos - ctx->in.pos;
+            ctx->frame_out += ctx->out.pos;
+            ctx->in.pos = in.pos;
+        }
+    }
+
+    if (ctx->seek_table != NULL) {
+        zip_uint64_t n = ZIP_MIN(_zip_buffer_left(ctx->seek_table), ctx->out.size - ctx->out.pos);
+
+        (void)memcpy_s(data + ctx->out.pos, ctx->out.size - ctx->out.pos, _zip_buffer_get(ctx->seek_table, n), n);
+        ctx->out.pos += n;
+        *length = ctx->out.pos;
+        return _zip_buffer_eof(ctx->seek_table) ? ZIP_COMPRESSION_END : ZIP_COMPRESSION_OK;
+    }
+
+    *length = ctx->out.pos;
+    return ZIP_COMPRESSION_OK;
+}
+
+
 /* Version Required should be set to 63 (6.3) because this compression
    method was only defined in appnote.txt version 6.3.7, but Winzip
    does not unpack it if the value is not 20. */
@@ -274,7 +474,8 @@ zip_compression_algorithm_t zip_algorithm_zstd_compress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 
@@ -288,7 +489,8 @@ zip_compression_algorithm_t zip_algorithm_zstd_decompress = {
     end,
     input,
     end_of_input,
-    process
+    process,
+    memory_usage
 };
 
 /* clang-format on */
@@ -0,0 +1,171 @@
+/*
+  zip_arena.c -- bump allocator for archive lifetime data
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+
+#include "zipint.h"
+
+/* all allocations are aligned to this, must be a power of 2 */
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(n) (((n) + (ARENA_ALIGNMENT - 1)) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+/* allocations larger than this get a block of their own */
+#define ARENA_MAX_SHARED_SIZE (ARENA_BLOCK_SIZE / 4)
+
+struct zip_arena_block {
+    zip_arena_block_t *next;
+    size_t size; /* size of data */
+    size_t used; /* bytes of data in use */
+};
+
+#define BLOCK_HEADER_SIZE ARENA_ALIGN(sizeof(zip_arena_block_t))
+#define BLOCK_DATA(block) ((zip_uint8_t *)(block) + BLOCK_HEADER_SIZE)
+
+static zip_arena_block_t *arena_block_new(size_t size, zip_error_t *error);
+
+
+void *
+_zip_arena_alloc(zip_arena_t *arena, size_t size, zip_error_t *error) {
+    zip_arena_block_t *block;
+    void *data;
+
+    if (size > SIZE_MAX - BLOCK_HEADER_SIZE - ARENA_ALIGNMENT) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    size = ARENA_ALIGN(size);
+
+    if (size > ARENA_MAX_SHARED_SIZE) {
+        if ((block = arena_block_new(size, error)) == NULL) {
+            return NULL;
+        }
+        block->used = size;
+
+        /* keep allocating from current block */
+        if (arena->block) {
+            block->next = arena->block->next;
+            arena->block->next = block;
+        }
+        else {
+            arena->block = block;
+        }
+        return BLOCK_DATA(block);
+    }
+
+    if (arena->block == NULL || arena->block->size - arena->block->used < size) {
+        if ((block = arena_block_new(ARENA_BLOCK_SIZE, error)) == NULL) {
+            return NULL;
+        }
+        block->next = arena->block;
+        arena->block = block;
+    }
+
+    data = BLOCK_DATA(arena->block) + arena->block->used;
+    arena->block->used += size;
+
+    return data;
+}
+
+
+void
+_zip_arena_fini(zip_arena_t *arena) {
+    zip_arena_block_t *block, *next;
+
+    for (block = arena->block; block; block = next) {
+        next = block->next;
+        free(block);
+    }
+    arena->block = NULL;
+}
+
+
+void
+_zip_arena_init(zip_arena_t *arena) {
+    arena->block = NULL;
+}
+
+
+/* total size of all blocks, including unused space */
+zip_uint64_t
+_zip_arena_memory_usage(const zip_arena_t *arena) {
+    const zip_arena_block_t *block;
+    zip_uint64_t usage = 0;
+
+    for (block = arena->block; block; block = block->next) {
+        usage += BLOCK_HEADER_SIZE + block->size;
+    }
+
+    return usage;
+}
+
+
+/* move all blocks of other to arena, other is empty afterwards */
+void
+_zip_arena_merge(zip_arena_t *arena, zip_arena_t *other) {
+    zip_arena_block_t *last;
+
+    if (other->block == NULL) {
+        return;
+    }
+
+    for (last = other->block; last->next; last = last->next) {
+    }
+
+    /* keep allocating from current block */
+    if (arena->block) {
+        last->next = arena->block->next;
+        arena->block->next = other->block;
+    }
+    else {
+        arena->block = other->block;
+    }
+    other->block = NULL;
+}
+
+
+static zip_arena_block_t *
+arena_block_new(size_t size, zip_error_t *error) {
+    zip_arena_block_t *block;
+
+    if ((block = (zip_arena_block_t *)malloc(BLOCK_HEADER_SIZE + size)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+
+    return block;
+}
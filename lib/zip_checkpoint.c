@@ -0,0 +1,663 @@
+/*
+  zip_checkpoint.c -- resume decompression of deflated data at checkpoints
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "zipint.h"
+
+/* A checkpoint is the state of inflate at a deflate block boundary:
+   the offsets in compressed and uncompressed data, the bits of a
+   partially consumed byte, and the last 32k of uncompressed data that
+   the following blocks can refer to.  Decompression can be restarted
+   at a checkpoint instead of at the start of the data, which makes
+   deflated files seekable.
+
+   Checkpoints are recorded while reading, at most one every
+   za->checkpoint_interval bytes of uncompressed data.  They can be
+   exported and imported to keep them after the archive is closed. */
+
+/* saving the window needs inflateGetDictionary() */
+#if defined(ZLIB_VERNUM) && ZLIB_VERNUM >= 0x1280
+#define HAVE_CHECKPOINTS
+#endif
+
+#define CHECKPOINTS_MAGIC "ZCPT"
+#define CHECKPOINTS_VERSION 1
+#define CHECKPOINTS_HEADER_SIZE 36
+#define CHECKPOINT_HEADER_SIZE 19
+
+struct context {
+    zip_t *za;          /* archive containing file, for its checkpoints */
+    zip_uint64_t index; /* index of file in za */
+
+    zip_uint64_t in_offset; /* offset in compressed data of end of buffer */
+    bool end_of_input;
+    bool end_of_stream;
+
+    z_stream zstr;
+    zip_uint64_t memory; /* memory allocated by zlib */
+    zip_uint8_t buffer[BUFSIZE];
+};
+
+static bool checkpoints_add(zip_checkpoints_t **checkpointsp, zip_uint64_t out_offset, zip_uint64_t in_offset, zip_uint8_t bits, const zip_uint8_t *window, zip_uint32_t window_length, zip_error_t *error);
+static zip_checkpoint_t *checkpoints_find(zip_checkpoints_t *checkpoints, zip_uint64_t offset);
+static zip_dirent_t *get_deflated_dirent(zip_t *za, zip_uint64_t idx);
+
+#ifdef HAVE_CHECKPOINTS
+static bool checkpoint_end(void *ud, zip_error_t *error);
+static void checkpoint_free(void *ud);
+static zip_int64_t checkpoint_inflate(void *ud, zip_source_t *src, zip_uint64_t out_offset, zip_uint8_t *data, zip_uint64_t length, zip_error_t *error);
+static zip_uint64_t checkpoint_memory_usage(void *ud);
+static bool checkpoint_record(struct context *ctx, zip_uint64_t out_offset, zip_error_t *error);
+static bool checkpoint_restart(void *ud, zip_source_t *src, zip_uint64_t offset, zip_uint64_t *out_offset, zip_error_t *error);
+static bool checkpoint_start(void *ud, zip_source_t *src, zip_error_t *error);
+static voidpf zlib_alloc(voidpf opaque, uInt items, uInt size);
+static void zlib_free(voidpf opaque, voidpf ptr);
+
+static const zip_restartable_decompressor_t checkpoint_decompressor = {
+    checkpoint_start,
+    checkpoint_inflate,
+    checkpoint_restart,
+    checkpoint_end,
+    checkpoint_memory_usage,
+    checkpoint_free
+};
+#endif
+
+
+ZIP_EXTERN int
+zip_set_checkpoint_interval(zip_t *za, zip_uint64_t interval) {
+    if (za == NULL) {
+        return -1;
+    }
+
+#ifndef HAVE_CHECKPOINTS
+    if (interval > 0) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+#endif
+
+    za->checkpoint_interval = interval;
+    return 0;
+}
+
+
+ZIP_EXTERN zip_int64_t
+zip_file_get_checkpoints(zip_t *za, zip_uint64_t idx, void *data, zip_uint64_t length) {
+    zip_dirent_t *de;
+    zip_checkpoints_t *checkpoints;
+    zip_buffer_t *buffer;
+    zip_uint64_t size, i;
+
+    if (za == NULL) {
+        return -1;
+    }
+
+    if ((de = get_deflated_dirent(za, idx)) == NULL) {
+        return -1;
+    }
+
+    checkpoints = za->entry[idx].checkpoints;
+    size = CHECKPOINTS_HEADER_SIZE;
+    if (checkpoints) {
+        for (i = 0; i < checkpoints->nentry; i++) {
+            size += CHECKPOINT_HEADER_SIZE + checkpoints->entry[i].window_length;
+        }
+    }
+
+    if (data == NULL) {
+        return (zip_int64_t)size;
+    }
+    if (length < size) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    if ((buffer = _zip_buffer_new((zip_uint8_t *)data, size)) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+
+    _zip_buffer_put(buffer, CHECKPOINTS_MAGIC, 4);
+    _zip_buffer_put_32(buffer, CHECKPOINTS_VERSION);
+    _zip_buffer_put_32(buffer, de->crc);
+    _zip_buffer_put_64(buffer, de->comp_size);
+    _zip_buffer_put_64(buffer, de->uncomp_size);
+    _zip_buffer_put_64(buffer, checkpoints ? checkpoints->nentry : 0);
+    if (checkpoints) {
+        for (i = 0; i < checkpoints->nentry; i++) {
+            zip_checkpoint_t *checkpoint = checkpoints->entry + i;
+
+            _zip_buffer_put_64(buffer, checkpoint->out_offset);
+            _zip_buffer_put_64(buffer, checkpoint->in_offset);
+            _zip_buffer_put_8(buffer, checkpoint->bits);
+            _zip_buffer_put_16(buffer, (zip_uint16_t)checkpoint->window_length);
+            _zip_buffer_put(buffer, checkpoint->window, checkpoint->window_length);
+        }
+    }
+
+    if (!_zip_buffer_ok(buffer) || _zip_buffer_left(buffer) != 0) {
+        zip_error_set(&za->error, ZIP_ER_INTERNAL, 0);
+        _zip_buffer_free(buffer);
+        return -1;
+    }
+    _zip_buffer_free(buffer);
+
+    return (zip_int64_t)size;
+}
+
+
+ZIP_EXTERN int
+zip_file_set_checkpoints(zip_t *za, zip_uint64_t idx, const void *data, zip_uint64_t length) {
+    zip_dirent_t *de;
+    zip_checkpoints_t *checkpoints;
+    zip_buffer_t *buffer;
+    zip_uint64_t nentry, i;
+
+    if (za == NULL) {
+        return -1;
+    }
+    if (data == NULL) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+#ifndef HAVE_CHECKPOINTS
+    zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+    return -1;
+#endif
+
+    if ((de = get_deflated_dirent(za, idx)) == NULL) {
+        return -1;
+    }
+
+    if (length < CHECKPOINTS_HEADER_SIZE) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+    if ((buffer = _zip_buffer_new((zip_uint8_t *)data, length)) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+
+    /* checkpoints are only valid for the data they were recorded from */
+    if (memcmp(_zip_buffer_get(buffer, 4), CHECKPOINTS_MAGIC, 4) != 0 || _zip_buffer_get_32(buffer) != CHECKPOINTS_VERSION || _zip_buffer_get_32(buffer) != de->crc || _zip_buffer_get_64(buffer) != de->comp_size || _zip_buffer_get_64(buffer) != de->uncomp_size) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        _zip_buffer_free(buffer);
+        return -1;
+    }
+    nentry = _zip_buffer_get_64(buffer);
+    if (!_zip_buffer_ok(buffer) || nentry > _zip_buffer_left(buffer) / CHECKPOINT_HEADER_SIZE) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        _zip_buffer_free(buffer);
+        return -1;
+    }
+
+    checkpoints = NULL;
+    for (i = 0; i < nentry; i++) {
+        zip_uint64_t out_offset, in_offset;
+        zip_uint8_t bits;
+        zip_uint16_t window_length;
+        const zip_uint8_t *window;
+
+        out_offset = _zip_buffer_get_64(buffer);
+        in_offset = _zip_buffer_get_64(buffer);
+        bits = _zip_buffer_get_8(buffer);
+        window_length = _zip_buffer_get_16(buffer);
+        window = _zip_buffer_get(buffer, window_length);
+
+        if (window == NULL || out_offset == 0 || out_offset > de->uncomp_size || in_offset > de->comp_size || bits > 7 || (bits > 0 && in_offset == 0) || window_length > ZIP_CHECKPOINT_WINDOW_SIZE || window_length > out_offset || (checkpoints && out_offset <= checkpoints->entry[checkpoints->nentry - 1].out_offset)) {
+            zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+            _zip_checkpoints_free(checkpoints);
+            _zip_buffer_free(buffer);
+            return -1;
+        }
+
+        if (!checkpoints_add(&checkpoints, out_offset, in_offset, bits, window, window_length, &za->error)) {
+            _zip_checkpoints_free(checkpoints);
+            _zip_buffer_free(buffer);
+            return -1;
+        }
+    }
+
+    if (!_zip_buffer_eof(buffer)) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        _zip_checkpoints_free(checkpoints);
+        _zip_buffer_free(buffer);
+        return -1;
+    }
+    _zip_buffer_free(buffer);
+
+    _zip_checkpoints_free(za->entry[idx].checkpoints);
+    za->entry[idx].checkpoints = checkpoints;
+
+    return 0;
+}
+
+
+void
+_zip_checkpoints_free(zip_checkpoints_t *checkpoints) {
+    zip_uint64_t i;
+
+    if (checkpoints == NULL) {
+        return;
+    }
+
+    for (i = 0; i < checkpoints->nentry; i++) {
+        free(checkpoints->entry[i].window);
+    }
+    free(checkpoints->entry);
+    free(checkpoints);
+}
+
+
+zip_uint64_t
+_zip_checkpoints_memory_usage(const zip_checkpoints_t *checkpoints) {
+    zip_uint64_t usage, i;
+
+    if (checkpoints == NULL) {
+        return 0;
+    }
+
+    usage = sizeof(*checkpoints) + checkpoints->nentry_alloc * sizeof(checkpoints->entry[0]);
+    for (i = 0; i < checkpoints->nentry; i++) {
+        usage += checkpoints->entry[i].window_length;
+    }
+
+    return usage;
+}
+
+
+/* whether original data of entry idx, compressed with method and read from src, should be decompressed using checkpoints */
+bool
+_zip_checkpoints_usable(zip_t *za, zip_uint64_t idx, zip_int32_t method, zip_source_t *src) {
+#ifdef HAVE_CHECKPOINTS
+    if (method != ZIP_CM_DEFLATE || (za->checkpoint_interval == 0 && za->entry[idx].checkpoints == NULL)) {
+        return false;
+    }
+
+    /* restarting at a checkpoint needs to seek in the compressed data */
+    return ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(src), ZIP_SOURCE_SEEK);
+#else
+    return false;
+#endif
+}
+
+
+zip_source_t *
+_zip_source_checkpoint_inflate_new(zip_t *za, zip_uint64_t idx, zip_source_t *src, zip_error_t *error) {
+#ifdef HAVE_CHECKPOINTS
+    struct context *ctx;
+
+    if ((ctx = (struct context *)malloc(sizeof(*ctx))) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+
+    ctx->za = za;
+    ctx->index = idx;
+    ctx->memory = 0;
+    ctx->zstr.zalloc = zlib_alloc;
+    ctx->zstr.zfree = zlib_free;
+    ctx->zstr.opaque = ctx;
+
+    return _zip_source_restartable_new(src, &checkpoint_decompressor, ctx, error);
+#else
+    zip_error_set(error, ZIP_ER_OPNOTSUPP, 0);
+    return NULL;
+#endif
+}
+
+
+/* add checkpoint after the last one, copying window */
+static bool
+checkpoints_add(zip_checkpoints_t **checkpointsp, zip_uint64_t out_offset, zip_uint64_t in_offset, zip_uint8_t bits, const zip_uint8_t *window, zip_uint32_t window_length, zip_error_t *error) {
+    zip_checkpoints_t *checkpoints = *checkpointsp;
+    zip_checkpoint_t *checkpoint;
+
+    if (checkpoints == NULL) {
+        if ((checkpoints = (zip_checkpoints_t *)malloc(sizeof(*checkpoints))) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+        checkpoints->nentry = 0;
+        checkpoints->nentry_alloc = 0;
+        checkpoints->entry = NULL;
+        *checkpointsp = checkpoints;
+    }
+
+    if (checkpoints->nentry == checkpoints->nentry_alloc) {
+        zip_uint64_t nalloc = checkpoints->nentry_alloc == 0 ? 16 : checkpoints->nentry_alloc * 2;
+        zip_checkpoint_t *entry;
+
+        if (nalloc > SIZE_MAX / sizeof(*entry) || (entry = (zip_checkpoint_t *)realloc(checkpoints->entry, (size_t)nalloc * sizeof(*entry))) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+        checkpoints->entry = entry;
+        checkpoints->nentry_alloc = nalloc;
+    }
+
+    checkpoint = checkpoints->entry + checkpoints->nentry;
+    if ((checkpoint->window = (zip_uint8_t *)malloc(window_length > 0 ? window_length : 1)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+    (void)memcpy_s(checkpoint->window, window_length, window, window_length);
+    checkpoint->window_length = window_length;
+    checkpoint->out_offset = out_offset;
+    checkpoint->in_offset = in_offset;
+    checkpoint->bits = bits;
+    checkpoints->nentry++;
+
+    return true;
+}
+
+
+/* last checkpoint at or before offset, NULL if there is none */
+static zip_checkpoint_t *
+checkpoints_find(zip_checkpoints_t *checkpoints, zip_uint64_t offset) {
+    zip_uint64_t low, high;
+
+    if (checkpoints == NULL) {
+        return NULL;
+    }
+
+    low = 0;
+    high = checkpoints->nentry;
+    while (low < high) {
+        zip_uint64_t mid = low + (high - low) / 2;
+
+        if (checkpoints->entry[mid].out_offset <= offset) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low > 0 ? checkpoints->entry + low - 1 : NULL;
+}
+
+
+/* original directory entry of idx, which must be deflated and not encrypted */
+static zip_dirent_t *
+get_deflated_dirent(zip_t *za, zip_uint64_t idx) {
+    zip_dirent_t *de;
+
+    if (idx >= za->nentry) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return NULL;
+    }
+
+    if ((de = _zip_get_dirent(za, idx, ZIP_FL_UNCHANGED, &za->error)) == NULL) {
+        return NULL;
+    }
+
+    if (de->comp_method != ZIP_CM_DEFLATE || de->encryption_method != ZIP_EM_NONE) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        return NULL;
+    }
+
+    return de;
+}
+
+
+#ifdef HAVE_CHECKPOINTS
+
+static bool
+checkpoint_end(void *ud, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+    int ret;
+
+    if ((ret = inflateEnd(&ctx->zstr)) != Z_OK) {
+        zip_error_set(error, ZIP_ER_ZLIB, ret);
+        return false;
+    }
+    return true;
+}
+
+
+static void
+checkpoint_free(void *ud) {
+    free(ud);
+}
+
+
+/* decompress up to length bytes at out_offset, recording checkpoints on the way */
+static zip_int64_t
+checkpoint_inflate(void *ud, zip_source_t *src, zip_uint64_t out_offset, zip_uint8_t *data, zip_uint64_t length, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+    zip_uint64_t done;
+    uInt avail_out;
+    zip_int64_t n;
+    int ret;
+
+    done = 0;
+    while (done < length && !ctx->end_of_stream) {
+        if (ctx->zstr.avail_in == 0 && !ctx->end_of_input) {
+            if ((n = zip_source_read(src, ctx->buffer, sizeof(ctx->buffer))) < 0) {
+                zip_error_set_from_source(error, src);
+                return -1;
+            }
+            if (n == 0) {
+                ctx->end_of_input = true;
+            }
+            ctx->in_offset += (zip_uint64_t)n;
+            ctx->zstr.next_in = (Bytef *)ctx->buffer;
+            ctx->zstr.avail_in = (uInt)n;
+        }
+
+        avail_out = (uInt)ZIP_MIN(UINT_MAX, length - done);
+        ctx->zstr.next_out = (Bytef *)data + done;
+        ctx->zstr.avail_out = avail_out;
+
+        /* stop at end of each block to find places for checkpoints */
+        ret = inflate(&ctx->zstr, Z_BLOCK);
+
+        done += avail_out - ctx->zstr.avail_out;
+
+        switch (ret) {
+        case Z_OK:
+            /* at end of a block that is not the last one */
+            if ((ctx->zstr.data_type & 128) && !(ctx->zstr.data_type & 64)) {
+                if (!checkpoint_record(ctx, out_offset + done, error)) {
+                    return -1;
+                }
+            }
+            break;
+
+        case Z_STREAM_END:
+            ctx->end_of_stream = true;
+            break;
+
+        case Z_BUF_ERROR:
+            if (ctx->zstr.avail_in == 0 && !ctx->end_of_input) {
+                break;
+            }
+            zip_error_set(error, ZIP_ER_COMPRESSED_DATA, 0);
+            return -1;
+
+        default:
+            zip_error_set(error, ZIP_ER_ZLIB, ret);
+            return -1;
+        }
+    }
+
+    return (zip_int64_t)done;
+}
+
+
+static zip_uint64_t
+checkpoint_memory_usage(void *ud) {
+    struct context *ctx = (struct context *)ud;
+
+    return sizeof(*ctx) + ctx->memory;
+}
+
+
+/* record checkpoint at out_offset if it is far enough past the last one */
+static bool
+checkpoint_record(struct context *ctx, zip_uint64_t out_offset, zip_error_t *error) {
+    zip_checkpoints_t **checkpointsp = &ctx->za->entry[ctx->index].checkpoints;
+    zip_uint64_t last;
+    zip_uint8_t *window;
+    uInt window_length;
+    int ret;
+
+    if (ctx->za->checkpoint_interval == 0) {
+        return true;
+    }
+
+    last = (*checkpointsp && (*checkpointsp)->nentry > 0) ? (*checkpointsp)->entry[(*checkpointsp)->nentry - 1].out_offset : 0;
+    if (out_offset <= last || out_offset - last < ctx->za->checkpoint_interval) {
+        return true;
+    }
+
+    if ((window = (zip_uint8_t *)malloc(ZIP_CHECKPOINT_WINDOW_SIZE)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+    if ((ret = inflateGetDictionary(&ctx->zstr, window, &window_length)) != Z_OK) {
+        zip_error_set(error, ZIP_ER_ZLIB, ret);
+        free(window);
+        return false;
+    }
+
+    if (!checkpoints_add(checkpointsp, out_offset, ctx->in_offset - ctx->zstr.avail_in, (zip_uint8_t)(ctx->zstr.data_type & 7), window, window_length, error)) {
+        free(window);
+        return false;
+    }
+    free(window);
+
+    return true;
+}
+
+
+/* restart at the closest checkpoint before offset if that is faster than continuing from out_offset */
+static bool
+checkpoint_restart(void *ud, zip_source_t *src, zip_uint64_t offset, zip_uint64_t *out_offset, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+    zip_checkpoint_t *checkpoint;
+    zip_uint64_t in_offset;
+    zip_uint8_t byte;
+    int ret;
+
+    checkpoint = checkpoints_find(ctx->za->entry[ctx->index].checkpoints, offset);
+
+    if (offset >= *out_offset && (checkpoint == NULL || checkpoint->out_offset <= *out_offset)) {
+        return true;
+    }
+
+    in_offset = 0;
+    if (checkpoint != NULL) {
+        in_offset = checkpoint->in_offset - (checkpoint->bits > 0 ? 1 : 0);
+    }
+    if (in_offset > ZIP_INT64_MAX || zip_source_seek(src, (zip_int64_t)in_offset, SEEK_SET) < 0) {
+        zip_error_set_from_source(error, src);
+        return false;
+    }
+    if ((ret = inflateReset(&ctx->zstr)) != Z_OK) {
+        zip_error_set(error, ZIP_ER_ZLIB, ret);
+        return false;
+    }
+    ctx->zstr.next_in = Z_NULL;
+    ctx->zstr.avail_in = 0;
+    ctx->in_offset = in_offset;
+    ctx->end_of_input = false;
+    ctx->end_of_stream = false;
+    *out_offset = 0;
+
+    if (checkpoint != NULL) {
+        if (checkpoint->bits > 0) {
+            if (zip_source_read(src, &byte, 1) != 1) {
+                zip_error_set(error, ZIP_ER_EOF, 0);
+                return false;
+            }
+            ctx->in_offset++;
+            if ((ret = inflatePrime(&ctx->zstr, checkpoint->bits, byte >> (8 - checkpoint->bits))) != Z_OK) {
+                zip_error_set(error, ZIP_ER_ZLIB, ret);
+                return false;
+            }
+        }
+        if ((ret = inflateSetDictionary(&ctx->zstr, checkpoint->window, checkpoint->window_length)) != Z_OK) {
+            zip_error_set(error, ZIP_ER_ZLIB, ret);
+            return false;
+        }
+        *out_offset = checkpoint->out_offset;
+    }
+
+    return true;
+}
+
+
+static bool
+checkpoint_start(void *ud, zip_source_t *src, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+    int ret;
+
+    ctx->in_offset = 0;
+    ctx->end_of_input = false;
+    ctx->end_of_stream = false;
+    ctx->zstr.next_in = Z_NULL;
+    ctx->zstr.avail_in = 0;
+
+    if ((ret = inflateInit2(&ctx->zstr, -MAX_WBITS)) != Z_OK) {
+        zip_error_set(error, ZIP_ER_ZLIB, ret);
+        return false;
+    }
+    return true;
+}
+
+
+static voidpf
+zlib_alloc(voidpf opaque, uInt items, uInt size) {
+    struct context *ctx = (struct context *)opaque;
+
+    return _zip_memory_alloc(&ctx->memory, (zip_uint64_t)items * size);
+}
+
+
+static void
+zlib_free(voidpf opaque, voidpf ptr) {
+    struct context *ctx = (struct context *)opaque;
+
+    _zip_memory_free(&ctx->memory, ptr);
+}
+
+#endif /* HAVE_CHECKPOINTS */
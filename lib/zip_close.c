@@ -521,6 +521,7 @@ add_data(zip_t *za, zip_source_t *src, zip_dirent_t *de, zip_uint32_t changed) {
             de->last_mod = st.mtime;
         else
             time(&de->last_mod);
+        de->last_mod_valid = true;
     }
     de->comp_method = st.comp_method;
     de->crc = st.crc;
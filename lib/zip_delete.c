@@ -63,6 +63,7 @@ zip_delete(zip_t *za, zip_uint64_t idx) {
         return -1;
 
     za->entry[idx].deleted = 1;
+    _zip_dir_index_update(za, idx);
 
     return 0;
 }
@@ -0,0 +1,532 @@
+/*
+  zip_dir_list.c -- list directory contents
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zipint.h"
+
+/* The directory index holds the names of all entries that are not
+   deleted, sorted with strcmp.  The names below a directory then form
+   a contiguous range, which is found by binary search.  The index is
+   built on first use.  When the name of an entry changes, it is moved
+   to its new position; if many names change before the index is used
+   again, it is rebuilt instead.  Lists remember the last name they
+   returned, and continue after it once the index has changed. */
+
+/* number of changes after which index is rebuilt instead of updated */
+#define DIR_INDEX_MAX_UPDATES 32
+
+typedef struct {
+    const char *name;
+    zip_uint64_t index;
+} zip_dir_index_entry_t;
+
+struct zip_dir_index {
+    zip_uint64_t generation; /* incremented each time the index changes */
+    bool valid;
+    zip_uint64_t nentry;
+    zip_uint64_t nentry_alloc;
+    zip_uint64_t nupdates; /* changes since index was last used */
+    zip_dir_index_entry_t *entry;
+};
+
+typedef enum {
+    RESUME_START,          /* nothing returned yet */
+    RESUME_AFTER_ENTRY,    /* continue after entry last_index named last */
+    RESUME_AFTER_DIRECTORY /* continue after all names starting with last */
+} resume_t;
+
+struct zip_dir_list {
+    zip_t *za;
+    zip_uint64_t generation; /* generation of index positions refer to */
+    char *prefix;         /* directory to list, with trailing '/', empty for root */
+    size_t prefix_length;
+    bool recursive;
+    zip_uint64_t current; /* position of next entry in index */
+    zip_uint64_t end;     /* end of range of names starting with prefix */
+    char *name;           /* buffer for names of implicit directories */
+    size_t name_size;
+    resume_t resume;      /* where to continue if index changed */
+    char *last;           /* copy of last name returned */
+    size_t last_size;
+    zip_uint64_t last_index;
+};
+
+
+static int
+entry_compare(const void *a, const void *b) {
+    const zip_dir_index_entry_t *ea = (const zip_dir_index_entry_t *)a;
+    const zip_dir_index_entry_t *eb = (const zip_dir_index_entry_t *)b;
+    int ret;
+
+    if ((ret = strcmp(ea->name, eb->name)) != 0) {
+        return ret;
+    }
+    return ea->index < eb->index ? -1 : ea->index > eb->index;
+}
+
+
+static zip_dir_index_t *
+dir_index_get(zip_t *za) {
+    zip_dir_index_t *index;
+    zip_dir_index_entry_t *entry;
+    zip_uint64_t i, nentry;
+
+    if ((index = za->dir_index) != NULL && index->valid) {
+        index->nupdates = 0;
+        return index;
+    }
+
+    if (index == NULL) {
+        if ((index = (zip_dir_index_t *)malloc(sizeof(*index))) == NULL) {
+            zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+            return NULL;
+        }
+        index->generation = 0;
+        index->valid = false;
+        index->nentry = index->nentry_alloc = 0;
+        index->nupdates = 0;
+        index->entry = NULL;
+        za->dir_index = index;
+    }
+
+    entry = NULL;
+    if (za->nentry > 0) {
+        if (za->nentry > SIZE_MAX / sizeof(*entry) || (entry = (zip_dir_index_entry_t *)malloc(sizeof(*entry) * (size_t)za->nentry)) == NULL) {
+            zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+            return NULL;
+        }
+    }
+
+    nentry = 0;
+    for (i = 0; i < za->nentry; i++) {
+        const char *name;
+
+        zip_error_t error;
+
+        if (za->entry[i].deleted) {
+            continue;
+        }
+        /* skip entries without name, like zip_name_locate does */
+        zip_error_init(&error);
+        name = _zip_get_name(za, i, 0, &error);
+        zip_error_fini(&error);
+        if (name == NULL) {
+            continue;
+        }
+        entry[nentry].name = name;
+        entry[nentry].index = i;
+        nentry++;
+    }
+
+    if (nentry > 1) {
+        qsort(entry, (size_t)nentry, sizeof(*entry), entry_compare);
+    }
+
+    index->entry = entry;
+    index->nentry = nentry;
+    index->nentry_alloc = za->nentry;
+    index->nupdates = 0;
+    index->valid = true;
+    return index;
+}
+
+
+/* Find first position in [from, to) whose name, truncated to length, compares greater than (after) or not less than (!after) prefix. */
+
+static zip_uint64_t
+dir_index_bound(const zip_dir_index_t *index, zip_uint64_t from, zip_uint64_t to, const char *prefix, size_t length, bool after) {
+    while (from < to) {
+        zip_uint64_t mid = from + (to - from) / 2;
+        int ret = strncmp(index->entry[mid].name, prefix, length);
+
+        if (ret < 0 || (after && ret == 0)) {
+            from = mid + 1;
+        }
+        else {
+            to = mid;
+        }
+    }
+
+    return from;
+}
+
+
+/* Find first position whose entry sorts after entry idx named name. */
+
+static zip_uint64_t
+dir_index_after(const zip_dir_index_t *index, const char *name, zip_uint64_t idx) {
+    zip_uint64_t from = 0, to = index->nentry;
+
+    while (from < to) {
+        zip_uint64_t mid = from + (to - from) / 2;
+        int ret = strcmp(index->entry[mid].name, name);
+
+        if (ret < 0 || (ret == 0 && index->entry[mid].index <= idx)) {
+            from = mid + 1;
+        }
+        else {
+            to = mid;
+        }
+    }
+
+    return from;
+}
+
+
+void
+_zip_dir_index_free(zip_t *za) {
+    if (za->dir_index == NULL) {
+        return;
+    }
+
+    free(za->dir_index->entry);
+    free(za->dir_index);
+    za->dir_index = NULL;
+}
+
+
+zip_uint64_t
+_zip_dir_index_memory_usage(const zip_t *za) {
+    if (za->dir_index == NULL) {
+        return 0;
+    }
+
+    return sizeof(*za->dir_index) + za->dir_index->nentry_alloc * sizeof(za->dir_index->entry[0]);
+}
+
+
+/* Drop index after many names changed, it will be rebuilt when needed. */
+
+void
+_zip_dir_index_invalidate(zip_t *za) {
+    zip_dir_index_t *index = za->dir_index;
+
+    if (index == NULL || !index->valid) {
+        return;
+    }
+
+    free(index->entry);
+    index->entry = NULL;
+    index->nentry = index->nentry_alloc = 0;
+    index->valid = false;
+    index->generation++;
+}
+
+
+/* Move entry idx to the position of its current name after it was
+   added, renamed, deleted, or restored. */
+
+void
+_zip_dir_index_update(zip_t *za, zip_uint64_t idx) {
+    zip_dir_index_t *index = za->dir_index;
+    zip_error_t error;
+    const char *name;
+    zip_uint64_t pos;
+
+    if (index == NULL || !index->valid) {
+        return;
+    }
+
+    if (++index->nupdates > DIR_INDEX_MAX_UPDATES) {
+        _zip_dir_index_invalidate(za);
+        return;
+    }
+    index->generation++;
+
+    /* old name may already be freed, so entry can only be found by index */
+    for (pos = 0; pos < index->nentry; pos++) {
+        if (index->entry[pos].index == idx) {
+            memmove(index->entry + pos, index->entry + pos + 1, sizeof(index->entry[0]) * (size_t)(index->nentry - pos - 1));
+            index->nentry--;
+            break;
+        }
+    }
+
+    if (idx >= za->nentry || za->entry[idx].deleted) {
+        return;
+    }
+    zip_error_init(&error);
+    name = _zip_get_name(za, idx, 0, &error);
+    zip_error_fini(&error);
+    if (name == NULL) {
+        return;
+    }
+
+    if (index->nentry == index->nentry_alloc) {
+        zip_dir_index_entry_t *entry;
+        zip_uint64_t nentry_alloc = index->nentry_alloc > 0 ? index->nentry_alloc * 2 : 16;
+
+        if (nentry_alloc > SIZE_MAX / sizeof(*entry) || (entry = (zip_dir_index_entry_t *)realloc(index->entry, sizeof(*entry) * (size_t)nentry_alloc)) == NULL) {
+            /* will be rebuilt when needed */
+            _zip_dir_index_invalidate(za);
+            return;
+        }
+        index->entry = entry;
+        index->nentry_alloc = nentry_alloc;
+    }
+
+    pos = dir_index_after(index, name, idx);
+    memmove(index->entry + pos + 1, index->entry + pos, sizeof(index->entry[0]) * (size_t)(index->nentry - pos));
+    index->entry[pos].name = name;
+    index->entry[pos].index = idx;
+    index->nentry++;
+}
+
+
+ZIP_EXTERN int
+zip_dir_exists(zip_t *za, const char *name, zip_flags_t flags) {
+    zip_dir_index_t *index;
+    zip_uint64_t pos;
+    size_t length;
+    char *dir;
+    int ret;
+
+    /* names are only indexed as returned by zip_get_name without flags */
+    if (name == NULL || flags != 0) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    length = strlen(name);
+    if (length == 0) {
+        return 1;
+    }
+
+    if ((index = dir_index_get(za)) == NULL) {
+        return -1;
+    }
+
+    if (name[length - 1] == '/') {
+        pos = dir_index_bound(index, 0, index->nentry, name, length, false);
+        return pos < index->nentry && strncmp(index->entry[pos].name, name, length) == 0;
+    }
+
+    if ((dir = (char *)malloc(length + 2)) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+    memcpy(dir, name, length);
+    dir[length++] = '/';
+    dir[length] = '\0';
+
+    pos = dir_index_bound(index, 0, index->nentry, dir, length, false);
+    ret = pos < index->nentry && strncmp(index->entry[pos].name, dir, length) == 0;
+    free(dir);
+
+    return ret;
+}
+
+
+ZIP_EXTERN void
+zip_dir_list_close(zip_dir_list_t *list) {
+    if (list == NULL) {
+        return;
+    }
+
+    free(list->prefix);
+    free(list->name);
+    free(list->last);
+    free(list);
+}
+
+
+/* Save position of list, so it can continue after index changed. */
+
+static bool
+remember(zip_dir_list_t *list, const char *name, size_t length, zip_uint64_t idx, resume_t resume) {
+    if (length + 1 > list->last_size) {
+        char *last;
+
+        if ((last = (char *)realloc(list->last, length + 1)) == NULL) {
+            zip_error_set(&list->za->error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+        list->last = last;
+        list->last_size = length + 1;
+    }
+    memcpy(list->last, name, length);
+    list->last[length] = '\0';
+    list->last_index = idx;
+    list->resume = resume;
+    return true;
+}
+
+
+ZIP_EXTERN const char *
+zip_dir_list_next(zip_dir_list_t *list, zip_int64_t *indexp) {
+    zip_dir_index_t *index = list->za->dir_index;
+
+    if (!index->valid || index->generation != list->generation) {
+        if ((index = dir_index_get(list->za)) == NULL) {
+            return NULL;
+        }
+        switch (list->resume) {
+        case RESUME_START:
+            list->current = dir_index_bound(index, 0, index->nentry, list->prefix, list->prefix_length, false);
+            break;
+        case RESUME_AFTER_ENTRY:
+            list->current = dir_index_after(index, list->last, list->last_index);
+            break;
+        case RESUME_AFTER_DIRECTORY:
+            list->current = dir_index_bound(index, 0, index->nentry, list->last, strlen(list->last), true);
+            break;
+        }
+        list->end = dir_index_bound(index, list->current, index->nentry, list->prefix, list->prefix_length, true);
+        list->generation = index->generation;
+    }
+
+    while (list->current < list->end) {
+        const zip_dir_index_entry_t *entry = index->entry + list->current;
+        const char *rest = entry->name + list->prefix_length;
+        const char *slash;
+        size_t length;
+
+        if (list->recursive) {
+            list->current++;
+            if (!remember(list, entry->name, strlen(entry->name), entry->index, RESUME_AFTER_ENTRY)) {
+                return NULL;
+            }
+            if (indexp) {
+                *indexp = (zip_int64_t)entry->index;
+            }
+            return entry->name;
+        }
+
+        if (*rest == '\0') {
+            /* the directory itself */
+            list->current++;
+            continue;
+        }
+
+        if ((slash = strchr(rest, '/')) == NULL) {
+            list->current++;
+            if (!remember(list, entry->name, strlen(entry->name), entry->index, RESUME_AFTER_ENTRY)) {
+                return NULL;
+            }
+            if (indexp) {
+                *indexp = (zip_int64_t)entry->index;
+            }
+            return entry->name;
+        }
+
+        /* skip everything below this child */
+        length = (size_t)(slash - entry->name) + 1;
+        list->current = dir_index_bound(index, list->current + 1, list->end, entry->name, length, true);
+        if (!remember(list, entry->name, length, entry->index, RESUME_AFTER_DIRECTORY)) {
+            return NULL;
+        }
+
+        if (slash[1] == '\0') {
+            /* explicit directory entry, sorts first among names below it */
+            if (indexp) {
+                *indexp = (zip_int64_t)entry->index;
+            }
+            return entry->name;
+        }
+
+        if (length + 1 > list->name_size) {
+            char *name;
+
+            if ((name = (char *)realloc(list->name, length + 1)) == NULL) {
+                zip_error_set(&list->za->error, ZIP_ER_MEMORY, 0);
+                return NULL;
+            }
+            list->name = name;
+            list->name_size = length + 1;
+        }
+        memcpy(list->name, entry->name, length);
+        list->name[length] = '\0';
+        if (indexp) {
+            *indexp = -1;
+        }
+        return list->name;
+    }
+
+    return NULL;
+}
+
+
+ZIP_EXTERN zip_dir_list_t *
+zip_dir_list_open(zip_t *za, const char *prefix, zip_flags_t flags) {
+    zip_dir_list_t *list;
+    zip_dir_index_t *index;
+    zip_uint64_t start;
+    size_t length;
+
+    if ((flags & ~ZIP_FL_RECURSIVE) != 0) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return NULL;
+    }
+
+    if ((index = dir_index_get(za)) == NULL) {
+        return NULL;
+    }
+
+    if ((list = (zip_dir_list_t *)malloc(sizeof(*list))) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+
+    length = prefix ? strlen(prefix) : 0;
+    if ((list->prefix = (char *)malloc(length + 2)) == NULL) {
+        free(list);
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    if (length > 0) {
+        memcpy(list->prefix, prefix, length);
+        if (prefix[length - 1] != '/') {
+            list->prefix[length++] = '/';
+        }
+    }
+    list->prefix[length] = '\0';
+
+    list->za = za;
+    list->generation = index->generation;
+    list->prefix_length = length;
+    list->recursive = (flags & ZIP_FL_RECURSIVE) != 0;
+    list->name = NULL;
+    list->name_size = 0;
+    list->resume = RESUME_START;
+    list->last = NULL;
+    list->last_size = 0;
+    list->last_index = 0;
+
+    start = dir_index_bound(index, 0, index->nentry, list->prefix, length, false);
+    list->end = dir_index_bound(index, start, index->nentry, list->prefix, length, true);
+    list->current = start;
+
+    return list;
+}
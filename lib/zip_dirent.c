@@ -56,6 +56,7 @@ _zip_cdir_free(zip_cdir_t *cd) {
         _zip_entry_finalize(cd->entry + i);
     free(cd->entry);
     _zip_string_free(cd->comment);
+    _zip_lazy_cdir_free(cd->lazy);
     free(cd);
 }
 
@@ -74,6 +75,9 @@ _zip_cdir_new(zip_uint64_t nentry, zip_error_t *error) {
     cd->size = cd->offset = 0;
     cd->comment = NULL;
     cd->is_zip64 = false;
+    cd->crc = 0;
+    cd->crc_valid = false;
+    cd->lazy = NULL;
 
     if (!_zip_cdir_grow(cd, nentry, error)) {
         _zip_cdir_free(cd);
@@ -100,15 +104,25 @@ _zip_cdir_grow(zip_cdir_t *cd, zip_uint64_t additional_entries, zip_error_t *err
         return false;
     }
 
-    if ((new_entry = (zip_entry_t *)realloc(cd->entry, sizeof(*(cd->entry)) * (size_t)new_alloc)) == NULL) {
-        zip_error_set(error, ZIP_ER_MEMORY, 0);
-        return false;
+    if (cd->entry == NULL) {
+        /* an initialized entry is all zero (see _zip_entry_init), so entries of large directories aren't touched here */
+        if ((new_entry = (zip_entry_t *)calloc((size_t)new_alloc, sizeof(*(cd->entry)))) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+        cd->entry = new_entry;
     }
+    else {
+        if ((new_entry = (zip_entry_t *)realloc(cd->entry, sizeof(*(cd->entry)) * (size_t)new_alloc)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
 
-    cd->entry = new_entry;
+        cd->entry = new_entry;
 
-    for (i = cd->nentry; i < new_alloc; i++) {
-        _zip_entry_init(cd->entry + i);
+        for (i = cd->nentry; i < new_alloc; i++) {
+            _zip_entry_init(cd->entry + i);
+        }
     }
 
     cd->nentry = cd->nentry_alloc = new_alloc;
@@ -225,6 +239,7 @@ _zip_dirent_clone(const zip_dirent_t *sde) {
 
     tde->changed = 0;
     tde->cloned = 1;
+    tde->from_arena = false;
 
     return tde;
 }
@@ -260,7 +275,9 @@ _zip_dirent_free(zip_dirent_t *zde) {
         return;
 
     _zip_dirent_finalize(zde);
-    free(zde);
+    if (!zde->from_arena) {
+        free(zde);
+    }
 }
 
 
@@ -269,6 +286,7 @@ _zip_dirent_init(zip_dirent_t *de) {
     de->changed = 0;
     de->local_extra_fields_read = 0;
     de->cloned = 0;
+    de->from_arena = false;
 
     de->crc_valid = true;
     de->version_madeby = 63 | (ZIP_OPSYS_DEFAULT << 8);
@@ -276,6 +294,9 @@ _zip_dirent_init(zip_dirent_t *de) {
     de->bitflags = 0;
     de->comp_method = ZIP_CM_DEFAULT;
     de->last_mod = 0;
+    de->last_mod_valid = true;
+    de->dos_time = 0;
+    de->dos_date = 0;
     de->crc = 0;
     de->comp_size = 0;
     de->uncomp_size = 0;
@@ -302,35 +323,42 @@ _zip_dirent_needs_zip64(const zip_dirent_t *de, zip_flags_t flags) {
 
 
 zip_dirent_t *
-_zip_dirent_new(void) {
+_zip_dirent_new(zip_arena_t *arena) {
     zip_dirent_t *de;
 
-    if ((de = (zip_dirent_t *)malloc(sizeof(*de))) == NULL)
+    if (arena) {
+        if ((de = (zip_dirent_t *)_zip_arena_alloc(arena, sizeof(*de), NULL)) == NULL)
+            return NULL;
+    }
+    else if ((de = (zip_dirent_t *)malloc(sizeof(*de))) == NULL)
         return NULL;
 
     _zip_dirent_init(de);
+    de->from_arena = (arena != NULL);
     return de;
 }
 
 
-/* _zip_dirent_read(zde, fp, bufp, left, localp, error):
+/* _zip_dirent_read(zde, fp, bufp, left, localp, arena, error):
    Fills the zip directory entry zde.
 
    If buffer is non-NULL, data is taken from there; otherwise data is read from fp as needed.
 
    If local is true, it reads a local header instead of a central directory entry.
 
+   If arena is non-NULL, strings and extra fields are allocated from it.
+
    Returns size of dirent read if successful. On error, error is filled in and -1 is returned.
 */
 
 zip_int64_t
-_zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, bool local, zip_error_t *error) {
+_zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, bool local, zip_arena_t *arena, zip_error_t *error) {
     zip_uint8_t buf[CDENTRYSIZE];
-    zip_uint16_t dostime, dosdate;
     zip_uint32_t size, variable_size;
     zip_uint16_t filename_len, comment_len, ef_len;
 
     bool from_buffer = (buffer != NULL);
+    bool from_arena = zde->from_arena;
 
     size = local ? LENTRYSIZE : CDENTRYSIZE;
 
@@ -357,6 +385,7 @@ _zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, boo
     /* convert buffercontents to zip_dirent */
 
     _zip_dirent_init(zde);
+    zde->from_arena = from_arena;
     if (!local)
         zde->version_madeby = _zip_buffer_get_16(buffer);
     else
@@ -365,10 +394,10 @@ _zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, boo
     zde->bitflags = _zip_buffer_get_16(buffer);
     zde->comp_method = _zip_buffer_get_16(buffer);
 
-    /* convert to time_t */
-    dostime = _zip_buffer_get_16(buffer);
-    dosdate = _zip_buffer_get_16(buffer);
-    zde->last_mod = _zip_d2u_time(dostime, dosdate);
+    /* converted to time_t on first use */
+    zde->dos_time = _zip_buffer_get_16(buffer);
+    zde->dos_date = _zip_buffer_get_16(buffer);
+    zde->last_mod_valid = false;
 
     zde->crc = _zip_buffer_get_32(buffer);
     zde->comp_size = _zip_buffer_get_32(buffer);
@@ -434,7 +463,7 @@ _zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, boo
     }
 
     if (filename_len) {
-        zde->filename = _zip_read_string(buffer, src, filename_len, 1, error);
+        zde->filename = _zip_read_string(buffer, src, filename_len, 1, arena, error);
         if (!zde->filename) {
             if (zip_error_code_zip(error) == ZIP_ER_EOF) {
                 zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_VARIABLE_SIZE_OVERFLOW);
@@ -465,7 +494,7 @@ _zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, boo
             }
             return -1;
         }
-        if (!_zip_ef_parse(ef, ef_len, local ? ZIP_EF_LOCAL : ZIP_EF_CENTRAL, &zde->extra_fields, error)) {
+        if (!_zip_ef_parse(ef, ef_len, local ? ZIP_EF_LOCAL : ZIP_EF_CENTRAL, &zde->extra_fields, arena, error)) {
             free(ef);
             if (!from_buffer) {
                 _zip_buffer_free(buffer);
@@ -478,7 +507,7 @@ _zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, boo
     }
 
     if (comment_len) {
-        zde->comment = _zip_read_string(buffer, src, comment_len, 0, error);
+        zde->comment = _zip_read_string(buffer, src, comment_len, 0, arena, error);
         if (!zde->comment) {
             if (!from_buffer) {
                 _zip_buffer_free(buffer);
@@ -902,7 +931,13 @@ _zip_dirent_write(zip_t *za, zip_dirent_t *de, zip_flags_t flags) {
         _zip_buffer_put_16(buffer, (zip_uint16_t)de->comp_method);
     }
 
-    _zip_u2d_time(de->last_mod, &dostime, &dosdate);
+    if (de->last_mod_valid) {
+        _zip_u2d_time(de->last_mod, &dostime, &dosdate);
+    }
+    else {
+        dostime = de->dos_time;
+        dosdate = de->dos_date;
+    }
     _zip_buffer_put_16(buffer, dostime);
     _zip_buffer_put_16(buffer, dosdate);
 
@@ -1002,23 +1037,13 @@ _zip_dirent_write(zip_t *za, zip_dirent_t *de, zip_flags_t flags) {
 
 
 time_t
-_zip_d2u_time(zip_uint16_t dtime, zip_uint16_t ddate) {
-    struct tm tm;
-
-    memset(&tm, 0, sizeof(tm));
-
-    /* let mktime decide if DST is in effect */
-    tm.tm_isdst = -1;
-
-    tm.tm_year = ((ddate >> 9) & 127) + 1980 - 1900;
-    tm.tm_mon = ((ddate >> 5) & 15) - 1;
-    tm.tm_mday = ddate & 31;
-
-    tm.tm_hour = (dtime >> 11) & 31;
-    tm.tm_min = (dtime >> 5) & 63;
-    tm.tm_sec = (dtime << 1) & 62;
+_zip_dirent_get_last_mod(zip_t *za, zip_dirent_t *de) {
+    if (!de->last_mod_valid) {
+        de->last_mod = _zip_d2u_time(&za->dostime_cache, de->dos_time, de->dos_date);
+        de->last_mod_valid = true;
+    }
 
-    return mktime(&tm);
+    return de->last_mod;
 }
 
 
@@ -1072,6 +1097,9 @@ _zip_get_dirent(zip_t *za, zip_uint64_t idx, zip_flags_t flags, zip_error_t *err
     }
 
     if ((flags & ZIP_FL_UNCHANGED) || za->entry[idx].changes == NULL) {
+        if (!_zip_lazy_cdir_read_entry(za->lazy_cdir, za->entry + idx, idx, error)) {
+            return NULL;
+        }
         if (za->entry[idx].orig == NULL) {
             zip_error_set(error, ZIP_ER_INVAL, 0);
             return NULL;
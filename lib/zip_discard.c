@@ -58,18 +58,25 @@ zip_discard(zip_t *za) {
     _zip_string_free(za->comment_changes);
 
     _zip_hash_free(za->names);
+    _zip_name_index_free(za);
+    _zip_dir_index_free(za);
 
     if (za->entry) {
         for (i = 0; i < za->nentry; i++)
             _zip_entry_finalize(za->entry + i);
         free(za->entry);
     }
+    _zip_lazy_cdir_free(za->lazy_cdir);
+    _zip_arena_fini(&za->arena);
+    zip_source_free(za->index_src);
 
     for (i = 0; i < za->nopen_source; i++) {
         _zip_source_invalidate(za->open_source[i]);
     }
     free(za->open_source);
 
+    _zip_compression_pool_close(za->decompression_pool);
+
     _zip_progress_free(za->progress);
 
     zip_error_fini(&za->error);
@@ -0,0 +1,147 @@
+/*
+  zip_dostime.c -- convert MS-DOS date and time to time_t
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+
+#include "zipint.h"
+
+#define SECONDS_PER_DAY 86400
+
+static time_t dostime_mktime(int year, int month, int day, int hour, int minute, int second);
+static zip_int64_t days_from_civil(zip_int64_t year, unsigned int month, unsigned int day);
+
+
+void
+_zip_dostime_cache_init(zip_dostime_cache_t *cache) {
+    memset(cache, 0, sizeof(*cache));
+}
+
+
+/* Convert MS-DOS date and time to time_t, interpreted as local time.
+
+   mktime is slow and serializes on the libc timezone lock.  If the
+   UTC offset is the same at the beginning and the end of a day, no DST
+   transition happens on that day, and all times on it can be computed
+   with integer arithmetic.  The offset is cached per day in cache,
+   which may be NULL.  Days with a transition and out of range values
+   (which mktime normalizes) are still passed to mktime. */
+
+time_t
+_zip_d2u_time(zip_dostime_cache_t *cache, zip_uint16_t dtime, zip_uint16_t ddate) {
+    zip_dostime_cache_entry_t *entry, tmp;
+    zip_int64_t day_start;
+    time_t t;
+    int year = ((ddate >> 9) & 127) + 1980;
+    int month = (ddate >> 5) & 15;
+    int day = ddate & 31;
+    int hour = (dtime >> 11) & 31;
+    int minute = (dtime >> 5) & 63;
+    int second = (dtime << 1) & 62;
+    static const int days_in_month[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    if (month < 1 || month > 12 || day < 1 || day > days_in_month[month - 1] || (month == 2 && day == 29 && (year % 4 != 0 || (year % 100 == 0 && year % 400 != 0))) || hour > 23 || minute > 59 || second > 59) {
+        return dostime_mktime(year, month, day, hour, minute, second);
+    }
+
+    if (cache != NULL) {
+        entry = cache->entry + (ddate % ZIP_DOSTIME_CACHE_SIZE);
+    }
+    else {
+        entry = &tmp;
+        entry->valid = false;
+    }
+
+    if (!entry->valid || entry->ddate != ddate) {
+        time_t start, end;
+
+        day_start = days_from_civil(year, (unsigned int)month, (unsigned int)day) * SECONDS_PER_DAY;
+        start = dostime_mktime(year, month, day, 0, 0, 0);
+        end = dostime_mktime(year, month, day, 23, 59, 58);
+
+        entry->ddate = ddate;
+        entry->valid = true;
+        entry->transition = start == (time_t)-1 || end == (time_t)-1 || (zip_int64_t)end - (zip_int64_t)start != SECONDS_PER_DAY - 2;
+        entry->offset = day_start - (zip_int64_t)start;
+    }
+
+    if (entry->transition) {
+        return dostime_mktime(year, month, day, hour, minute, second);
+    }
+
+    day_start = days_from_civil(year, (unsigned int)month, (unsigned int)day) * SECONDS_PER_DAY;
+    t = (time_t)(day_start - entry->offset + hour * 3600 + minute * 60 + second);
+    if ((zip_int64_t)t != day_start - entry->offset + hour * 3600 + minute * 60 + second) {
+        /* doesn't fit into time_t */
+        return dostime_mktime(year, month, day, hour, minute, second);
+    }
+
+    return t;
+}
+
+
+static time_t
+dostime_mktime(int year, int month, int day, int hour, int minute, int second) {
+    struct tm tm;
+
+    memset(&tm, 0, sizeof(tm));
+
+    /* let mktime decide if DST is in effect */
+    tm.tm_isdst = -1;
+
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+
+    return mktime(&tm);
+}
+
+
+/* number of days since 1970-01-01 in the proleptic Gregorian calendar */
+
+static zip_int64_t
+days_from_civil(zip_int64_t year, unsigned int month, unsigned int day) {
+    zip_int64_t era;
+    unsigned int year_of_era, day_of_year, day_of_era;
+
+    year -= month <= 2;
+    era = (year >= 0 ? year : year - 399) / 400;
+    year_of_era = (unsigned int)(year - era * 400);
+    day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+    return era * 146097 + (zip_int64_t)day_of_era - 719468;
+}
@@ -39,6 +39,7 @@ _zip_entry_finalize(zip_entry_t *e) {
     _zip_unchange_data(e);
     _zip_dirent_free(e->orig);
     _zip_dirent_free(e->changes);
+    _zip_checkpoints_free(e->checkpoints);
 }
 
 
@@ -47,5 +48,6 @@ _zip_entry_init(zip_entry_t *e) {
     e->orig = NULL;
     e->changes = NULL;
     e->source = NULL;
+    e->checkpoints = NULL;
     e->deleted = 0;
 }
@@ -36,6 +36,8 @@
 
 #include "zipint.h"
 
+static zip_extra_field_t *_zip_ef_new_arena(zip_uint16_t id, zip_uint16_t size, const zip_uint8_t *data, zip_flags_t flags, zip_arena_t *arena, zip_error_t *error);
+
 
 zip_extra_field_t *
 _zip_ef_clone(const zip_extra_field_t *ef, zip_error_t *error) {
@@ -105,8 +107,10 @@ _zip_ef_free(zip_extra_field_t *ef) {
 
     while (ef) {
         ef2 = ef->next;
-        free(ef->data);
-        free(ef);
+        if (!ef->from_arena) {
+            free(ef->data);
+            free(ef);
+        }
         ef = ef2;
     }
 }
@@ -185,6 +189,7 @@ _zip_ef_new(zip_uint16_t id, zip_uint16_t size, const zip_uint8_t *data, zip_fla
     ef->flags = flags;
     ef->id = id;
     ef->size = size;
+    ef->from_arena = false;
     if (size > 0) {
         if ((ef->data = (zip_uint8_t *)_zip_memdup(data, size, NULL)) == NULL) {
             free(ef);
@@ -198,8 +203,42 @@ _zip_ef_new(zip_uint16_t id, zip_uint16_t size, const zip_uint8_t *data, zip_fla
 }
 
 
+/* _zip_ef_new_arena:
+   Like _zip_ef_new, but allocates from arena if it is non-NULL. */
+
+static zip_extra_field_t *
+_zip_ef_new_arena(zip_uint16_t id, zip_uint16_t size, const zip_uint8_t *data, zip_flags_t flags, zip_arena_t *arena, zip_error_t *error) {
+    zip_extra_field_t *ef;
+
+    if (arena == NULL) {
+        if ((ef = _zip_ef_new(id, size, data, flags)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+        }
+        return ef;
+    }
+
+    if ((ef = (zip_extra_field_t *)_zip_arena_alloc(arena, sizeof(*ef) + size, error)) == NULL) {
+        return NULL;
+    }
+
+    ef->next = NULL;
+    ef->flags = flags;
+    ef->id = id;
+    ef->size = size;
+    ef->from_arena = true;
+    if (size > 0) {
+        ef->data = (zip_uint8_t *)(ef + 1);
+        (void)memcpy_s(ef->data, size, data, size);
+    }
+    else
+        ef->data = NULL;
+
+    return ef;
+}
+
+
 bool
-_zip_ef_parse(const zip_uint8_t *data, zip_uint16_t len, zip_flags_t flags, zip_extra_field_t **ef_head_p, zip_error_t *error) {
+_zip_ef_parse(const zip_uint8_t *data, zip_uint16_t len, zip_flags_t flags, zip_extra_field_t **ef_head_p, zip_arena_t *arena, zip_error_t *error) {
     zip_buffer_t *buffer;
     zip_extra_field_t *ef, *ef2, *ef_head;
 
@@ -225,8 +264,7 @@ _zip_ef_parse(const zip_uint8_t *data, zip_uint16_t len, zip_flags_t flags, zip_
             return false;
         }
 
-        if ((ef2 = _zip_ef_new(fid, flen, ef_data, flags)) == NULL) {
-            zip_error_set(error, ZIP_ER_MEMORY, 0);
+        if ((ef2 = _zip_ef_new_arena(fid, flen, ef_data, flags, arena, error)) == NULL) {
             _zip_buffer_free(buffer);
             _zip_ef_free(ef_head);
             return false;
@@ -362,6 +400,10 @@ _zip_read_local_ef(zip_t *za, zip_uint64_t idx) {
 
     e = za->entry + idx;
 
+    if (!_zip_lazy_cdir_read_entry(za->lazy_cdir, e, idx, &za->error)) {
+        return -1;
+    }
+
     if (e->orig == NULL || e->orig->local_extra_fields_read)
         return 0;
 
@@ -404,7 +446,7 @@ _zip_read_local_ef(zip_t *za, zip_uint64_t idx) {
         if (ef_raw == NULL)
             return -1;
 
-        if (!_zip_ef_parse(ef_raw, ef_len, ZIP_EF_LOCAL, &ef, &za->error)) {
+        if (!_zip_ef_parse(ef_raw, ef_len, ZIP_EF_LOCAL, &ef, &za->arena, &za->error)) {
             free(ef_raw);
             return -1;
         }
@@ -46,7 +46,7 @@ zip_fdopen(int fd_orig, int _flags, int *zep) {
     zip_source_t *src;
     struct zip_error error;
 
-    if (_flags < 0 || (_flags & ~(ZIP_CHECKCONS | ZIP_RDONLY))) {
+    if (_flags < 0 || (_flags & ~(ZIP_CHECKCONS | ZIP_RDONLY | ZIP_LAZY | ZIP_PARALLEL))) {
         _zip_set_open_error(zep, NULL, ZIP_ER_INVAL);
         return NULL;
     }
@@ -0,0 +1,89 @@
+/*
+  zip_file_get_data.c -- get pointer to file data without copying
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "zipint.h"
+
+/* Data is valid while za->src is open, i.e. until the archive is
+   closed or zip_refresh replaces its source. */
+
+ZIP_EXTERN const void *
+zip_file_get_data(zip_t *za, zip_uint64_t idx, zip_uint64_t *lenp, zip_flags_t flags) {
+    zip_entry_t *entry;
+    zip_dirent_t *de;
+    zip_uint64_t offset;
+    const zip_uint8_t *data;
+
+    if (idx >= za->nentry) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return NULL;
+    }
+
+    entry = za->entry + idx;
+    if ((flags & ZIP_FL_UNCHANGED) == 0 && (ZIP_ENTRY_DATA_CHANGED(entry) || entry->deleted)) {
+        zip_error_set(&za->error, ZIP_ER_CHANGED, 0);
+        return NULL;
+    }
+
+    if ((de = _zip_get_dirent(za, idx, ZIP_FL_UNCHANGED, NULL)) == NULL) {
+        return NULL;
+    }
+
+    if (flags & ZIP_FL_ENCRYPTED) {
+        flags |= ZIP_FL_COMPRESSED;
+    }
+
+    /* data that needs decoding has to be read with zip_fread */
+    if ((de->encryption_method != ZIP_EM_NONE && (flags & ZIP_FL_ENCRYPTED) == 0) || (de->comp_method != ZIP_CM_STORE && (flags & ZIP_FL_COMPRESSED) == 0)) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        return NULL;
+    }
+
+    if (!ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(za->src), ZIP_SOURCE_GET_DATA)) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        return NULL;
+    }
+
+    if ((offset = _zip_file_get_offset(za, idx, &za->error)) == 0) {
+        return NULL;
+    }
+
+    if ((data = _zip_source_get_data(za->src, offset, de->comp_size, &za->error)) == NULL) {
+        return NULL;
+    }
+
+    if (lenp) {
+        *lenp = de->comp_size;
+    }
+
+    return data;
+}
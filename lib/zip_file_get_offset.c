@@ -40,15 +40,20 @@
 
 /* _zip_file_get_offset(za, ze):
    Returns the offset of the file data for entry ze.
+   Reads entry from central directory if archive was opened lazily,
+   so za is modified.
 
    On error, fills in za->error and returns 0.
 */
 
 zip_uint64_t
-_zip_file_get_offset(const zip_t *za, zip_uint64_t idx, zip_error_t *error) {
+_zip_file_get_offset(zip_t *za, zip_uint64_t idx, zip_error_t *error) {
     zip_uint64_t offset;
     zip_int32_t size;
 
+    if (!_zip_lazy_cdir_read_entry(za->lazy_cdir, za->entry + idx, idx, error)) {
+        return 0;
+    }
     if (za->entry[idx].orig == NULL) {
         zip_error_set(error, ZIP_ER_INTERNAL, 0);
         return 0;
@@ -74,7 +79,7 @@ _zip_file_get_offset(const zip_t *za, zip_uint64_t idx, zip_error_t *error) {
 }
 
 zip_uint64_t
-_zip_file_get_end(const zip_t *za, zip_uint64_t index, zip_error_t *error) {
+_zip_file_get_end(zip_t *za, zip_uint64_t index, zip_error_t *error) {
     zip_uint64_t offset;
     zip_dirent_t *entry;
 
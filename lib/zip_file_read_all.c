@@ -0,0 +1,198 @@
+/*
+  zip_file_read_all.c -- read whole file into buffer
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <limits.h>
+#include <stdlib.h>
+#include <zlib.h>
+
+#include "zipint.h"
+
+/* Unchanged, unencrypted files are read with a single read of their
+   data (or none, if the archive source provides it in memory) and
+   decompressed in one step directly into the buffer, without layering
+   sources as zip_fopen_index() does.  Other files are read with
+   zip_fopen_index(). */
+
+static zip_int64_t read_all_direct(zip_t *za, zip_uint64_t idx, const zip_dirent_t *de, zip_uint8_t *data, zip_uint64_t size, zip_flags_t flags);
+static zip_int64_t read_all_file(zip_t *za, zip_uint64_t idx, zip_uint8_t *data, zip_uint64_t length, zip_flags_t flags);
+
+
+ZIP_EXTERN zip_int64_t
+zip_file_read_all(zip_t *za, zip_uint64_t idx, void *data, zip_uint64_t length, zip_flags_t flags) {
+    zip_entry_t *entry;
+    zip_dirent_t *de;
+    zip_uint64_t size;
+    bool raw;
+
+    if (idx >= za->nentry || (data == NULL && length > 0)) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    if (flags & ZIP_FL_ENCRYPTED) {
+        flags |= ZIP_FL_COMPRESSED;
+    }
+
+    entry = za->entry + idx;
+    if ((flags & ZIP_FL_UNCHANGED) == 0 && (ZIP_ENTRY_DATA_CHANGED(entry) || entry->deleted)) {
+        return read_all_file(za, idx, (zip_uint8_t *)data, length, flags);
+    }
+
+    if ((de = _zip_get_dirent(za, idx, ZIP_FL_UNCHANGED, NULL)) == NULL) {
+        return -1;
+    }
+
+    raw = (flags & ZIP_FL_COMPRESSED) || de->comp_method == ZIP_CM_STORE;
+    if (de->encryption_method != ZIP_EM_NONE || (!raw && _zip_get_compression_algorithm(de->comp_method, false) == NULL)) {
+        return read_all_file(za, idx, (zip_uint8_t *)data, length, flags);
+    }
+
+    size = (flags & ZIP_FL_COMPRESSED) ? de->comp_size : de->uncomp_size;
+    if (size > length || size > ZIP_INT64_MAX) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    return read_all_direct(za, idx, de, (zip_uint8_t *)data, size, flags);
+}
+
+
+/* read data of unchanged, unencrypted file with a single read */
+static zip_int64_t
+read_all_direct(zip_t *za, zip_uint64_t idx, const zip_dirent_t *de, zip_uint8_t *data, zip_uint64_t size, zip_flags_t flags) {
+    zip_uint64_t offset;
+
+    if ((offset = _zip_file_get_offset(za, idx, &za->error)) == 0) {
+        return -1;
+    }
+    /* data is read with a single read, only announce following files */
+    _zip_readahead(za, idx, offset, 0);
+
+    if ((flags & ZIP_FL_COMPRESSED) || de->comp_method == ZIP_CM_STORE) {
+        if (de->comp_size != size) {
+            zip_error_set(&za->error, ZIP_ER_DATA_LENGTH, 0);
+            return -1;
+        }
+        if (_zip_read_at_offset(za->src, offset, data, size, &za->error) < 0) {
+            return -1;
+        }
+    }
+    else {
+        const zip_uint8_t *compressed;
+        zip_uint8_t *buffer = NULL;
+        bool ok;
+
+        /* use data in memory directly if archive source provides it */
+        if (ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(za->src), ZIP_SOURCE_GET_DATA)) {
+            if ((compressed = _zip_source_get_data(za->src, offset, de->comp_size, &za->error)) == NULL) {
+                return -1;
+            }
+        }
+        else {
+            if (de->comp_size > SIZE_MAX || (buffer = (zip_uint8_t *)malloc(de->comp_size > 0 ? (size_t)de->comp_size : 1)) == NULL) {
+                zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+                return -1;
+            }
+            if (_zip_read_at_offset(za->src, offset, buffer, de->comp_size, &za->error) < 0) {
+                free(buffer);
+                return -1;
+            }
+            compressed = buffer;
+        }
+
+        ok = _zip_decompress_buffer(za, de->comp_method, de->bitflags, compressed, de->comp_size, data, size, &za->error);
+        free(buffer);
+        if (!ok) {
+            return -1;
+        }
+    }
+
+    if ((flags & ZIP_FL_COMPRESSED) == 0) {
+        uLong crc = crc32(0, Z_NULL, 0);
+        zip_uint64_t i;
+
+        for (i = 0; i < size; i += UINT_MAX) {
+            crc = crc32(crc, data + i, (uInt)ZIP_MIN(UINT_MAX, size - i));
+        }
+        if ((zip_uint32_t)crc != de->crc) {
+            zip_error_set(&za->error, ZIP_ER_CRC, 0);
+            return -1;
+        }
+    }
+
+    return (zip_int64_t)size;
+}
+
+
+/* read file using zip_fopen_index() */
+static zip_int64_t
+read_all_file(zip_t *za, zip_uint64_t idx, zip_uint8_t *data, zip_uint64_t length, zip_flags_t flags) {
+    zip_file_t *zf;
+    zip_uint64_t size;
+    zip_int64_t n;
+
+    if ((zf = zip_fopen_index(za, idx, flags)) == NULL) {
+        return -1;
+    }
+
+    size = 0;
+    do {
+        zip_uint8_t excess;
+
+        /* detect data past end of buffer */
+        if (size < length) {
+            n = zip_fread(zf, data + size, length - size);
+        }
+        else if ((n = zip_fread(zf, &excess, 1)) > 0) {
+            zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+            zip_fclose(zf);
+            return -1;
+        }
+        if (n < 0) {
+            _zip_error_copy(&za->error, zip_file_get_error(zf));
+            zip_fclose(zf);
+            return -1;
+        }
+        size += (zip_uint64_t)n;
+    } while (n > 0);
+
+    zip_fclose(zf);
+
+    if (size > ZIP_INT64_MAX) {
+        zip_error_set(&za->error, ZIP_ER_INTERNAL, 0);
+        return -1;
+    }
+    return (zip_int64_t)size;
+}
+
@@ -36,7 +36,7 @@
 ZIP_EXTERN int
 zip_file_set_dostime(zip_t *za, zip_uint64_t idx, zip_uint16_t dtime, zip_uint16_t ddate, zip_flags_t flags) {
     time_t mtime;
-    mtime = _zip_d2u_time(dtime, ddate);
+    mtime = _zip_d2u_time(&za->dostime_cache, dtime, ddate);
     return zip_file_set_mtime(za, idx, mtime, flags);
 }
 
@@ -67,6 +67,7 @@ zip_file_set_mtime(zip_t *za, zip_uint64_t idx, time_t mtime, zip_flags_t flags)
     }
 
     e->changes->last_mod = mtime;
+    e->changes->last_mod_valid = true;
     e->changes->changed |= ZIP_DIRENT_LAST_MOD;
 
     return 0;
@@ -44,7 +44,8 @@ zip_get_num_entries(zip_t *za, zip_flags_t flags) {
 
     if (flags & ZIP_FL_UNCHANGED) {
         n = za->nentry;
-        while (n > 0 && za->entry[n - 1].orig == NULL)
+        /* entries not yet parsed from a lazy central directory count as unchanged */
+        while (n > 0 && za->entry[n - 1].orig == NULL && (za->lazy_cdir == NULL || n > za->lazy_cdir->nentry))
             --n;
         return (zip_int64_t)n;
     }
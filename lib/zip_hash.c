@@ -35,9 +35,9 @@
 #include <stdlib.h>
 #include <string.h>
 
-/* parameter for the string hash function */
-#define HASH_MULTIPLIER 33
-#define HASH_START 5381
+/* parameters for the string hash function */
+#define HASH_SEED 0x9e3779b97f4a7c15ull
+#define HASH_MULTIPLIER 0xff51afd7ed558ccdull
 
 /* hash table's fill ratio is kept between these by doubling/halfing its size as necessary */
 #define HASH_MAX_FILL .75
@@ -47,88 +47,320 @@
 #define HASH_MIN_SIZE 256
 #define HASH_MAX_SIZE 0x80000000ul
 
+/* marks unused slot or end of free list */
+#define HASH_EMPTY 0xfffffffful
+
+/* number of names whose slots are prefetched before they are looked up */
+#define HASH_LOOKUP_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HASH_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define HASH_PREFETCH(address) ((void)0)
+#endif
+
+/* Names are kept in an open addressing table using Robin Hood
+   hashing.  Slots contain the hash value of the name and the index of
+   its entry in the entries array, so probing only touches the table
+   and names are only compared if their hash values match.
+
+   The table can also be used directly from an index of the central
+   directory (see zip_index.c), without copying or rehashing.  In that
+   case, slots contain the index of the entry in the archive, and names
+   are looked up in the index.  The table is copied on the first change.
+   Since hash values are stored in indexes, hash_string must not be
+   changed without changing the index version. */
+
+typedef struct {
+    zip_uint32_t hash_value;
+    zip_uint32_t entry; /* index into entries, HASH_EMPTY if slot is unused */
+} zip_hash_slot_t;
+
 struct zip_hash_entry {
-    const zip_uint8_t *name;
+    const zip_uint8_t *name; /* NULL if entry is unused */
     zip_int64_t orig_index;
-    zip_int64_t current_index;
-    struct zip_hash_entry *next;
-    zip_uint32_t hash_value;
+    zip_int64_t current_index; /* next unused entry if entry is unused */
 };
 typedef struct zip_hash_entry zip_hash_entry_t;
 
+typedef struct {
+    zip_hash_t *hash;
+    const zip_uint8_t **names;
+    zip_uint32_t *hash_values;
+    zip_uint64_t nnames;
+    unsigned int nchunks;
+} add_names_t;
+
+typedef struct {
+    const zip_hash_t *hash;
+    const zip_uint8_t *const *names;
+    zip_int64_t *indices;
+    zip_uint64_t nnames;
+    zip_flags_t flags;
+    unsigned int nchunks;
+    zip_uint64_t nfound[ZIP_PARALLEL_MAX_THREADS];
+} lookup_names_t;
+
 struct zip_hash {
     zip_uint32_t table_size;
     zip_uint64_t nentries;
-    zip_hash_entry_t **table;
+    zip_hash_slot_t *table;
+    zip_hash_entry_t *entries;
+    zip_uint32_t entries_used;  /* entries[0..entries_used) have been handed out */
+    zip_uint32_t entries_alloc;
+    zip_uint32_t free_entry;    /* first unused entry below entries_used */
+    const zip_uint8_t *mapped_names;        /* names from index if table is mapped, NULL otherwise */
+    const zip_uint32_t *mapped_name_offset; /* offset of name of each entry in mapped_names */
+    zip_uint64_t mapped_names_size;
+    zip_uint32_t nmapped; /* number of entries in mapped table */
 };
 
 
-/* free list of entries */
-static void
-free_list(zip_hash_entry_t *entry) {
-    while (entry != NULL) {
-        zip_hash_entry_t *next = entry->next;
-        free(entry);
-        entry = next;
-    }
-}
+static bool unmap_table(zip_hash_t *hash, zip_error_t *error);
 
 
 /* compute hash of string, full 32 bit value */
 static zip_uint32_t
 hash_string(const zip_uint8_t *name) {
-    zip_uint64_t value = HASH_START;
+    zip_uint64_t value, word;
+    size_t length, left;
 
     if (name == NULL) {
         return 0;
     }
 
-    while (*name != 0) {
-        value = (zip_uint64_t)(((value * HASH_MULTIPLIER) + (zip_uint8_t)*name) % 0x100000000ul);
-        name++;
+    length = strlen((const char *)name);
+    value = HASH_SEED ^ length;
+
+    /* process 8 bytes at a time */
+    for (left = length; left >= 8; left -= 8) {
+        memcpy(&word, name, 8);
+        value = (value ^ word) * HASH_MULTIPLIER;
+        value ^= value >> 32;
+        name += 8;
     }
+    if (left > 0) {
+        word = 0;
+        memcpy(&word, name, left);
+        value = (value ^ word) * HASH_MULTIPLIER;
+        value ^= value >> 32;
+    }
+
+    /* final mix so all bits of the name affect the low bits used to select a slot */
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
 
     return (zip_uint32_t)value;
 }
 
 
+/* distance of slot pos from the slot its hash value prefers */
+static zip_uint32_t
+probe_distance(const zip_hash_t *hash, zip_uint32_t pos, zip_uint32_t hash_value) {
+    return (pos - hash_value) & (hash->table_size - 1);
+}
+
+
+/* name of entry, NULL if invalid (only possible for mapped tables) */
+static const zip_uint8_t *
+entry_name(const zip_hash_t *hash, zip_uint32_t entry) {
+    zip_uint32_t offset;
+
+    if (hash->mapped_names == NULL) {
+        return hash->entries[entry].name;
+    }
+
+    if (entry >= hash->nmapped || (offset = hash->mapped_name_offset[entry]) >= hash->mapped_names_size) {
+        return NULL;
+    }
+    return hash->mapped_names + offset;
+}
+
+
+/* find slot containing name, HASH_EMPTY if not found */
+static zip_uint32_t
+find_slot(const zip_hash_t *hash, const zip_uint8_t *name, zip_uint32_t hash_value) {
+    zip_uint32_t mask, pos, distance;
+
+    if (hash->nentries == 0) {
+        return HASH_EMPTY;
+    }
+
+    mask = hash->table_size - 1;
+    pos = hash_value & mask;
+    for (distance = 0;; distance++) {
+        const zip_hash_slot_t *slot = hash->table + pos;
+
+        /* entries are ordered by probe distance, so name would have been found by now */
+        if (slot->entry == HASH_EMPTY || probe_distance(hash, pos, slot->hash_value) < distance) {
+            return HASH_EMPTY;
+        }
+        if (slot->hash_value == hash_value) {
+            const zip_uint8_t *slot_name = entry_name(hash, slot->entry);
+
+            if (slot_name != NULL && strcmp((const char *)name, (const char *)slot_name) == 0) {
+                return pos;
+            }
+        }
+        pos = (pos + 1) & mask;
+    }
+}
+
+
+/* index of entry in slot pos, -1 if it doesn't exist in the requested version of the archive */
+static zip_int64_t
+slot_index(const zip_hash_t *hash, zip_uint32_t pos, zip_flags_t flags) {
+    const zip_hash_entry_t *entry;
+
+    if (hash->mapped_names != NULL) {
+        /* unchanged since opened */
+        return hash->table[pos].entry;
+    }
+
+    entry = hash->entries + hash->table[pos].entry;
+
+    return (flags & ZIP_FL_UNCHANGED) ? entry->orig_index : entry->current_index;
+}
+
+
+/* insert slot into table, which must have an unused slot */
+static void
+insert_slot(zip_hash_slot_t *table, zip_uint32_t table_size, zip_hash_slot_t slot) {
+    zip_uint32_t mask = table_size - 1;
+    zip_uint32_t pos = slot.hash_value & mask;
+    zip_uint32_t distance = 0;
+
+    while (table[pos].entry != HASH_EMPTY) {
+        zip_uint32_t other_distance = (pos - table[pos].hash_value) & mask;
+
+        /* take slot from entries closer to their preferred slot */
+        if (other_distance < distance) {
+            zip_hash_slot_t tmp = table[pos];
+            table[pos] = slot;
+            slot = tmp;
+            distance = other_distance;
+        }
+        pos = (pos + 1) & mask;
+        distance++;
+    }
+
+    table[pos] = slot;
+}
+
+
+/* remove slot at pos, moving following displaced slots back */
+static void
+delete_slot(zip_hash_t *hash, zip_uint32_t pos) {
+    zip_uint32_t mask = hash->table_size - 1;
+    zip_uint32_t next = (pos + 1) & mask;
+
+    while (hash->table[next].entry != HASH_EMPTY && probe_distance(hash, next, hash->table[next].hash_value) != 0) {
+        hash->table[pos] = hash->table[next];
+        pos = next;
+        next = (next + 1) & mask;
+    }
+
+    hash->table[pos].entry = HASH_EMPTY;
+}
+
+
+static zip_hash_slot_t *
+new_table(zip_uint32_t size, zip_error_t *error) {
+    zip_hash_slot_t *table;
+    zip_uint32_t i;
+
+    if ((table = (zip_hash_slot_t *)malloc(sizeof(*table) * size)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    for (i = 0; i < size; i++) {
+        table[i].entry = HASH_EMPTY;
+    }
+
+    return table;
+}
+
+
 /* resize hash table; new_size must be a power of 2, can be larger or smaller than current size */
 static bool
 hash_resize(zip_hash_t *hash, zip_uint32_t new_size, zip_error_t *error) {
-    zip_hash_entry_t **new_table;
+    zip_hash_slot_t *table;
+    zip_uint32_t i;
 
     if (new_size == hash->table_size) {
         return true;
     }
 
-    if ((new_table = (zip_hash_entry_t **)calloc(new_size, sizeof(zip_hash_entry_t *))) == NULL) {
+    if ((table = new_table(new_size, error)) == NULL) {
+        return false;
+    }
+
+    for (i = 0; i < hash->table_size; i++) {
+        if (hash->table[i].entry != HASH_EMPTY) {
+            insert_slot(table, new_size, hash->table[i]);
+        }
+    }
+
+    free(hash->table);
+    hash->table = table;
+    hash->table_size = new_size;
+
+    return true;
+}
+
+
+static bool
+reserve_entries(zip_hash_t *hash, zip_uint64_t capacity, zip_error_t *error) {
+    zip_hash_entry_t *entries;
+
+    if (capacity <= hash->entries_alloc) {
+        return true;
+    }
+    if (capacity >= HASH_EMPTY) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    if ((entries = (zip_hash_entry_t *)realloc(hash->entries, sizeof(*entries) * (size_t)capacity)) == NULL) {
         zip_error_set(error, ZIP_ER_MEMORY, 0);
         return false;
     }
+    hash->entries = entries;
+    hash->entries_alloc = (zip_uint32_t)capacity;
 
-    if (hash->nentries > 0) {
-        zip_uint32_t i;
+    return true;
+}
 
-        for (i = 0; i < hash->table_size; i++) {
-            zip_hash_entry_t *entry = hash->table[i];
-            while (entry) {
-                zip_hash_entry_t *next = entry->next;
 
-                zip_uint32_t new_index = entry->hash_value % new_size;
+/* get unused entry, HASH_EMPTY on error */
+static zip_uint32_t
+new_entry(zip_hash_t *hash, zip_error_t *error) {
+    zip_uint32_t index;
 
-                entry->next = new_table[new_index];
-                new_table[new_index] = entry;
+    if (hash->free_entry != HASH_EMPTY) {
+        index = hash->free_entry;
+        hash->free_entry = (zip_uint32_t)hash->entries[index].current_index;
+        return index;
+    }
 
-                entry = next;
-            }
+    if (hash->entries_used == hash->entries_alloc) {
+        if (!reserve_entries(hash, hash->entries_alloc < 16 ? 16 : (zip_uint64_t)hash->entries_alloc * 2, error)) {
+            return HASH_EMPTY;
         }
     }
 
-    free(hash->table);
-    hash->table = new_table;
-    hash->table_size = new_size;
+    return hash->entries_used++;
+}
 
-    return true;
+
+static void
+free_entry(zip_hash_t *hash, zip_uint32_t index) {
+    hash->entries[index].name = NULL;
+    hash->entries[index].current_index = hash->free_entry;
+    hash->free_entry = index;
 }
 
 
@@ -163,6 +395,30 @@ size_for_capacity(zip_uint64_t capacity) {
 }
 
 
+/* make room for one more entry in table */
+static bool
+grow_for_add(zip_hash_t *hash, zip_error_t *error) {
+    if (hash->table_size == 0) {
+        if (!hash_resize(hash, HASH_MIN_SIZE, error)) {
+            return false;
+        }
+    }
+
+    if (hash->nentries + 1 > hash->table_size * HASH_MAX_FILL && hash->table_size < HASH_MAX_SIZE) {
+        if (!hash_resize(hash, hash->table_size * 2, error)) {
+            return false;
+        }
+    }
+
+    if (hash->nentries + 1 >= hash->table_size) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    return true;
+}
+
+
 zip_hash_t *
 _zip_hash_new(zip_error_t *error) {
     zip_hash_t *hash;
@@ -175,35 +431,129 @@ _zip_hash_new(zip_error_t *error) {
     hash->table_size = 0;
     hash->nentries = 0;
     hash->table = NULL;
+    hash->entries = NULL;
+    hash->entries_used = 0;
+    hash->entries_alloc = 0;
+    hash->free_entry = HASH_EMPTY;
+    hash->mapped_names = NULL;
+    hash->mapped_name_offset = NULL;
+    hash->mapped_names_size = 0;
+    hash->nmapped = 0;
 
     return hash;
 }
 
 
+/* _zip_hash_map:
+   Uses table of table_size slots containing nentries entries, as
+   written by _zip_hash_write_table, for empty hash.  Entry i is named
+   names + name_offset[i].  table, names, and name_offset must remain
+   valid until hash is freed.  Slots and names are checked when they
+   are used.
+
+   Returns false if table is invalid.
+*/
+
+bool
+_zip_hash_map(zip_hash_t *hash, const void *table, zip_uint32_t table_size, zip_uint64_t nentries, const zip_uint8_t *names, zip_uint64_t names_size, const zip_uint32_t *name_offset, zip_uint64_t nnames, zip_error_t *error) {
+    if (hash == NULL || hash->nentries > 0 || hash->table_size > 0 || table_size > HASH_MAX_SIZE || (table_size & (table_size - 1)) != 0 || nentries >= ZIP_MAX(table_size, 1) || nnames >= HASH_EMPTY) {
+        zip_error_set(error, ZIP_ER_INVAL, 0);
+        return false;
+    }
+    if (nentries == 0) {
+        return true;
+    }
+    if (names_size == 0 || names[names_size - 1] != '\0') {
+        /* names must be NUL-terminated */
+        zip_error_set(error, ZIP_ER_INVAL, 0);
+        return false;
+    }
+
+    hash->table = (zip_hash_slot_t *)table;
+    hash->table_size = table_size;
+    hash->nentries = nentries;
+    hash->mapped_names = names;
+    hash->mapped_name_offset = name_offset;
+    hash->mapped_names_size = names_size;
+    hash->nmapped = (zip_uint32_t)nnames;
+
+    return true;
+}
+
+
+/* _zip_hash_table_size:
+   Returns number of slots _zip_hash_write_table writes.
+*/
+
+zip_uint32_t
+_zip_hash_table_size(const zip_hash_t *hash) {
+    return hash->table_size;
+}
+
+
+/* _zip_hash_num_entries:
+   Returns number of names in hash.
+*/
+
+zip_uint64_t
+_zip_hash_num_entries(const zip_hash_t *hash) {
+    return hash->nentries;
+}
+
+
+/* _zip_hash_write_table:
+   Writes table of hash, which must contain only unchanged entries, in
+   the format used by _zip_hash_map (native byte order).
+*/
+
 void
-_zip_hash_free(zip_hash_t *hash) {
+_zip_hash_write_table(const zip_hash_t *hash, zip_buffer_t *buffer) {
     zip_uint32_t i;
 
+    for (i = 0; i < hash->table_size; i++) {
+        zip_hash_slot_t slot = hash->table[i];
+
+        if (slot.entry != HASH_EMPTY && hash->mapped_names == NULL) {
+            slot.entry = (zip_uint32_t)hash->entries[slot.entry].orig_index;
+        }
+        _zip_buffer_put(buffer, &slot, sizeof(slot));
+    }
+}
+
+
+void
+_zip_hash_free(zip_hash_t *hash) {
     if (hash == NULL) {
         return;
     }
 
-    if (hash->table != NULL) {
-        for (i = 0; i < hash->table_size; i++) {
-            if (hash->table[i] != NULL) {
-                free_list(hash->table[i]);
-            }
-        }
+    if (hash->mapped_names == NULL) {
         free(hash->table);
     }
+    free(hash->entries);
     free(hash);
 }
 
 
+zip_uint64_t
+_zip_hash_memory_usage(const zip_hash_t *hash) {
+    if (hash == NULL) {
+        return 0;
+    }
+
+    if (hash->mapped_names != NULL) {
+        /* table is part of index */
+        return sizeof(*hash);
+    }
+
+    return sizeof(*hash) + (zip_uint64_t)hash->table_size * sizeof(hash->table[0]) + (zip_uint64_t)hash->entries_alloc * sizeof(hash->entries[0]);
+}
+
+
 /* insert into hash, return error on existence or memory issues */
 bool
 _zip_hash_add(zip_hash_t *hash, const zip_uint8_t *name, zip_uint64_t index, zip_flags_t flags, zip_error_t *error) {
-    zip_uint32_t hash_value, table_index;
+    zip_uint32_t hash_value, pos;
     zip_hash_entry_t *entry;
 
     if (hash == NULL || name == NULL || index > ZIP_INT64_MAX) {
@@ -211,43 +561,35 @@ _zip_hash_add(zip_hash_t *hash, const zip_uint8_t *name, zip_uint64_t index, zip
         return false;
     }
 
-    if (hash->table_size == 0) {
-        if (!hash_resize(hash, HASH_MIN_SIZE, error)) {
-            return false;
-        }
+    if (!unmap_table(hash, error)) {
+        return false;
     }
 
     hash_value = hash_string(name);
-    table_index = hash_value % hash->table_size;
 
-    for (entry = hash->table[table_index]; entry != NULL; entry = entry->next) {
-        if (entry->hash_value == hash_value && strcmp((const char *)name, (const char *)entry->name) == 0) {
-            if (((flags & ZIP_FL_UNCHANGED) && entry->orig_index != -1) || entry->current_index != -1) {
-                zip_error_set(error, ZIP_ER_EXISTS, 0);
-                return false;
-            }
-            else {
-                break;
-            }
+    if ((pos = find_slot(hash, name, hash_value)) != HASH_EMPTY) {
+        entry = hash->entries + hash->table[pos].entry;
+        if (((flags & ZIP_FL_UNCHANGED) && entry->orig_index != -1) || entry->current_index != -1) {
+            zip_error_set(error, ZIP_ER_EXISTS, 0);
+            return false;
         }
     }
+    else {
+        zip_hash_slot_t slot;
 
-    if (entry == NULL) {
-        if ((entry = (zip_hash_entry_t *)malloc(sizeof(zip_hash_entry_t))) == NULL) {
-            zip_error_set(error, ZIP_ER_MEMORY, 0);
+        if (!grow_for_add(hash, error)) {
+            return false;
+        }
+        if ((slot.entry = new_entry(hash, error)) == HASH_EMPTY) {
             return false;
         }
+        slot.hash_value = hash_value;
+        insert_slot(hash->table, hash->table_size, slot);
+        hash->nentries++;
+
+        entry = hash->entries + slot.entry;
         entry->name = name;
-        entry->next = hash->table[table_index];
-        hash->table[table_index] = entry;
-        entry->hash_value = hash_value;
         entry->orig_index = -1;
-        hash->nentries++;
-        if (hash->nentries > hash->table_size * HASH_MAX_FILL && hash->table_size < HASH_MAX_SIZE) {
-            if (!hash_resize(hash, hash->table_size * 2, error)) {
-                return false;
-            }
-        }
     }
 
     if (flags & ZIP_FL_UNCHANGED) {
@@ -259,82 +601,170 @@ _zip_hash_add(zip_hash_t *hash, const zip_uint8_t *name, zip_uint64_t index, zip
 }
 
 
+/* hash names[first..last) of one chunk */
+static void
+add_names_hash(void *ud, unsigned int index) {
+    add_names_t *ctx = (add_names_t *)ud;
+    zip_uint64_t first = ctx->nnames * index / ctx->nchunks;
+    zip_uint64_t last = ctx->nnames * (index + 1) / ctx->nchunks;
+    zip_uint64_t i;
+
+    for (i = first; i < last; i++) {
+        ctx->hash_values[i] = hash_string(ctx->names[i]);
+    }
+}
+
+
+/* insert names[i] for unchanged index i into empty hash, computing hash values using nthreads threads;
+   names already present are skipped and reported as ZIP_ER_EXISTS after all others have been added */
+bool
+_zip_hash_add_names(zip_hash_t *hash, const zip_uint8_t **names, zip_uint64_t nnames, unsigned int nthreads, zip_error_t *error) {
+    add_names_t ctx;
+    zip_uint64_t nduplicates, i;
+
+    if (hash == NULL || hash->nentries > 0 || nnames > ZIP_INT64_MAX || nthreads == 0) {
+        zip_error_set(error, ZIP_ER_INVAL, 0);
+        return false;
+    }
+
+    if (nnames == 0) {
+        return true;
+    }
+
+    if (!_zip_hash_reserve_capacity(hash, nnames, error)) {
+        return false;
+    }
+    if (hash->table_size < HASH_MIN_SIZE) {
+        if (!hash_resize(hash, HASH_MIN_SIZE, error)) {
+            return false;
+        }
+    }
+
+    ctx.hash = hash;
+    ctx.names = names;
+    ctx.nnames = nnames;
+    ctx.nchunks = nthreads;
+    if (nnames > SIZE_MAX / sizeof(*ctx.hash_values) || (ctx.hash_values = (zip_uint32_t *)malloc(sizeof(*ctx.hash_values) * (size_t)nnames)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    _zip_parallel_run(nthreads, add_names_hash, &ctx);
+
+    nduplicates = 0;
+    for (i = 0; i < nnames; i++) {
+        zip_hash_slot_t slot;
+        zip_hash_entry_t *entry;
+
+        if (find_slot(hash, names[i], ctx.hash_values[i]) != HASH_EMPTY) {
+            nduplicates++;
+            continue;
+        }
+
+        if (!grow_for_add(hash, error) || (slot.entry = new_entry(hash, error)) == HASH_EMPTY) {
+            free(ctx.hash_values);
+            return false;
+        }
+        slot.hash_value = ctx.hash_values[i];
+        insert_slot(hash->table, hash->table_size, slot);
+        hash->nentries++;
+
+        entry = hash->entries + slot.entry;
+        entry->name = names[i];
+        entry->orig_index = (zip_int64_t)i;
+        entry->current_index = (zip_int64_t)i;
+    }
+
+    free(ctx.hash_values);
+
+    if (nduplicates > 0) {
+        zip_error_set(error, ZIP_ER_EXISTS, 0);
+        return false;
+    }
+
+    return true;
+}
+
+
 /* remove entry from hash, error if not found */
 bool
 _zip_hash_delete(zip_hash_t *hash, const zip_uint8_t *name, zip_error_t *error) {
-    zip_uint32_t hash_value, index;
-    zip_hash_entry_t *entry, *previous;
+    zip_uint32_t pos, index;
 
     if (hash == NULL || name == NULL) {
         zip_error_set(error, ZIP_ER_INVAL, 0);
         return false;
     }
 
-    if (hash->nentries > 0) {
-        hash_value = hash_string(name);
-        index = hash_value % hash->table_size;
-        previous = NULL;
-        entry = hash->table[index];
-        while (entry) {
-            if (entry->hash_value == hash_value && strcmp((const char *)name, (const char *)entry->name) == 0) {
-                if (entry->orig_index == -1) {
-                    if (previous) {
-                        previous->next = entry->next;
-                    }
-                    else {
-                        hash->table[index] = entry->next;
-                    }
-                    free(entry);
-                    hash->nentries--;
-                    if (hash->nentries < hash->table_size * HASH_MIN_FILL && hash->table_size > HASH_MIN_SIZE) {
-                        if (!hash_resize(hash, hash->table_size / 2, error)) {
-                            return false;
-                        }
-                    }
-                }
-                else {
-                    entry->current_index = -1;
-                }
-                return true;
+    if ((pos = find_slot(hash, name, hash_string(name))) == HASH_EMPTY) {
+        zip_error_set(error, ZIP_ER_NOENT, 0);
+        return false;
+    }
+
+    if (hash->mapped_names != NULL) {
+        if (!unmap_table(hash, error)) {
+            return false;
+        }
+        if ((pos = find_slot(hash, name, hash_string(name))) == HASH_EMPTY) {
+            zip_error_set(error, ZIP_ER_NOENT, 0);
+            return false;
+        }
+    }
+
+    index = hash->table[pos].entry;
+    if (hash->entries[index].orig_index == -1) {
+        free_entry(hash, index);
+        delete_slot(hash, pos);
+        hash->nentries--;
+        if (hash->nentries < hash->table_size * HASH_MIN_FILL && hash->table_size > HASH_MIN_SIZE) {
+            if (!hash_resize(hash, hash->table_size / 2, error)) {
+                return false;
             }
-            previous = entry;
-            entry = entry->next;
         }
     }
+    else {
+        hash->entries[index].current_index = -1;
+    }
 
-    zip_error_set(error, ZIP_ER_NOENT, 0);
-    return false;
+    return true;
+}
+
+
+/* remove name added as unchanged entry index, undoing _zip_hash_add; does not shrink table, so it can't fail */
+void
+_zip_hash_remove_unchanged(zip_hash_t *hash, const zip_uint8_t *name, zip_uint64_t index) {
+    zip_uint32_t pos, entry;
+
+    if (hash == NULL || name == NULL || hash->mapped_names != NULL || (pos = find_slot(hash, name, hash_string(name))) == HASH_EMPTY) {
+        return;
+    }
+
+    entry = hash->table[pos].entry;
+    if (hash->entries[entry].orig_index != (zip_int64_t)index) {
+        /* name was already in hash, not added for index */
+        return;
+    }
+    free_entry(hash, entry);
+    delete_slot(hash, pos);
+    hash->nentries--;
 }
 
 
 /* find value for entry in hash, -1 if not found */
 zip_int64_t
 _zip_hash_lookup(zip_hash_t *hash, const zip_uint8_t *name, zip_flags_t flags, zip_error_t *error) {
-    zip_uint32_t hash_value, index;
-    zip_hash_entry_t *entry;
+    zip_uint32_t pos;
 
     if (hash == NULL || name == NULL) {
         zip_error_set(error, ZIP_ER_INVAL, 0);
         return -1;
     }
 
-    if (hash->nentries > 0) {
-        hash_value = hash_string(name);
-        index = hash_value % hash->table_size;
-        for (entry = hash->table[index]; entry != NULL; entry = entry->next) {
-            if (strcmp((const char *)name, (const char *)entry->name) == 0) {
-                if (flags & ZIP_FL_UNCHANGED) {
-                    if (entry->orig_index != -1) {
-                        return entry->orig_index;
-                    }
-                }
-                else {
-                    if (entry->current_index != -1) {
-                        return entry->current_index;
-                    }
-                }
-                break;
-            }
+    if ((pos = find_slot(hash, name, hash_string(name))) != HASH_EMPTY) {
+        zip_int64_t idx = slot_index(hash, pos, flags);
+
+        if (idx != -1) {
+            return idx;
         }
     }
 
@@ -343,6 +773,69 @@ _zip_hash_lookup(zip_hash_t *hash, const zip_uint8_t *name, zip_flags_t flags, z
 }
 
 
+static void
+lookup_names_chunk(void *ud, unsigned int index) {
+    lookup_names_t *ctx = (lookup_names_t *)ud;
+    const zip_hash_t *hash = ctx->hash;
+    zip_uint64_t first = ctx->nnames * index / ctx->nchunks;
+    zip_uint64_t last = ctx->nnames * (index + 1) / ctx->nchunks;
+    zip_uint32_t hash_values[HASH_LOOKUP_BATCH];
+    zip_uint64_t start, nfound;
+
+    nfound = 0;
+    for (start = first; start < last; start += HASH_LOOKUP_BATCH) {
+        zip_uint64_t n = ZIP_MIN(HASH_LOOKUP_BATCH, last - start);
+        zip_uint64_t i;
+
+        /* fetch the slots of all names of the batch before probing the first one */
+        for (i = 0; i < n; i++) {
+            hash_values[i] = hash_string(ctx->names[start + i]);
+            if (hash->table_size > 0) {
+                HASH_PREFETCH(hash->table + (hash_values[i] & (hash->table_size - 1)));
+            }
+        }
+
+        for (i = 0; i < n; i++) {
+            zip_uint32_t pos = find_slot(hash, ctx->names[start + i], hash_values[i]);
+            zip_int64_t idx = (pos == HASH_EMPTY ? -1 : slot_index(hash, pos, ctx->flags));
+
+            ctx->indices[start + i] = idx;
+            if (idx >= 0) {
+                nfound++;
+            }
+        }
+    }
+
+    ctx->nfound[index] = nfound;
+}
+
+
+/* look up nnames names, storing their indices (or -1) in indices, using nthreads threads;
+   returns number of names found */
+zip_uint64_t
+_zip_hash_lookup_many(const zip_hash_t *hash, const zip_uint8_t *const *names, zip_uint64_t nnames, zip_flags_t flags, zip_int64_t *indices, unsigned int nthreads) {
+    lookup_names_t ctx;
+    zip_uint64_t nfound;
+    unsigned int i;
+
+    ctx.hash = hash;
+    ctx.names = names;
+    ctx.indices = indices;
+    ctx.nnames = nnames;
+    ctx.flags = flags;
+    ctx.nchunks = ZIP_MAX(1, ZIP_MIN(nthreads, ZIP_PARALLEL_MAX_THREADS));
+
+    _zip_parallel_run(ctx.nchunks, lookup_names_chunk, &ctx);
+
+    nfound = 0;
+    for (i = 0; i < ctx.nchunks; i++) {
+        nfound += ctx.nfound[i];
+    }
+
+    return nfound;
+}
+
+
 bool
 _zip_hash_reserve_capacity(zip_hash_t *hash, zip_uint64_t capacity, zip_error_t *error) {
     zip_uint32_t new_size;
@@ -351,6 +844,14 @@ _zip_hash_reserve_capacity(zip_hash_t *hash, zip_uint64_t capacity, zip_error_t
         return true;
     }
 
+    if (!unmap_table(hash, error)) {
+        return false;
+    }
+
+    if (!reserve_entries(hash, capacity, error)) {
+        return false;
+    }
+
     new_size = size_for_capacity(capacity);
 
     if (new_size <= hash->table_size) {
@@ -367,44 +868,107 @@ _zip_hash_reserve_capacity(zip_hash_t *hash, zip_uint64_t capacity, zip_error_t
 
 bool
 _zip_hash_revert(zip_hash_t *hash, zip_error_t *error) {
-    zip_uint32_t i;
-    zip_hash_entry_t *entry, *previous;
+    zip_hash_slot_t *table;
+    zip_uint32_t i, new_size;
+    zip_uint64_t nentries;
 
-    for (i = 0; i < hash->table_size; i++) {
-        previous = NULL;
-        entry = hash->table[i];
-        while (entry) {
-            if (entry->orig_index == -1) {
-                zip_hash_entry_t *p;
-                if (previous) {
-                    previous->next = entry->next;
-                }
-                else {
-                    hash->table[i] = entry->next;
-                }
-                p = entry;
-                entry = entry->next;
-                /* previous does not change */
-                free(p);
-                hash->nentries--;
-            }
-            else {
-                entry->current_index = entry->orig_index;
-                previous = entry;
-                entry = entry->next;
-            }
+    if (hash->mapped_names != NULL) {
+        /* nothing changed */
+        return true;
+    }
+
+    nentries = 0;
+    for (i = 0; i < hash->entries_used; i++) {
+        if (hash->entries[i].name != NULL && hash->entries[i].orig_index != -1) {
+            nentries++;
         }
     }
 
-    if (hash->nentries < hash->table_size * HASH_MIN_FILL && hash->table_size > HASH_MIN_SIZE) {
-        zip_uint32_t new_size = hash->table_size / 2;
-        while (hash->nentries < new_size * HASH_MIN_FILL && new_size > HASH_MIN_SIZE) {
-            new_size /= 2;
+    new_size = hash->table_size;
+    while (nentries < new_size * HASH_MIN_FILL && new_size > HASH_MIN_SIZE) {
+        new_size /= 2;
+    }
+
+    if (new_size == 0) {
+        return true;
+    }
+
+    /* rebuild table from entries that were in the archive originally */
+    if ((table = new_table(new_size, error)) == NULL) {
+        return false;
+    }
+    for (i = 0; i < hash->table_size; i++) {
+        zip_hash_entry_t *entry;
+
+        if (hash->table[i].entry == HASH_EMPTY) {
+            continue;
         }
-        if (!hash_resize(hash, new_size, error)) {
-            return false;
+        entry = hash->entries + hash->table[i].entry;
+        if (entry->orig_index == -1) {
+            free_entry(hash, hash->table[i].entry);
+        }
+        else {
+            entry->current_index = entry->orig_index;
+            insert_slot(table, new_size, hash->table[i]);
+        }
+    }
+
+    free(hash->table);
+    hash->table = table;
+    hash->table_size = new_size;
+    hash->nentries = nentries;
+
+    return true;
+}
+
+
+/* unmap_table:
+   Copies mapped table, so it can be changed.
+*/
+
+static bool
+unmap_table(zip_hash_t *hash, zip_error_t *error) {
+    zip_hash_slot_t *table;
+    zip_uint32_t i, size;
+    zip_uint64_t nentries;
+
+    if (hash->mapped_names == NULL) {
+        return true;
+    }
+
+    size = hash->table_size;
+    if ((table = new_table(size, error)) == NULL) {
+        return false;
+    }
+    if (!reserve_entries(hash, hash->nmapped, error)) {
+        free(table);
+        return false;
+    }
+
+    for (i = 0; i < hash->nmapped; i++) {
+        hash->entries[i].name = entry_name(hash, i);
+        hash->entries[i].orig_index = hash->entries[i].current_index = i;
+    }
+
+    nentries = 0;
+    for (i = 0; i < hash->table_size; i++) {
+        zip_hash_slot_t slot = hash->table[i];
+
+        /* skip invalid slots, and keep at least one slot free so insert_slot terminates */
+        if (slot.entry == HASH_EMPTY || entry_name(hash, slot.entry) == NULL || nentries + 1 >= size) {
+            continue;
         }
+        insert_slot(table, size, slot);
+        nentries++;
     }
 
+    hash->table = table;
+    hash->nentries = nentries;
+    hash->entries_used = hash->nmapped;
+    hash->mapped_names = NULL;
+    hash->mapped_name_offset = NULL;
+    hash->mapped_names_size = 0;
+    hash->nmapped = 0;
+
     return true;
 }
@@ -0,0 +1,573 @@
+/*
+  zip_index.c -- save and use index of central directory
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zipint.h"
+
+/* The index contains everything needed to open an archive without
+   searching for and parsing its central directory: the raw central
+   directory, the offset of each entry in it, the names of all entries,
+   and the slots of the name hash table.  It is used in place (mapped
+   into memory if possible), so opening an archive using an index
+   doesn't depend on the number of entries.  It is only used if the
+   archive still has the same size, modification time, and data
+   following the central directory (end of central directory records
+   and archive comment).
+
+   Header fields are little endian, offsets and hash table slots are
+   stored in native byte order (and aligned), so an index can only be
+   used on machines with the same byte order:
+
+     header (INDEX_HEADER_SIZE bytes)
+     offset of each entry in central directory (64 bit)
+     name hash table slots (2 * 32 bit)
+     offset of each name in names (32 bit), padded to multiple of 8 bytes
+     data following central directory
+     archive comment
+     central directory
+     names (NUL-terminated) */
+
+#define INDEX_MAGIC "ZIDX"
+#define INDEX_VERSION 2
+#define INDEX_HEADER_SIZE 80
+#define INDEX_SUFFIX ".zidx"
+
+#define INDEX_BYTE_ORDER 0x01020304u /* stored in native byte order */
+
+#define INDEX_FLAG_MTIME 0x0001u /* archive modification time is valid */
+
+/* longest possible data following central directory */
+#define MAX_TAIL_SIZE (CDBUFSIZE + EOCD64LEN)
+
+/* size of name offsets, including padding */
+#define NAME_OFFSETS_SIZE(nentry) (((nentry) * 4 + 7) & ~(zip_uint64_t)7)
+
+static zip_source_t *open_file(const char *fname);
+
+
+ZIP_EXTERN zip_int64_t
+zip_get_index(zip_t *za, void *data, zip_uint64_t length) {
+    zip_stat_t st;
+    zip_lazy_cdir_t *lazy;
+    zip_buffer_t *buffer, *tail;
+    zip_hash_t *hash;
+    zip_error_t error;
+    const zip_uint8_t *comment;
+    const zip_uint8_t **names;
+    zip_uint32_t comment_length, table_size, byte_order, name_offset;
+    zip_uint64_t nentry, tail_offset, tail_length, names_size, index_size, i;
+
+    if (za == NULL) {
+        return -1;
+    }
+
+    if (zip_source_stat(za->src, &st) < 0) {
+        zip_error_set_from_source(&za->error, za->src);
+        return -1;
+    }
+    if ((st.valid & ZIP_STAT_SIZE) == 0) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+
+    tail_offset = za->cdir_offset + za->cdir_size;
+    if (tail_offset > st.size || st.size - tail_offset > MAX_TAIL_SIZE) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+    tail_length = st.size - tail_offset;
+
+    if ((comment = _zip_string_get(za->comment_orig, &comment_length, ZIP_FL_ENC_RAW, &za->error)) == NULL) {
+        return -1;
+    }
+
+    nentry = (zip_uint64_t)zip_get_num_entries(za, ZIP_FL_UNCHANGED);
+    /* entries and names are referenced by 32 bit offsets */
+    if (nentry >= ZIP_UINT32_MAX) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+    if ((names = (const zip_uint8_t **)malloc(sizeof(*names) * (size_t)ZIP_MAX(nentry, 1))) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+    names_size = 0;
+    for (i = 0; i < nentry; i++) {
+        if ((names[i] = (const zip_uint8_t *)_zip_get_name(za, i, ZIP_FL_UNCHANGED, &za->error)) == NULL) {
+            free(names);
+            return -1;
+        }
+        names_size += strlen((const char *)names[i]) + 1;
+    }
+    if (names_size > ZIP_UINT32_MAX) {
+        zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+        free(names);
+        return -1;
+    }
+
+    /* hash table as it is after opening the unchanged archive */
+    if ((hash = _zip_hash_new(&za->error)) == NULL) {
+        free(names);
+        return -1;
+    }
+    zip_error_init(&error);
+    if (!_zip_hash_add_names(hash, names, nentry, 1, &error) && zip_error_code_zip(&error) != ZIP_ER_EXISTS) {
+        /* duplicate names are ignored, as when opening without ZIP_CHECKCONS */
+        _zip_error_copy(&za->error, &error);
+        zip_error_fini(&error);
+        _zip_hash_free(hash);
+        free(names);
+        return -1;
+    }
+    zip_error_fini(&error);
+    table_size = _zip_hash_table_size(hash);
+
+    index_size = INDEX_HEADER_SIZE + nentry * 8 + (zip_uint64_t)table_size * 8 + NAME_OFFSETS_SIZE(nentry) + tail_length + comment_length + za->cdir_size + names_size;
+
+    if (data == NULL) {
+        _zip_hash_free(hash);
+        free(names);
+        return (zip_int64_t)index_size;
+    }
+    if (length < index_size) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        _zip_hash_free(hash);
+        free(names);
+        return -1;
+    }
+
+    if (zip_source_seek(za->src, (zip_int64_t)tail_offset, SEEK_SET) < 0) {
+        zip_error_set_from_source(&za->error, za->src);
+        _zip_hash_free(hash);
+        free(names);
+        return -1;
+    }
+    if ((tail = _zip_buffer_new_from_source(za->src, tail_length, NULL, &za->error)) == NULL) {
+        _zip_hash_free(hash);
+        free(names);
+        return -1;
+    }
+
+    if (za->lazy_cdir && za->lazy_cdir->size == za->cdir_size) {
+        /* not the case if entries were added by zip_refresh */
+        lazy = za->lazy_cdir;
+    }
+    else {
+        /* find start of entries in raw central directory */
+        zip_buffer_t *cd_buffer;
+
+        lazy = NULL;
+        if (zip_source_seek(za->src, (zip_int64_t)za->cdir_offset, SEEK_SET) < 0) {
+            zip_error_set_from_source(&za->error, za->src);
+        }
+        else if ((cd_buffer = _zip_buffer_new_from_source(za->src, za->cdir_size, NULL, &za->error)) != NULL) {
+            lazy = _zip_lazy_cdir_new(_zip_buffer_data(cd_buffer), za->cdir_size, NULL, &za->error);
+            _zip_buffer_free(cd_buffer);
+        }
+        if (lazy == NULL) {
+            _zip_buffer_free(tail);
+            _zip_hash_free(hash);
+            free(names);
+            return -1;
+        }
+        if ((cd_buffer = _zip_buffer_new(lazy->data, lazy->size)) == NULL) {
+            zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+            _zip_lazy_cdir_free(lazy);
+            _zip_buffer_free(tail);
+            _zip_hash_free(hash);
+            free(names);
+            return -1;
+        }
+        while (lazy->nentry < nentry && _zip_buffer_left(cd_buffer) > 0) {
+            if (_zip_lazy_cdir_add_entry(lazy, cd_buffer, &za->error) < 0) {
+                break;
+            }
+        }
+        _zip_buffer_free(cd_buffer);
+    }
+
+    if (lazy->nentry != nentry || (buffer = _zip_buffer_new((zip_uint8_t *)data, index_size)) == NULL) {
+        if (lazy->nentry != nentry) {
+            zip_error_set(&za->error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_WRONG_ENTRIES_COUNT);
+        }
+        else {
+            zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        }
+        if (lazy != za->lazy_cdir) {
+            _zip_lazy_cdir_free(lazy);
+        }
+        _zip_buffer_free(tail);
+        _zip_hash_free(hash);
+        free(names);
+        return -1;
+    }
+
+    byte_order = INDEX_BYTE_ORDER;
+    _zip_buffer_put(buffer, INDEX_MAGIC, 4);
+    _zip_buffer_put_32(buffer, INDEX_VERSION);
+    _zip_buffer_put(buffer, &byte_order, 4);
+    _zip_buffer_put_32(buffer, (st.valid & ZIP_STAT_MTIME) ? INDEX_FLAG_MTIME : 0);
+    _zip_buffer_put_64(buffer, st.size);
+    _zip_buffer_put_64(buffer, (st.valid & ZIP_STAT_MTIME) ? (zip_uint64_t)st.mtime : 0);
+    _zip_buffer_put_64(buffer, za->cdir_offset);
+    _zip_buffer_put_64(buffer, za->cdir_size);
+    _zip_buffer_put_64(buffer, nentry);
+    _zip_buffer_put_64(buffer, names_size);
+    _zip_buffer_put_32(buffer, (zip_uint32_t)tail_length);
+    _zip_buffer_put_16(buffer, (zip_uint16_t)comment_length);
+    _zip_buffer_put_16(buffer, 0);
+    _zip_buffer_put_32(buffer, table_size);
+    _zip_buffer_put_32(buffer, (zip_uint32_t)_zip_hash_num_entries(hash));
+
+    if (nentry > 0) {
+        _zip_buffer_put(buffer, lazy->offset, sizeof(lazy->offset[0]) * (size_t)nentry);
+    }
+    _zip_hash_write_table(hash, buffer);
+    name_offset = 0;
+    for (i = 0; i < nentry; i++) {
+        _zip_buffer_put(buffer, &name_offset, 4);
+        name_offset += (zip_uint32_t)strlen((const char *)names[i]) + 1;
+    }
+    if (nentry % 2 != 0) {
+        _zip_buffer_put_32(buffer, 0);
+    }
+
+    _zip_buffer_put(buffer, _zip_buffer_data(tail), tail_length);
+    _zip_buffer_put(buffer, comment, comment_length);
+    _zip_buffer_put(buffer, lazy->data, za->cdir_size);
+    for (i = 0; i < nentry; i++) {
+        _zip_buffer_put(buffer, names[i], strlen((const char *)names[i]) + 1);
+    }
+
+    if (lazy != za->lazy_cdir) {
+        _zip_lazy_cdir_free(lazy);
+    }
+    _zip_buffer_free(tail);
+    _zip_hash_free(hash);
+    free(names);
+
+    if (!_zip_buffer_ok(buffer) || !_zip_buffer_eof(buffer)) {
+        zip_error_set(&za->error, ZIP_ER_INTERNAL, 0);
+        _zip_buffer_free(buffer);
+        return -1;
+    }
+    _zip_buffer_free(buffer);
+
+    return (zip_int64_t)index_size;
+}
+
+
+ZIP_EXTERN int
+zip_write_index(zip_t *za, const char *fname) {
+    zip_source_t *src;
+    zip_uint8_t *data;
+    zip_int64_t length;
+
+    if (za == NULL) {
+        return -1;
+    }
+    if (fname == NULL) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    if ((length = zip_get_index(za, NULL, 0)) < 0) {
+        return -1;
+    }
+    if ((zip_uint64_t)length > SIZE_MAX || (data = (zip_uint8_t *)malloc((size_t)length)) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+    if (zip_get_index(za, data, (zip_uint64_t)length) < 0) {
+        free(data);
+        return -1;
+    }
+
+    /* written to temporary file and renamed, so archives using old index are not affected */
+    if ((src = zip_source_file_create(fname, 0, -1, &za->error)) == NULL) {
+        free(data);
+        return -1;
+    }
+    if (zip_source_begin_write(src) < 0 || zip_source_write(src, data, (zip_uint64_t)length) != length || zip_source_commit_write(src) < 0) {
+        zip_error_set_from_source(&za->error, src);
+        zip_source_rollback_write(src);
+        zip_source_free(src);
+        free(data);
+        return -1;
+    }
+
+    zip_source_free(src);
+    free(data);
+    return 0;
+}
+
+
+/* _zip_index_read:
+   Creates central directory for za from index (an open source
+   supporting ZIP_SOURCE_GET_DATA), if it matches the archive (of which
+   st is the stat information).  Entries are parsed on demand, and the
+   name hash table of za uses the one in the index.  Both point into
+   index, which must be kept open until za is freed.
+
+   Returns NULL if the index can't be used.
+*/
+
+zip_cdir_t *
+_zip_index_read(zip_t *za, const zip_stat_t *st, zip_source_t *index) {
+    zip_stat_t index_st;
+    zip_buffer_t *buffer, *archive_tail;
+    zip_error_t error;
+    zip_cdir_t *cd;
+    zip_uint32_t flags, byte_order, tail_length, table_size, hash_entries;
+    zip_uint16_t comment_length;
+    zip_uint64_t size, mtime, cdir_offset, cdir_size, nentry, names_size, arrays_size, left;
+    const zip_uint8_t *data, *tail, *comment, *cdir_data, *offsets, *table, *name_offsets, *names;
+
+    /* data is mapped or allocated, so offsets and slots are suitably aligned */
+    if (zip_source_stat(index, &index_st) < 0 || (index_st.valid & ZIP_STAT_SIZE) == 0 || index_st.size < INDEX_HEADER_SIZE || (data = _zip_source_get_data(index, 0, index_st.size, NULL)) == NULL) {
+        return NULL;
+    }
+
+    if ((buffer = _zip_buffer_new((zip_uint8_t *)data, index_st.size)) == NULL) {
+        return NULL;
+    }
+
+    if (memcmp(_zip_buffer_get(buffer, 4), INDEX_MAGIC, 4) != 0 || _zip_buffer_get_32(buffer) != INDEX_VERSION) {
+        _zip_buffer_free(buffer);
+        return NULL;
+    }
+    memcpy(&byte_order, _zip_buffer_get(buffer, 4), 4);
+    if (byte_order != INDEX_BYTE_ORDER) {
+        _zip_buffer_free(buffer);
+        return NULL;
+    }
+
+    flags = _zip_buffer_get_32(buffer);
+    size = _zip_buffer_get_64(buffer);
+    mtime = _zip_buffer_get_64(buffer);
+    cdir_offset = _zip_buffer_get_64(buffer);
+    cdir_size = _zip_buffer_get_64(buffer);
+    nentry = _zip_buffer_get_64(buffer);
+    names_size = _zip_buffer_get_64(buffer);
+    tail_length = _zip_buffer_get_32(buffer);
+    comment_length = _zip_buffer_get_16(buffer);
+    (void)_zip_buffer_get_16(buffer);
+    table_size = _zip_buffer_get_32(buffer);
+    hash_entries = _zip_buffer_get_32(buffer);
+
+    if (size != st->size || ((flags & INDEX_FLAG_MTIME) != 0) != ((st->valid & ZIP_STAT_MTIME) != 0) || ((flags & INDEX_FLAG_MTIME) && mtime != (zip_uint64_t)st->mtime)) {
+        /* archive changed */
+        _zip_buffer_free(buffer);
+        return NULL;
+    }
+
+    left = _zip_buffer_left(buffer);
+    if (nentry >= ZIP_UINT32_MAX || cdir_offset > size || cdir_size > size - cdir_offset || tail_length != size - cdir_offset - cdir_size) {
+        _zip_buffer_free(buffer);
+        return NULL;
+    }
+    arrays_size = nentry * 8 + (zip_uint64_t)table_size * 8 + NAME_OFFSETS_SIZE(nentry);
+    if (arrays_size > left || tail_length > left - arrays_size || comment_length > left - arrays_size - tail_length || cdir_size > left - arrays_size - tail_length - comment_length || names_size != left - arrays_size - tail_length - comment_length - cdir_size) {
+        _zip_buffer_free(buffer);
+        return NULL;
+    }
+
+    offsets = _zip_buffer_get(buffer, nentry * 8);
+    table = _zip_buffer_get(buffer, (zip_uint64_t)table_size * 8);
+    name_offsets = _zip_buffer_get(buffer, NAME_OFFSETS_SIZE(nentry));
+    tail = _zip_buffer_get(buffer, tail_length);
+    comment = _zip_buffer_get(buffer, comment_length);
+    cdir_data = _zip_buffer_get(buffer, cdir_size);
+    names = _zip_buffer_get(buffer, names_size);
+    _zip_buffer_free(buffer);
+
+    zip_error_init(&error);
+
+    /* end of central directory and archive comment must be unchanged */
+    if (zip_source_seek(za->src, (zip_int64_t)(cdir_offset + cdir_size), SEEK_SET) < 0) {
+        zip_error_fini(&error);
+        return NULL;
+    }
+    if ((archive_tail = _zip_buffer_new_from_source(za->src, tail_length, NULL, &error)) == NULL) {
+        zip_error_fini(&error);
+        return NULL;
+    }
+    if (memcmp(_zip_buffer_data(archive_tail), tail, tail_length) != 0) {
+        _zip_buffer_free(archive_tail);
+        zip_error_fini(&error);
+        return NULL;
+    }
+    _zip_buffer_free(archive_tail);
+
+    if ((cd = _zip_cdir_new(nentry, &error)) == NULL) {
+        zip_error_fini(&error);
+        return NULL;
+    }
+    cd->offset = cdir_offset;
+    cd->size = cdir_size;
+
+    if (comment_length > 0) {
+        if ((cd->comment = _zip_string_new(comment, comment_length, ZIP_FL_ENC_GUESS, &error)) == NULL) {
+            _zip_cdir_free(cd);
+            zip_error_fini(&error);
+            return NULL;
+        }
+    }
+
+    if ((cd->lazy = _zip_lazy_cdir_new_mapped(cdir_data, cdir_size, (const zip_uint64_t *)offsets, nentry, &za->arena, &error)) == NULL) {
+        _zip_cdir_free(cd);
+        zip_error_fini(&error);
+        return NULL;
+    }
+
+    if (!_zip_hash_map(za->names, table, table_size, hash_entries, names, names_size, (const zip_uint32_t *)name_offsets, nentry, &error)) {
+        _zip_cdir_free(cd);
+        zip_error_fini(&error);
+        return NULL;
+    }
+
+    zip_error_fini(&error);
+    return cd;
+}
+
+
+/* _zip_index_source_new:
+   Creates open source for copy of index data of length bytes. */
+
+zip_source_t *
+_zip_index_source_new(const void *data, zip_uint64_t length, zip_error_t *error) {
+    zip_source_t *src;
+    void *copy = NULL;
+
+    if (length > SIZE_MAX) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    if (length > 0 && (copy = _zip_memdup(data, (size_t)length, error)) == NULL) {
+        return NULL;
+    }
+
+    if ((src = zip_source_buffer_create(copy, length, 1, error)) == NULL) {
+        free(copy);
+        return NULL;
+    }
+    if (zip_source_open(src) < 0) {
+        _zip_error_copy(error, zip_source_error(src));
+        zip_source_free(src);
+        return NULL;
+    }
+
+    return src;
+}
+
+
+/* _zip_index_open_file:
+   Opens archive fname from src, using its index file if it exists and
+   is valid. */
+
+zip_t *
+_zip_index_open_file(zip_source_t *src, const char *fname, int flags, zip_error_t *error) {
+    char *index_name;
+    zip_source_t *index;
+    zip_t *za;
+    size_t length = strlen(fname);
+
+    if ((index_name = (char *)malloc(length + strlen(INDEX_SUFFIX) + 1)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    memcpy(index_name, fname, length);
+    memcpy(index_name + length, INDEX_SUFFIX, strlen(INDEX_SUFFIX) + 1);
+
+    index = open_file(index_name);
+    free(index_name);
+
+    za = _zip_open_from_source(src, flags, index, error);
+
+    if (index != NULL && (za == NULL || za->index_src != index)) {
+        zip_source_free(index);
+    }
+
+    return za;
+}
+
+
+/* open index file fname, mapping it into memory if possible; return NULL if not possible */
+static zip_source_t *
+open_file(const char *fname) {
+    zip_source_t *src;
+    zip_stat_t st;
+    zip_uint8_t *data;
+
+#ifdef HAVE_MMAP
+    src = _zip_source_file_mmap_create(fname, NULL);
+#else
+    src = zip_source_file_create(fname, 0, -1, NULL);
+#endif
+    if (src == NULL) {
+        return NULL;
+    }
+    if (zip_source_stat(src, &st) < 0 || (st.valid & ZIP_STAT_SIZE) == 0 || st.size > SIZE_MAX || st.size < INDEX_HEADER_SIZE || zip_source_open(src) < 0) {
+        zip_source_free(src);
+        return NULL;
+    }
+
+    if (_zip_source_get_data(src, 0, st.size, NULL) != NULL) {
+        return src;
+    }
+
+    /* couldn't be mapped, read into memory */
+    if ((data = (zip_uint8_t *)malloc((size_t)st.size)) == NULL) {
+        zip_source_free(src);
+        return NULL;
+    }
+    if (_zip_read(src, data, st.size, NULL) < 0) {
+        free(data);
+        zip_source_free(src);
+        return NULL;
+    }
+    zip_source_free(src);
+
+    if ((src = zip_source_buffer_create(data, st.size, 1, NULL)) == NULL) {
+        free(data);
+        return NULL;
+    }
+    if (zip_source_open(src) < 0) {
+        zip_source_free(src);
+        return NULL;
+    }
+
+    return src;
+}
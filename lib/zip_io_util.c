@@ -31,6 +31,8 @@
  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -59,6 +61,37 @@ _zip_read(zip_source_t *src, zip_uint8_t *b, zip_uint64_t length, zip_error_t *e
 }
 
 
+
+/* read length bytes at offset, without moving read position if source supports ZIP_SOURCE_READ_AT */
+int
+_zip_read_at_offset(zip_source_t *src, zip_uint64_t offset, zip_uint8_t *b, zip_uint64_t length, zip_error_t *error) {
+    zip_int64_t n;
+
+    if (!ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(src), ZIP_SOURCE_READ_AT)) {
+        if (offset > ZIP_INT64_MAX) {
+            zip_error_set(error, ZIP_ER_SEEK, EFBIG);
+            return -1;
+        }
+        if (zip_source_seek(src, (zip_int64_t)offset, SEEK_SET) < 0) {
+            zip_error_set_from_source(error, src);
+            return -1;
+        }
+        return _zip_read(src, b, length, error);
+    }
+
+    if ((n = zip_source_read_at(src, b, length, offset)) < 0) {
+        zip_error_set_from_source(error, src);
+        return -1;
+    }
+
+    if ((zip_uint64_t)n < length) {
+        zip_error_set(error, ZIP_ER_EOF, 0);
+        return -1;
+    }
+
+    return 0;
+}
+
 zip_uint8_t *
 _zip_read_data(zip_buffer_t *buffer, zip_source_t *src, size_t length, bool nulp, zip_error_t *error) {
     zip_uint8_t *r;
@@ -104,14 +137,31 @@ _zip_read_data(zip_buffer_t *buffer, zip_source_t *src, size_t length, bool nulp
 
 
 zip_string_t *
-_zip_read_string(zip_buffer_t *buffer, zip_source_t *src, zip_uint16_t len, bool nulp, zip_error_t *error) {
+_zip_read_string(zip_buffer_t *buffer, zip_source_t *src, zip_uint16_t len, bool nulp, zip_arena_t *arena, zip_error_t *error) {
     zip_uint8_t *raw;
     zip_string_t *s;
 
+    if (buffer && len > 0) {
+        /* create string directly from buffer, avoiding temporary copy */
+        if ((raw = _zip_buffer_get(buffer, len)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return NULL;
+        }
+        if ((s = _zip_string_new_arena(raw, len, ZIP_FL_ENC_GUESS, arena, error)) != NULL && nulp) {
+            zip_uint8_t *o;
+
+            /* replace any in-string NUL characters with spaces */
+            for (o = s->raw; o < s->raw + len; o++)
+                if (*o == '\0')
+                    *o = ' ';
+        }
+        return s;
+    }
+
     if ((raw = _zip_read_data(buffer, src, len, nulp, error)) == NULL)
         return NULL;
 
-    s = _zip_string_new(raw, len, ZIP_FL_ENC_GUESS, error);
+    s = _zip_string_new_arena(raw, len, ZIP_FL_ENC_GUESS, arena, error);
     free(raw);
     return s;
 }
@@ -0,0 +1,352 @@
+/*
+  zip_lazy_cdir.c -- central directory entries parsed on first use
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zipint.h"
+
+/* offsets of variable field lengths in central directory entry */
+#define CDENTRY_FILENAME_LEN_OFFSET 28
+#define CDENTRY_EF_LEN_OFFSET 30
+#define CDENTRY_COMMENT_LEN_OFFSET 32
+
+static zip_lazy_cdir_t *lazy_cdir_allocate(zip_uint64_t size, zip_arena_t *arena, zip_error_t *error);
+static bool name_is_simple(const zip_uint8_t *entry, zip_uint16_t filename_len, zip_uint16_t ef_len);
+static bool offset_valid(const zip_lazy_cdir_t *lazy, zip_uint64_t idx, zip_error_t *error);
+
+
+zip_lazy_cdir_t *
+_zip_lazy_cdir_new(const zip_uint8_t *data, zip_uint64_t size, zip_arena_t *arena, zip_error_t *error) {
+    zip_lazy_cdir_t *lazy;
+
+    if ((lazy = lazy_cdir_allocate(size, arena, error)) == NULL) {
+        return NULL;
+    }
+
+    if (size > 0) {
+        if (size > SIZE_MAX) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            free(lazy);
+            return NULL;
+        }
+        if ((lazy->data = (zip_uint8_t *)_zip_memdup(data, (size_t)size, error)) == NULL) {
+            free(lazy);
+            return NULL;
+        }
+    }
+
+    return lazy;
+}
+
+
+/* _zip_lazy_cdir_new_mapped:
+   Creates lazy central directory using data and offset of nentry
+   entries in it directly (from index), which must remain valid until
+   it is freed.  Offsets are checked when entries are used.
+*/
+
+zip_lazy_cdir_t *
+_zip_lazy_cdir_new_mapped(const zip_uint8_t *data, zip_uint64_t size, const zip_uint64_t *offset, zip_uint64_t nentry, zip_arena_t *arena, zip_error_t *error) {
+    zip_lazy_cdir_t *lazy;
+
+    if ((lazy = lazy_cdir_allocate(size, arena, error)) == NULL) {
+        return NULL;
+    }
+
+    lazy->data = (zip_uint8_t *)data;
+    lazy->offset = (zip_uint64_t *)offset;
+    lazy->nentry = lazy->nentry_alloc = nentry;
+    lazy->mapped = true;
+
+    return lazy;
+}
+
+
+void
+_zip_lazy_cdir_free(zip_lazy_cdir_t *lazy) {
+    if (lazy == NULL) {
+        return;
+    }
+
+    if (!lazy->mapped) {
+        free(lazy->data);
+        free(lazy->offset);
+    }
+    free(lazy->names);
+    free(lazy);
+}
+
+
+zip_uint64_t
+_zip_lazy_cdir_memory_usage(const zip_lazy_cdir_t *lazy) {
+    if (lazy == NULL) {
+        return 0;
+    }
+
+    if (lazy->mapped) {
+        /* data and offsets are part of index */
+        return sizeof(*lazy);
+    }
+
+    return sizeof(*lazy) + (lazy->data ? lazy->size : 0) + lazy->nentry_alloc * sizeof(lazy->offset[0]) + lazy->names_size;
+}
+
+
+/* _zip_lazy_cdir_add_entry:
+   Records the central directory entry at the current offset of buffer
+   (which must be backed by lazy->data) without parsing it, and skips
+   over it.
+
+   Returns size of entry if successful. On error, error is filled in
+   and -1 is returned.
+*/
+
+zip_int64_t
+_zip_lazy_cdir_add_entry(zip_lazy_cdir_t *lazy, zip_buffer_t *buffer, zip_error_t *error) {
+    zip_uint8_t *entry;
+    zip_uint16_t filename_len;
+    zip_uint32_t size;
+
+    if (_zip_buffer_left(buffer) < CDENTRYSIZE) {
+        zip_error_set(error, ZIP_ER_NOZIP, 0);
+        return -1;
+    }
+
+    entry = _zip_buffer_peek(buffer, CDENTRYSIZE);
+    if (memcmp(entry, CENTRAL_MAGIC, 4) != 0) {
+        zip_error_set(error, ZIP_ER_NOZIP, 0);
+        return -1;
+    }
+
+    filename_len = (zip_uint16_t)(entry[CDENTRY_FILENAME_LEN_OFFSET] | (entry[CDENTRY_FILENAME_LEN_OFFSET + 1] << 8));
+    size = CDENTRYSIZE + (zip_uint32_t)filename_len;
+    size += (zip_uint32_t)(entry[CDENTRY_EF_LEN_OFFSET] | (entry[CDENTRY_EF_LEN_OFFSET + 1] << 8));
+    size += (zip_uint32_t)(entry[CDENTRY_COMMENT_LEN_OFFSET] | (entry[CDENTRY_COMMENT_LEN_OFFSET + 1] << 8));
+
+    if (_zip_buffer_left(buffer) < size) {
+        zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_VARIABLE_SIZE_OVERFLOW);
+        return -1;
+    }
+
+    if (lazy->nentry == lazy->nentry_alloc) {
+        zip_uint64_t *offset;
+        zip_uint64_t nentry_alloc = lazy->nentry_alloc > 0 ? lazy->nentry_alloc * 2 : 16;
+
+        if (sizeof(zip_uint64_t) * nentry_alloc > SIZE_MAX || (offset = (zip_uint64_t *)realloc(lazy->offset, sizeof(zip_uint64_t) * (size_t)nentry_alloc)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return -1;
+        }
+        lazy->offset = offset;
+        lazy->nentry_alloc = nentry_alloc;
+    }
+
+    lazy->offset[lazy->nentry++] = _zip_buffer_offset(buffer);
+    lazy->names_size += (zip_uint64_t)filename_len + 1;
+    _zip_buffer_skip(buffer, size);
+
+    return (zip_int64_t)size;
+}
+
+
+/* _zip_lazy_cdir_get_name:
+   Sets *namep to the file name of entry idx, as it will be returned by
+   _zip_string_get once the entry is parsed. If this can't be determined
+   without parsing the entry (non-ASCII name or UTF-8 name extra field),
+   *namep is set to NULL.
+
+   Returns false on error.
+*/
+
+bool
+_zip_lazy_cdir_get_name(zip_lazy_cdir_t *lazy, zip_uint64_t idx, const zip_uint8_t **namep, zip_error_t *error) {
+    const zip_uint8_t *entry;
+    zip_uint16_t filename_len, ef_len;
+    zip_uint8_t *name;
+
+    *namep = NULL;
+
+    if (idx >= lazy->nentry) {
+        zip_error_set(error, ZIP_ER_INTERNAL, 0);
+        return false;
+    }
+    if (!offset_valid(lazy, idx, error)) {
+        return false;
+    }
+
+    entry = lazy->data + lazy->offset[idx];
+    filename_len = (zip_uint16_t)(entry[CDENTRY_FILENAME_LEN_OFFSET] | (entry[CDENTRY_FILENAME_LEN_OFFSET + 1] << 8));
+    ef_len = (zip_uint16_t)(entry[CDENTRY_EF_LEN_OFFSET] | (entry[CDENTRY_EF_LEN_OFFSET + 1] << 8));
+
+    if (!name_is_simple(entry, filename_len, ef_len)) {
+        return true;
+    }
+
+    if (lazy->names == NULL) {
+        if (lazy->names_size > SIZE_MAX || (lazy->names = (zip_uint8_t *)malloc((size_t)lazy->names_size)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+    }
+
+    if (lazy->names_size - lazy->names_used < (zip_uint64_t)filename_len + 1) {
+        zip_error_set(error, ZIP_ER_INTERNAL, 0);
+        return false;
+    }
+
+    name = lazy->names + lazy->names_used;
+    memcpy(name, entry + CDENTRYSIZE, filename_len);
+    name[filename_len] = '\0';
+    lazy->names_used += (zip_uint64_t)filename_len + 1;
+
+    *namep = name;
+    return true;
+}
+
+
+/* _zip_lazy_cdir_read_entry:
+   Parses central directory entry idx into entry->orig, unless that has
+   already been done or the entry doesn't come from lazy.
+*/
+
+bool
+_zip_lazy_cdir_read_entry(zip_lazy_cdir_t *lazy, zip_entry_t *entry, zip_uint64_t idx, zip_error_t *error) {
+    zip_buffer_t *buffer;
+    zip_dirent_t *de;
+
+    if (lazy == NULL || entry->orig != NULL || idx >= lazy->nentry) {
+        return true;
+    }
+
+    if (!offset_valid(lazy, idx, error)) {
+        return false;
+    }
+
+    if ((buffer = _zip_buffer_new(lazy->data + lazy->offset[idx], lazy->size - lazy->offset[idx])) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    if ((de = _zip_dirent_new(lazy->arena)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        _zip_buffer_free(buffer);
+        return false;
+    }
+
+    if (_zip_dirent_read(de, NULL, buffer, false, lazy->arena, error) < 0) {
+        if (zip_error_code_zip(error) == ZIP_ER_INCONS) {
+            zip_error_set(error, ZIP_ER_INCONS, ADD_INDEX_TO_DETAIL(zip_error_code_system(error), idx));
+        }
+        _zip_dirent_free(de);
+        _zip_buffer_free(buffer);
+        return false;
+    }
+
+    _zip_buffer_free(buffer);
+    entry->orig = de;
+
+    return true;
+}
+
+
+static zip_lazy_cdir_t *
+lazy_cdir_allocate(zip_uint64_t size, zip_arena_t *arena, zip_error_t *error) {
+    zip_lazy_cdir_t *lazy;
+
+    if ((lazy = (zip_lazy_cdir_t *)malloc(sizeof(*lazy))) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+
+    lazy->data = NULL;
+    lazy->size = size;
+    lazy->nentry = lazy->nentry_alloc = 0;
+    lazy->offset = NULL;
+    lazy->names = NULL;
+    lazy->names_size = lazy->names_used = 0;
+    lazy->arena = arena;
+    lazy->mapped = false;
+
+    return lazy;
+}
+
+
+/* name_is_simple:
+   Returns true if the file name of the central directory entry is plain
+   ASCII and not overridden by a UTF-8 name extra field.
+*/
+
+static bool
+name_is_simple(const zip_uint8_t *entry, zip_uint16_t filename_len, zip_uint16_t ef_len) {
+    const zip_uint8_t *p, *end;
+
+    for (p = entry + CDENTRYSIZE, end = p + filename_len; p < end; p++) {
+        if (*p == 0 || *p > 0x7f) {
+            return false;
+        }
+    }
+
+    end = p + ef_len;
+    while (p < end) {
+        zip_uint16_t id, length;
+
+        if (end - p < 4) {
+            return false;
+        }
+        id = (zip_uint16_t)(p[0] | (p[1] << 8));
+        length = (zip_uint16_t)(p[2] | (p[3] << 8));
+        p += 4;
+        if (id == ZIP_EF_UTF_8_NAME || length > end - p) {
+            return false;
+        }
+        p += length;
+    }
+
+    return true;
+}
+
+
+/* offset_valid:
+   Returns true if a central directory entry header fits at the offset
+   of entry idx.  Offsets taken from an index are only checked here.
+*/
+
+static bool
+offset_valid(const zip_lazy_cdir_t *lazy, zip_uint64_t idx, zip_error_t *error) {
+    if (lazy->offset[idx] >= lazy->size || lazy->size - lazy->offset[idx] < CDENTRYSIZE) {
+        zip_error_set(error, ZIP_ER_INCONS, MAKE_DETAIL_WITH_INDEX(ZIP_ER_DETAIL_CDIR_ENTRY_INVALID, idx));
+        return false;
+    }
+
+    return true;
+}
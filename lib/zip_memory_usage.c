@@ -0,0 +1,233 @@
+/*
+  zip_memory_usage.c -- report memory used by archives and files
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zipint.h"
+
+/* Memory usage is computed on demand by walking the data structures of
+   the archive, so keeping track of it costs nothing until it is
+   queried.  Only compression libraries, whose allocations are not
+   visible otherwise, are given counting allocators. */
+
+/* keeps memory returned by _zip_memory_alloc aligned like malloc */
+#define MEMORY_HEADER_SIZE 16
+
+/* size of zip_memory_usage_t in the first version; later versions only add members at the end */
+#define MEMORY_USAGE_MIN_SIZE (offsetof(zip_memory_usage_t, total) + sizeof(zip_uint64_t))
+
+typedef struct {
+    zip_memory_usage_t *usage;
+    zip_uint64_t arena_used; /* bytes counted that were allocated from the arena */
+} usage_context_t;
+
+static void dirent_usage(usage_context_t *ctx, const zip_dirent_t *de);
+static void extra_fields_usage(usage_context_t *ctx, const zip_extra_field_t *ef);
+static zip_uint64_t string_usage(usage_context_t *ctx, const zip_string_t *string);
+
+
+ZIP_EXTERN int
+zip_get_memory_usage(zip_t *za, zip_memory_usage_t *caller_usage) {
+    zip_memory_usage_t result, *usage;
+    usage_context_t ctx;
+    zip_uint64_t i, arena_size, size;
+
+    /* size lets members be added later without breaking callers compiled against other versions */
+    if (caller_usage == NULL || caller_usage->size < MEMORY_USAGE_MIN_SIZE) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+    size = caller_usage->size;
+
+    usage = &result;
+    memset(usage, 0, sizeof(*usage));
+    ctx.usage = usage;
+    ctx.arena_used = 0;
+
+    usage->archive = sizeof(*za) + za->nopen_source_alloc * sizeof(za->open_source[0]);
+    if (za->default_password) {
+        usage->archive += strlen(za->default_password) + 1;
+    }
+    usage->archive += string_usage(&ctx, za->comment_orig);
+    if (za->comment_changed) {
+        usage->archive += string_usage(&ctx, za->comment_changes);
+    }
+
+    usage->entries = za->nentry_alloc * sizeof(za->entry[0]);
+    for (i = 0; i < za->nentry; i++) {
+        zip_entry_t *entry = za->entry + i;
+
+        if (entry->orig) {
+            dirent_usage(&ctx, entry->orig);
+        }
+        if (entry->changes) {
+            dirent_usage(&ctx, entry->changes);
+        }
+        usage->sources += _zip_source_memory_usage(entry->source, NULL);
+        usage->checkpoints += _zip_checkpoints_memory_usage(entry->checkpoints);
+    }
+
+    usage->name_lookup = _zip_hash_memory_usage(za->names) + _zip_name_index_memory_usage(za) + _zip_dir_index_memory_usage(za);
+    usage->central_directory = _zip_lazy_cdir_memory_usage(za->lazy_cdir);
+    usage->sources += _zip_source_memory_usage(za->src, NULL);
+    usage->sources += _zip_compression_pool_memory_usage(za->decompression_pool);
+
+    arena_size = _zip_arena_memory_usage(&za->arena);
+    usage->unused = arena_size > ctx.arena_used ? arena_size - ctx.arena_used : 0;
+
+    usage->total = usage->archive + usage->entries + usage->strings + usage->extra_fields + usage->name_lookup + usage->central_directory + usage->sources + usage->checkpoints + usage->unused;
+
+    /* members unknown to caller are not filled in, members unknown to us are left unchanged */
+    usage->size = size;
+    memcpy(caller_usage, usage, (size_t)ZIP_MIN(size, sizeof(*usage)));
+
+    return 0;
+}
+
+
+ZIP_EXTERN zip_uint64_t
+zip_file_get_memory_usage(zip_file_t *zf) {
+    /* the archive's source is accounted to the archive */
+    return sizeof(*zf) + _zip_source_memory_usage(zf->src, zf->za ? zf->za->src : NULL);
+}
+
+
+/* allocate memory, adding the amount allocated to *usage */
+void *
+_zip_memory_alloc(zip_uint64_t *usage, zip_uint64_t size) {
+    zip_uint8_t *ptr;
+
+    if (size > SIZE_MAX - MEMORY_HEADER_SIZE) {
+        return NULL;
+    }
+    if ((ptr = (zip_uint8_t *)malloc((size_t)size + MEMORY_HEADER_SIZE)) == NULL) {
+        return NULL;
+    }
+
+    memcpy(ptr, &size, sizeof(size));
+    *usage += size + MEMORY_HEADER_SIZE;
+
+    return ptr + MEMORY_HEADER_SIZE;
+}
+
+
+/* free memory allocated by _zip_memory_alloc, subtracting it from *usage */
+void
+_zip_memory_free(zip_uint64_t *usage, void *ptr) {
+    zip_uint8_t *block;
+    zip_uint64_t size;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    block = (zip_uint8_t *)ptr - MEMORY_HEADER_SIZE;
+    memcpy(&size, block, sizeof(size));
+    *usage -= size + MEMORY_HEADER_SIZE;
+
+    free(block);
+}
+
+
+/* memory used by src and the sources below it, up to but not including stop */
+zip_uint64_t
+_zip_source_memory_usage(const zip_source_t *src, const zip_source_t *stop) {
+    zip_uint64_t usage = 0;
+
+    for (; src != NULL && src != stop; src = src->src) {
+        usage += sizeof(*src);
+        if (src->memory_usage) {
+            usage += src->memory_usage(src->ud);
+        }
+    }
+
+    return usage;
+}
+
+
+static void
+dirent_usage(usage_context_t *ctx, const zip_dirent_t *de) {
+    ctx->usage->entries += sizeof(*de);
+    if (de->from_arena) {
+        ctx->arena_used += sizeof(*de);
+    }
+
+    /* cloned entries share unchanged strings and extra fields with the original */
+    if (!de->cloned || de->changed & ZIP_DIRENT_FILENAME) {
+        ctx->usage->strings += string_usage(ctx, de->filename);
+    }
+    if (!de->cloned || de->changed & ZIP_DIRENT_COMMENT) {
+        ctx->usage->strings += string_usage(ctx, de->comment);
+    }
+    if (!de->cloned || de->changed & ZIP_DIRENT_EXTRA_FIELD) {
+        extra_fields_usage(ctx, de->extra_fields);
+    }
+    if ((!de->cloned || de->changed & ZIP_DIRENT_PASSWORD) && de->password) {
+        ctx->usage->entries += strlen(de->password) + 1;
+    }
+}
+
+
+static void
+extra_fields_usage(usage_context_t *ctx, const zip_extra_field_t *ef) {
+    for (; ef; ef = ef->next) {
+        zip_uint64_t size = sizeof(*ef) + ef->size;
+
+        ctx->usage->extra_fields += size;
+        if (ef->from_arena) {
+            ctx->arena_used += size;
+        }
+    }
+}
+
+
+static zip_uint64_t
+string_usage(usage_context_t *ctx, const zip_string_t *string) {
+    zip_uint64_t size;
+
+    if (string == NULL) {
+        return 0;
+    }
+
+    size = sizeof(*string) + string->length + 1;
+    if (string->from_arena) {
+        ctx->arena_used += size;
+    }
+    if (string->converted) {
+        size += (zip_uint64_t)string->converted_length + 1;
+    }
+
+    return size;
+}
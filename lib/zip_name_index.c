@@ -0,0 +1,331 @@
+/*
+  zip_name_index.c -- indexes for name lookup with flags
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_STRINGS_H
+#include <strings.h>
+#endif
+
+#include "zipint.h"
+
+/* flags that select an index */
+#define NAME_INDEX_FLAGS (ZIP_FL_NOCASE | ZIP_FL_NODIR | ZIP_FL_ENC_RAW | ZIP_FL_ENC_STRICT | ZIP_FL_UNCHANGED)
+
+#define NAME_INDEX_MIN_SIZE 256
+#define NAME_INDEX_EMPTY ZIP_UINT64_MAX
+
+/* An index maps the hash of each entry's name (as compared by
+   _zip_name_locate with these flags) to the entry's index, using
+   open addressing with linear probing.  An entry can be in the table
+   more than once and under names it no longer has: when a name
+   changes, the new name is added without removing the old one, and
+   every match is checked against the current name of the entry.  The
+   index is rebuilt once too many of these stale slots accumulate. */
+
+typedef struct {
+    zip_uint64_t index; /* NAME_INDEX_EMPTY if unused */
+    zip_uint32_t hash_value;
+} zip_name_index_slot_t;
+
+struct zip_name_index {
+    zip_name_index_t *next;
+    zip_flags_t flags;
+    zip_uint64_t table_size; /* power of 2 */
+    zip_uint64_t nused;      /* number of slots in use */
+    zip_name_index_slot_t *table;
+};
+
+
+/* hash of name, folding case if flags include ZIP_FL_NOCASE */
+static zip_uint32_t
+hash_name(const char *name, zip_flags_t flags) {
+    zip_uint64_t value = 0xcbf29ce484222325ull;
+    const unsigned char *p;
+
+    for (p = (const unsigned char *)name; *p != '\0'; p++) {
+        value ^= (flags & ZIP_FL_NOCASE) ? (zip_uint64_t)tolower(*p) : (zip_uint64_t)*p;
+        value *= 0x100000001b3ull;
+    }
+
+    return (zip_uint32_t)(value ^ (value >> 32));
+}
+
+
+/* name of entry idx as compared by _zip_name_locate, NULL if none */
+static const char *
+entry_name(zip_t *za, zip_uint64_t idx, zip_flags_t flags) {
+    zip_error_t error;
+    const char *name, *p;
+
+    zip_error_init(&error);
+    name = _zip_get_name(za, idx, flags, &error);
+    zip_error_fini(&error);
+
+    if (name != NULL && (flags & ZIP_FL_NODIR)) {
+        if ((p = strrchr(name, '/')) != NULL) {
+            name = p + 1;
+        }
+    }
+
+    return name;
+}
+
+
+static void
+insert_slot(zip_name_index_slot_t *table, zip_uint64_t table_size, zip_name_index_slot_t slot) {
+    zip_uint64_t pos = slot.hash_value & (table_size - 1);
+
+    while (table[pos].index != NAME_INDEX_EMPTY) {
+        pos = (pos + 1) & (table_size - 1);
+    }
+    table[pos] = slot;
+}
+
+
+static bool
+index_resize(zip_name_index_t *index, zip_uint64_t new_size) {
+    zip_name_index_slot_t *table;
+    zip_uint64_t i;
+
+    if (new_size > SIZE_MAX / sizeof(*table) || (table = (zip_name_index_slot_t *)malloc(sizeof(*table) * (size_t)new_size)) == NULL) {
+        return false;
+    }
+    for (i = 0; i < new_size; i++) {
+        table[i].index = NAME_INDEX_EMPTY;
+    }
+    for (i = 0; i < index->table_size; i++) {
+        if (index->table[i].index != NAME_INDEX_EMPTY) {
+            insert_slot(table, new_size, index->table[i]);
+        }
+    }
+
+    free(index->table);
+    index->table = table;
+    index->table_size = new_size;
+
+    return true;
+}
+
+
+static bool
+index_add(zip_name_index_t *index, const char *name, zip_uint64_t idx) {
+    zip_name_index_slot_t slot;
+
+    /* keep table at most half full */
+    if ((index->nused + 1) * 2 > index->table_size) {
+        if (!index_resize(index, index->table_size == 0 ? NAME_INDEX_MIN_SIZE : index->table_size * 2)) {
+            return false;
+        }
+    }
+
+    slot.index = idx;
+    slot.hash_value = hash_name(name, index->flags);
+    insert_slot(index->table, index->table_size, slot);
+    index->nused++;
+
+    return true;
+}
+
+
+static void
+index_free(zip_name_index_t *index) {
+    free(index->table);
+    free(index);
+}
+
+
+static zip_name_index_t *
+index_new(zip_t *za, zip_flags_t flags) {
+    zip_name_index_t *index;
+    zip_uint64_t i, size;
+
+    if ((index = (zip_name_index_t *)malloc(sizeof(*index))) == NULL) {
+        return NULL;
+    }
+    index->flags = flags;
+    index->table_size = 0;
+    index->nused = 0;
+    index->table = NULL;
+
+    for (size = NAME_INDEX_MIN_SIZE; size < za->nentry * 2; size *= 2) {
+    }
+    if (!index_resize(index, size)) {
+        index_free(index);
+        return NULL;
+    }
+
+    for (i = 0; i < za->nentry; i++) {
+        const char *name;
+
+        if ((name = entry_name(za, i, flags)) == NULL) {
+            continue;
+        }
+        if (!index_add(index, name, i)) {
+            index_free(index);
+            return NULL;
+        }
+    }
+
+    return index;
+}
+
+
+/* Find entry named fname using index for flags, building it if needed.
+   Returns false if no index is available, in which case the caller has to search itself. */
+
+bool
+_zip_name_index_lookup(zip_t *za, const char *fname, zip_flags_t flags, zip_int64_t *idxp) {
+    zip_name_index_t *index, **prev;
+    int (*cmp)(const char *, const char *);
+    zip_uint64_t pos, found;
+    zip_uint32_t hash_value;
+
+    flags &= NAME_INDEX_FLAGS;
+
+    for (prev = &za->name_indexes; (index = *prev) != NULL; prev = &index->next) {
+        if (index->flags == flags) {
+            break;
+        }
+    }
+
+    if (index != NULL && index->nused > za->nentry * 2 + NAME_INDEX_MIN_SIZE) {
+        /* too many stale slots, rebuild */
+        *prev = index->next;
+        index_free(index);
+        index = NULL;
+    }
+
+    if (index == NULL) {
+        if ((index = index_new(za, flags)) == NULL) {
+            return false;
+        }
+        index->next = za->name_indexes;
+        za->name_indexes = index;
+    }
+
+    cmp = (flags & ZIP_FL_NOCASE) ? strcasecmp : strcmp;
+    hash_value = hash_name(fname, flags);
+    found = NAME_INDEX_EMPTY;
+
+    for (pos = hash_value & (index->table_size - 1); index->table[pos].index != NAME_INDEX_EMPTY; pos = (pos + 1) & (index->table_size - 1)) {
+        const zip_name_index_slot_t *slot = index->table + pos;
+        const char *name;
+
+        if (slot->hash_value != hash_value || slot->index >= found || slot->index >= za->nentry) {
+            continue;
+        }
+        if ((name = entry_name(za, slot->index, flags)) != NULL && cmp(fname, name) == 0) {
+            found = slot->index;
+        }
+    }
+
+    *idxp = (found == NAME_INDEX_EMPTY ? -1 : (zip_int64_t)found);
+    return true;
+}
+
+
+/* Add entries from first on, which were read by zip_refresh, to indexes. */
+
+void
+_zip_name_index_add(zip_t *za, zip_uint64_t first) {
+    zip_name_index_t *index, **prev;
+    zip_uint64_t idx;
+
+    prev = &za->name_indexes;
+    while ((index = *prev) != NULL) {
+        for (idx = first; idx < za->nentry; idx++) {
+            const char *name;
+
+            if ((name = entry_name(za, idx, index->flags)) != NULL && !index_add(index, name, idx)) {
+                break;
+            }
+        }
+        if (idx < za->nentry) {
+            /* drop index, will be rebuilt when needed */
+            *prev = index->next;
+            index_free(index);
+            continue;
+        }
+        prev = &index->next;
+    }
+}
+
+
+/* Add current name of entry idx to indexes after it changed. */
+
+void
+_zip_name_index_update(zip_t *za, zip_uint64_t idx) {
+    zip_name_index_t *index, **prev;
+
+    prev = &za->name_indexes;
+    while ((index = *prev) != NULL) {
+        const char *name;
+
+        /* original names never change */
+        if ((index->flags & ZIP_FL_UNCHANGED) == 0 && (name = entry_name(za, idx, index->flags)) != NULL) {
+            if (!index_add(index, name, idx)) {
+                /* drop index, will be rebuilt when needed */
+                *prev = index->next;
+                index_free(index);
+                continue;
+            }
+        }
+        prev = &index->next;
+    }
+}
+
+
+void
+_zip_name_index_free(zip_t *za) {
+    zip_name_index_t *index;
+
+    while ((index = za->name_indexes) != NULL) {
+        za->name_indexes = index->next;
+        index_free(index);
+    }
+}
+
+
+zip_uint64_t
+_zip_name_index_memory_usage(const zip_t *za) {
+    const zip_name_index_t *index;
+    zip_uint64_t usage = 0;
+
+    for (index = za->name_indexes; index; index = index->next) {
+        usage += sizeof(*index) + index->table_size * sizeof(index->table[0]);
+    }
+
+    return usage;
+}
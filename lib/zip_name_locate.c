@@ -32,6 +32,7 @@
 */
 
 
+#include <stdlib.h>
 #include <string.h>
 #ifdef HAVE_STRINGS_H
 #include <strings.h>
@@ -39,6 +40,9 @@
 
 #include "zipint.h"
 
+/* minimum number of names per thread for zip_name_locate_many with ZIP_PARALLEL */
+#define NAME_LOCATE_PARALLEL_MIN_NAMES 16384
+
 
 ZIP_EXTERN zip_int64_t
 zip_name_locate(zip_t *za, const char *fname, zip_flags_t flags) {
@@ -46,6 +50,104 @@ zip_name_locate(zip_t *za, const char *fname, zip_flags_t flags) {
 }
 
 
+static bool
+is_ascii(const char *name) {
+    const zip_uint8_t *p;
+
+    for (p = (const zip_uint8_t *)name; *p != '\0'; p++) {
+        if (*p > 0x7f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+ZIP_EXTERN zip_int64_t
+zip_name_locate_many(zip_t *za, const char *const *names, zip_uint64_t nnames, zip_int64_t *indices, zip_flags_t flags) {
+    const char **converted = NULL;
+    zip_string_t **strings = NULL;
+    const char *const *lookup = names;
+    zip_uint64_t i, nfound;
+    zip_int64_t ret = -1;
+
+    if (nnames == 0) {
+        return 0;
+    }
+    if (names == NULL || indices == NULL || nnames > ZIP_INT64_MAX || nnames > SIZE_MAX / sizeof(*strings)) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    for (i = 0; i < nnames; i++) {
+        if (names[i] == NULL || strlen(names[i]) > ZIP_UINT16_MAX) {
+            zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+            return -1;
+        }
+
+        /* ASCII names are the same in all encodings, only convert others */
+        if ((flags & (ZIP_FL_ENC_UTF_8 | ZIP_FL_ENC_RAW)) == 0 && !is_ascii(names[i])) {
+            if (converted == NULL) {
+                if ((converted = (const char **)malloc(sizeof(*converted) * (size_t)nnames)) == NULL || (strings = (zip_string_t **)calloc((size_t)nnames, sizeof(*strings))) == NULL) {
+                    zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+                    goto done;
+                }
+                memcpy(converted, names, sizeof(*converted) * (size_t)nnames);
+                lookup = converted;
+            }
+            if ((strings[i] = _zip_string_new((const zip_uint8_t *)names[i], (zip_uint16_t)strlen(names[i]), flags, &za->error)) == NULL) {
+                goto done;
+            }
+            if ((converted[i] = (const char *)_zip_string_get(strings[i], NULL, 0, &za->error)) == NULL) {
+                goto done;
+            }
+        }
+    }
+
+    if (flags & (ZIP_FL_NOCASE | ZIP_FL_NODIR | ZIP_FL_ENC_RAW | ZIP_FL_ENC_STRICT)) {
+        /* names are converted already */
+        zip_flags_t locate_flags = (flags & ~ZIP_FL_ENCODING_ALL) | ((flags & ZIP_FL_ENC_RAW) ? 0 : ZIP_FL_ENC_UTF_8);
+
+        nfound = 0;
+        for (i = 0; i < nnames; i++) {
+            zip_error_t error;
+
+            zip_error_init(&error);
+            if ((indices[i] = _zip_name_locate(za, lookup[i], locate_flags, &error)) >= 0) {
+                nfound++;
+            }
+            else if (zip_error_code_zip(&error) != ZIP_ER_NOENT) {
+                zip_error_set(&za->error, zip_error_code_zip(&error), zip_error_code_system(&error));
+                zip_error_fini(&error);
+                goto done;
+            }
+            zip_error_fini(&error);
+        }
+    }
+    else {
+        unsigned int nthreads = 1;
+
+        if (za->open_flags & ZIP_PARALLEL) {
+            nthreads = _zip_parallel_threads(nnames, NAME_LOCATE_PARALLEL_MIN_NAMES);
+        }
+        nfound = _zip_hash_lookup_many(za->names, (const zip_uint8_t *const *)lookup, nnames, flags, indices, nthreads);
+    }
+
+    ret = (zip_int64_t)nfound;
+
+done:
+    if (strings != NULL) {
+        for (i = 0; i < nnames; i++) {
+            _zip_string_free(strings[i]);
+        }
+    }
+    free(strings);
+    free(converted);
+    return ret;
+}
+
+
 zip_int64_t
 _zip_name_locate(zip_t *za, const char *fname, zip_flags_t flags, zip_error_t *error) {
     int (*cmp)(const char *, const char *);
@@ -81,7 +183,21 @@ _zip_name_locate(zip_t *za, const char *fname, zip_flags_t flags, zip_error_t *e
     }
 
     if (flags & (ZIP_FL_NOCASE | ZIP_FL_NODIR | ZIP_FL_ENC_RAW | ZIP_FL_ENC_STRICT)) {
-        /* can't use hash table */
+        zip_int64_t idx;
+
+        /* can't use hash table, use index for flags */
+        if (_zip_name_index_lookup(za, fname, flags, &idx)) {
+            if (idx >= 0) {
+                _zip_error_clear(error);
+            }
+            else {
+                zip_error_set(error, ZIP_ER_NOENT, 0);
+            }
+            _zip_string_free(str);
+            return idx;
+        }
+
+        /* no index available, search all entries */
         cmp = (flags & ZIP_FL_NOCASE) ? strcasecmp : strcmp;
 
         for (i = 0; i < za->nentry; i++) {
@@ -67,6 +67,20 @@ _zip_new(zip_error_t *error) {
     za->entry = NULL;
     za->nopen_source = za->nopen_source_alloc = 0;
     za->open_source = NULL;
+    za->name_indexes = NULL;
+    za->dir_index = NULL;
+    za->lazy_cdir = NULL;
+    za->index_src = NULL;
+    za->cdir_offset = 0;
+    za->cdir_size = 0;
+    za->cdir_crc = 0; /* of empty central directory */
+    za->cdir_crc_valid = true;
+    _zip_arena_init(&za->arena);
+    _zip_dostime_cache_init(&za->dostime_cache);
+    za->checkpoint_interval = 0;
+    za->readahead = 0;
+    za->readahead_next = 0;
+    za->decompression_pool = NULL;
     za->progress = NULL;
 
     return za;
@@ -39,15 +39,65 @@
 #include "zipint.h"
 
 typedef enum { EXISTS_ERROR = -1, EXISTS_NOT = 0, EXISTS_OK } exists_t;
+
+#define EOCD_TAIL_SIZE 1024 /* size of first read when searching for EOCD */
+#define EOCD_SCORE_BEST 7   /* highest score of _zip_eocd_score */
+#define EOCD_MAX_ATTEMPTS 8 /* maximum number of central directories read when searching for EOCD */
+
+#define CHECKCONS_BUFSIZE (1024 * 1024)        /* maximum size of one read of local headers */
+#define CHECKCONS_HEADER_SLACK 1024            /* room for local extra fields not in central directory */
+#define CHECKCONS_PARALLEL_MIN_ENTRIES 1024    /* minimum number of local headers per thread */
+
+typedef struct {
+    zip_uint64_t offset;
+    zip_uint64_t index;
+} zip_checkcons_entry_t;
+
+/* local headers read in one go by _zip_checkcons */
+typedef struct {
+    zip_cdir_t *cd;
+    zip_checkcons_entry_t *entries; /* all entries, sorted by offset */
+    zip_uint64_t start;             /* first entry in current batch */
+    zip_uint64_t end;               /* end of current batch */
+    zip_uint8_t *data;
+    zip_uint64_t data_offset;
+    zip_uint64_t data_length;
+    unsigned int nthreads;
+    zip_uint64_t failed[ZIP_PARALLEL_MAX_THREADS]; /* first entry with error per thread */
+    zip_error_t error[ZIP_PARALLEL_MAX_THREADS];
+} zip_checkcons_t;
+
+/* end of central directory record found while searching the end of the archive */
+typedef struct {
+    zip_uint64_t position;  /* offset of EOCD in archive */
+    zip_uint64_t cdir_end;  /* offset of EOCD64 or EOCD, where central directory should end */
+    zip_uint64_t nentry;
+    zip_uint64_t size;
+    zip_uint64_t offset;
+    zip_uint16_t comment_length;
+    bool is_zip64;
+    int score;
+} zip_eocd_t;
+
+static bool _zip_add_names_parallel(zip_t *za, unsigned int nthreads, zip_error_t *error);
 static zip_t *_zip_allocate_new(zip_source_t *src, unsigned int flags, zip_error_t *error);
-static zip_int64_t _zip_checkcons(zip_t *za, zip_cdir_t *cdir, zip_error_t *error);
-static zip_cdir_t *_zip_find_central_dir(zip_t *za, zip_uint64_t len);
+static zip_int64_t _zip_checkcons(zip_t *za, zip_cdir_t *cdir, zip_uint64_t first, zip_error_t *error);
 static exists_t _zip_file_exists(zip_source_t *src, zip_error_t *error);
 static int _zip_headercomp(const zip_dirent_t *, const zip_dirent_t *);
 static const unsigned char *_zip_memmem(const unsigned char *, size_t, const unsigned char *, size_t);
-static zip_cdir_t *_zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_error_t *error);
-static zip_cdir_t *_zip_read_eocd(zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_error_t *error);
-static zip_cdir_t *_zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_error_t *error);
+static zip_source_t *_zip_open_file_source(const char *fn, int flags, zip_error_t *error);
+static int _zip_checkcons_compare(const void *a, const void *b);
+static zip_uint64_t _zip_checkcons_header_size(const zip_cdir_t *cd, const zip_checkcons_entry_t *entry);
+static void _zip_checkcons_batch(void *ud, unsigned int thread);
+static bool _zip_checkcons_entry(zip_cdir_t *cd, zip_uint64_t index, zip_source_t *src, zip_buffer_t *buffer, zip_error_t *error);
+static const zip_uint8_t *_zip_checkcons_in_data(const zip_checkcons_t *cc, const zip_checkcons_entry_t *entry);
+static int _zip_eocd_compare(const void *a, const void *b);
+static int _zip_eocd_score(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_uint64_t len, const zip_eocd_t *eocd);
+static bool _zip_read_cdir_unchanged(zip_t *za, zip_buffer_t *cd_buffer, zip_error_t *error);
+static zip_cdir_t *_zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, const zip_eocd_t *eocd, bool refresh, zip_error_t *error);
+static bool _zip_read_eocd(zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_eocd_t *eocd, zip_error_t *error);
+static bool _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_eocd_t *eocd, zip_error_t *error);
+static bool _zip_read_eocd_record(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_eocd_t *eocd, zip_error_t *error);
 
 
 ZIP_EXTERN zip_t *
@@ -57,13 +107,19 @@ zip_open(const char *fn, int _flags, int *zep) {
     struct zip_error error;
 
     zip_error_init(&error);
-    if ((src = zip_source_file_create(fn, 0, -1, &error)) == NULL) {
+    if ((src = _zip_open_file_source(fn, _flags, &error)) == NULL) {
         _zip_set_open_error(zep, &error, 0);
         zip_error_fini(&error);
         return NULL;
     }
 
-    if ((za = zip_open_from_source(src, _flags, &error)) == NULL) {
+    if (_flags >= 0 && (_flags & ZIP_INDEX)) {
+        za = _zip_index_open_file(src, fn, _flags, &error);
+    }
+    else {
+        za = zip_open_from_source(src, _flags, &error);
+    }
+    if (za == NULL) {
         zip_source_free(src);
         _zip_set_open_error(zep, &error, 0);
         zip_error_fini(&error);
@@ -75,8 +131,55 @@ zip_open(const char *fn, int _flags, int *zep) {
 }
 
 
+/* _zip_open_file_source:
+   Creates the source for reading archive fn.  With ZIP_MMAP, read-only
+   archives are read from a memory mapping. */
+
+static zip_source_t *
+_zip_open_file_source(const char *fn, int flags, zip_error_t *error) {
+#ifdef HAVE_MMAP
+    if (flags >= 0 && (flags & (ZIP_MMAP | ZIP_RDONLY)) == (ZIP_MMAP | ZIP_RDONLY)) {
+        return _zip_source_file_mmap_create(fn, error);
+    }
+#endif
+
+    return zip_source_file_create(fn, 0, -1, error);
+}
+
+
 ZIP_EXTERN zip_t *
 zip_open_from_source(zip_source_t *src, int _flags, zip_error_t *error) {
+    return _zip_open_from_source(src, _flags, NULL, error);
+}
+
+
+ZIP_EXTERN zip_t *
+zip_open_from_source_with_index(zip_source_t *src, int _flags, const void *index, zip_uint64_t index_length, zip_error_t *error) {
+    zip_source_t *index_src = NULL;
+    zip_t *za;
+
+    /* archive keeps using index, but caller may free it */
+    if (index != NULL && (index_src = _zip_index_source_new(index, index_length, error)) == NULL) {
+        return NULL;
+    }
+
+    za = _zip_open_from_source(src, _flags, index_src, error);
+
+    if (index_src != NULL && (za == NULL || za->index_src != index_src)) {
+        zip_source_free(index_src);
+    }
+
+    return za;
+}
+
+
+/* _zip_open_from_source:
+   Like zip_open_from_source, but uses index (an open source, if not
+   NULL) if it is valid for the archive.  In that case, the archive
+   keeps it in index_src; otherwise, the caller has to free it. */
+
+zip_t *
+_zip_open_from_source(zip_source_t *src, int _flags, zip_source_t *index, zip_error_t *error) {
     unsigned int flags;
     zip_int64_t supported;
     exists_t exists;
@@ -129,7 +232,7 @@ zip_open_from_source(zip_source_t *src, int _flags, zip_error_t *error) {
         }
         else {
             /* ZIP_CREATE gets ignored if file exists and not ZIP_EXCL, just like open() */
-            za = _zip_open(src, flags, error);
+            za = _zip_open(src, flags, index, error);
         }
 
         if (za == NULL) {
@@ -143,11 +246,13 @@ zip_open_from_source(zip_source_t *src, int _flags, zip_error_t *error) {
 
 
 zip_t *
-_zip_open(zip_source_t *src, unsigned int flags, zip_error_t *error) {
+_zip_open(zip_source_t *src, unsigned int flags, zip_source_t *index, zip_error_t *error) {
     zip_t *za;
     zip_cdir_t *cdir;
+    bool from_index;
     struct zip_stat st;
     zip_uint64_t len, idx;
+    unsigned int nthreads;
 
     zip_stat_init(&st);
     if (zip_source_stat(src, &st) < 0) {
@@ -170,7 +275,13 @@ _zip_open(zip_source_t *src, unsigned int flags, zip_error_t *error) {
         return za;
     }
 
-    if ((cdir = _zip_find_central_dir(za, len)) == NULL) {
+    cdir = NULL;
+    if (index != NULL && (flags & (ZIP_RDONLY | ZIP_CHECKCONS)) == ZIP_RDONLY) {
+        cdir = _zip_index_read(za, &st, index);
+    }
+    from_index = (cdir != NULL);
+
+    if (cdir == NULL && (cdir = _zip_find_central_dir(za, len, false)) == NULL) {
         _zip_error_copy(error, &za->error);
         /* keep src so discard does not get rid of it */
         zip_source_keep(src);
@@ -182,13 +293,45 @@ _zip_open(zip_source_t *src, unsigned int flags, zip_error_t *error) {
     za->nentry = cdir->nentry;
     za->nentry_alloc = cdir->nentry_alloc;
     za->comment_orig = cdir->comment;
+    za->lazy_cdir = cdir->lazy;
+    za->cdir_offset = cdir->offset;
+    za->cdir_size = cdir->size;
+    za->cdir_crc = cdir->crc;
+    za->cdir_crc_valid = cdir->crc_valid;
 
     free(cdir);
 
-    _zip_hash_reserve_capacity(za->names, za->nentry, &za->error);
+    if (from_index) {
+        /* name hash is used from index */
+        idx = za->nentry;
+    }
+    else if ((flags & ZIP_PARALLEL) && za->lazy_cdir == NULL && (nthreads = _zip_parallel_threads(za->nentry, ZIP_PARALLEL_MIN_ENTRIES)) > 1) {
+        if (!_zip_add_names_parallel(za, nthreads, error)) {
+            /* keep src so discard does not get rid of it */
+            zip_source_keep(src);
+            zip_discard(za);
+            return NULL;
+        }
+        idx = za->nentry;
+    }
+    else {
+        _zip_hash_reserve_capacity(za->names, za->nentry, &za->error);
+        idx = 0;
+    }
+
+    for (; idx < za->nentry; idx++) {
+        const zip_uint8_t *name = NULL;
+        bool ok = true;
 
-    for (idx = 0; idx < za->nentry; idx++) {
-        const zip_uint8_t *name = _zip_string_get(za->entry[idx].orig->filename, NULL, 0, error);
+        if (za->lazy_cdir) {
+            ok = _zip_lazy_cdir_get_name(za->lazy_cdir, idx, &name, error);
+            if (ok && name == NULL) {
+                ok = _zip_lazy_cdir_read_entry(za->lazy_cdir, za->entry + idx, idx, error);
+            }
+        }
+        if (ok && name == NULL) {
+            name = _zip_string_get(za->entry[idx].orig->filename, NULL, 0, error);
+        }
         if (name == NULL) {
             /* keep src so discard does not get rid of it */
             zip_source_keep(src);
@@ -208,11 +351,45 @@ _zip_open(zip_source_t *src, unsigned int flags, zip_error_t *error) {
     }
 
     za->ch_flags = za->flags;
+    if (from_index) {
+        za->index_src = index;
+    }
 
     return za;
 }
 
 
+/* _zip_add_names_parallel:
+   adds names of all entries to name hash; hash values are computed
+   using nthreads threads, the table is filled by the calling thread. */
+
+static bool
+_zip_add_names_parallel(zip_t *za, unsigned int nthreads, zip_error_t *error) {
+    const zip_uint8_t **names;
+
+    if (za->nentry > SIZE_MAX / sizeof(*names) || (names = (const zip_uint8_t **)malloc(sizeof(*names) * (size_t)za->nentry)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    if (!_zip_get_names_parallel(za, names, nthreads, error)) {
+        free(names);
+        return false;
+    }
+
+    if (!_zip_hash_add_names(za->names, names, za->nentry, nthreads, &za->error)) {
+        if (za->error.zip_err != ZIP_ER_EXISTS || (za->open_flags & ZIP_CHECKCONS)) {
+            _zip_error_copy(error, &za->error);
+            free(names);
+            return false;
+        }
+    }
+
+    free(names);
+    return true;
+}
+
+
 void
 _zip_set_open_error(int *zep, const zip_error_t *err, int ze) {
     if (err) {
@@ -233,54 +410,86 @@ _zip_set_open_error(int *zep, const zip_error_t *err, int ze) {
 }
 
 
-/* _zip_readcdir:
-   tries to find a valid end-of-central-directory at the beginning of
-   buf, and then the corresponding central directory entries.
-   Returns a struct zip_cdir which contains the central directory
-   entries, or NULL if unsuccessful. */
+/* _zip_read_eocd_record:
+   tries to read a valid end-of-central-directory record (and
+   Zip64 end-of-central-directory record, if present) at the current
+   offset of buffer.
+   Returns false if unsuccessful. */
 
-static zip_cdir_t *
-_zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_error_t *error) {
-    zip_cdir_t *cd;
-    zip_uint16_t comment_len;
-    zip_uint64_t i, left;
+static bool
+_zip_read_eocd_record(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_eocd_t *eocd, zip_error_t *error) {
     zip_uint64_t eocd_offset = _zip_buffer_offset(buffer);
-    zip_buffer_t *cd_buffer;
+    bool ok;
 
     if (_zip_buffer_left(buffer) < EOCDLEN) {
         /* not enough bytes left for comment */
         zip_error_set(error, ZIP_ER_NOZIP, 0);
-        return NULL;
+        return false;
     }
 
     /* check for end-of-central-dir magic */
     if (memcmp(_zip_buffer_get(buffer, 4), EOCD_MAGIC, 4) != 0) {
         zip_error_set(error, ZIP_ER_NOZIP, 0);
-        return NULL;
+        return false;
     }
 
     if (eocd_offset >= EOCD64LOCLEN && memcmp(_zip_buffer_data(buffer) + eocd_offset - EOCD64LOCLEN, EOCD64LOC_MAGIC, 4) == 0) {
         _zip_buffer_set_offset(buffer, eocd_offset - EOCD64LOCLEN);
-        cd = _zip_read_eocd64(za->src, buffer, buf_offset, za->flags, error);
+        ok = _zip_read_eocd64(za->src, buffer, buf_offset, za->flags, eocd, error);
     }
     else {
         _zip_buffer_set_offset(buffer, eocd_offset);
-        cd = _zip_read_eocd(buffer, buf_offset, za->flags, error);
+        ok = _zip_read_eocd(buffer, buf_offset, za->flags, eocd, error);
     }
 
-    if (cd == NULL)
-        return NULL;
+    if (!ok)
+        return false;
 
     _zip_buffer_set_offset(buffer, eocd_offset + 20);
-    comment_len = _zip_buffer_get_16(buffer);
+    eocd->comment_length = _zip_buffer_get_16(buffer);
+    eocd->position = buf_offset + eocd_offset;
 
-    if (cd->offset + cd->size > buf_offset + eocd_offset) {
+    if (eocd->offset + eocd->size > eocd->position) {
         /* cdir spans past EOCD record */
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_OVERLAPS_EOCD);
-        _zip_cdir_free(cd);
-        return NULL;
+        return false;
+    }
+
+    if (_zip_buffer_size(buffer) - (eocd_offset + EOCDLEN) < eocd->comment_length) {
+        zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_COMMENT_LENGTH_INVALID);
+        return false;
     }
 
+    return true;
+}
+
+
+/* _zip_readcdir:
+   reads the central directory described by eocd, using buffer
+   (which has to contain the EOCD record and extend to the end of
+   the archive) if it already contains it.
+   If refresh is true, the central directory must start with the
+   one za was opened with; only the entries following it are read,
+   the others are left empty.
+   Returns a struct zip_cdir which contains the central directory
+   entries, or NULL if unsuccessful. */
+
+static zip_cdir_t *
+_zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, const zip_eocd_t *eocd, bool refresh, zip_error_t *error) {
+    zip_cdir_t *cd;
+    zip_uint16_t comment_len = eocd->comment_length;
+    zip_uint64_t i, left;
+    zip_uint64_t eocd_offset = eocd->position - buf_offset;
+    zip_buffer_t *cd_buffer;
+    const zip_uint8_t *cd_data;
+
+    if ((cd = _zip_cdir_new(eocd->nentry, error)) == NULL)
+        return NULL;
+
+    cd->is_zip64 = eocd->is_zip64;
+    cd->size = eocd->size;
+    cd->offset = eocd->offset;
+
     if (comment_len || (za->open_flags & ZIP_CHECKCONS)) {
         zip_uint64_t tail_len;
 
@@ -317,9 +526,15 @@ _zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_err
             return NULL;
         }
     }
+    else if (cd->size > 0 && (cd_data = _zip_source_get_data(za->src, cd->offset, cd->size, NULL)) != NULL) {
+        /* parse entries directly from memory provided by source (SIGBUS if mapped file is truncated meanwhile, see ZIP_MMAP); buffer is only read from */
+        if ((cd_buffer = _zip_buffer_new((zip_uint8_t *)cd_data, cd->size)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            _zip_cdir_free(cd);
+            return NULL;
+        }
+    }
     else {
-        cd_buffer = NULL;
-
         if (zip_source_seek(za->src, (zip_int64_t)cd->offset, SEEK_SET) < 0) {
             zip_error_set_from_source(error, za->src);
             _zip_cdir_free(cd);
@@ -332,10 +547,83 @@ _zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_err
             _zip_cdir_free(cd);
             return NULL;
         }
+
+        /* read central directory in one go and parse entries from memory */
+        if (cd->size == 0) {
+            cd_buffer = _zip_buffer_new(_zip_buffer_data(buffer), 0);
+        }
+        else {
+            cd_buffer = _zip_buffer_new_from_source(za->src, cd->size, NULL, error);
+        }
+        if (cd_buffer == NULL) {
+            if (cd->size == 0) {
+                zip_error_set(error, ZIP_ER_MEMORY, 0);
+            }
+            else if (zip_error_code_zip(error) == ZIP_ER_EOF) {
+                zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_LENGTH_INVALID);
+            }
+            _zip_cdir_free(cd);
+            return NULL;
+        }
+    }
+
+    if (refresh) {
+        /* entries already read must be unchanged */
+        if (cd->size < za->cdir_size || (za->cdir_crc_valid && _zip_cdir_crc(_zip_buffer_data(cd_buffer), za->cdir_size) != za->cdir_crc)) {
+            zip_error_set(error, ZIP_ER_CHANGED, 0);
+            _zip_cdir_free(cd);
+            _zip_buffer_free(cd_buffer);
+            return NULL;
+        }
+        if (!za->cdir_crc_valid && !_zip_read_cdir_unchanged(za, cd_buffer, error)) {
+            _zip_cdir_free(cd);
+            _zip_buffer_free(cd_buffer);
+            return NULL;
+        }
+        while (cd->nentry < za->nentry) {
+            /* InfoZIP hack, see below */
+            if (cd->is_zip64 || !_zip_cdir_grow(cd, 0x10000, error)) {
+                if (cd->is_zip64) {
+                    zip_error_set(error, ZIP_ER_CHANGED, 0);
+                }
+                _zip_cdir_free(cd);
+                _zip_buffer_free(cd_buffer);
+                return NULL;
+            }
+        }
+        /* allows the next zip_refresh to check that these entries are unchanged without parsing them */
+        cd->crc = _zip_cdir_crc(_zip_buffer_data(cd_buffer), cd->size);
+        cd->crc_valid = true;
+    }
+
+    if ((za->open_flags & (ZIP_LAZY | ZIP_RDONLY | ZIP_CHECKCONS)) == (ZIP_LAZY | ZIP_RDONLY) && !refresh) {
+        /* keep raw entries, parse them on first access */
+        if ((cd->lazy = _zip_lazy_cdir_new(_zip_buffer_data(cd_buffer), cd->size, &za->arena, error)) == NULL) {
+            _zip_cdir_free(cd);
+            _zip_buffer_free(cd_buffer);
+            return NULL;
+        }
+        _zip_buffer_free(cd_buffer);
+        if ((cd_buffer = _zip_buffer_new(cd->lazy->data, cd->size)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            _zip_cdir_free(cd);
+            return NULL;
+        }
     }
 
     left = (zip_uint64_t)cd->size;
     i = 0;
+    if (refresh) {
+        _zip_buffer_set_offset(cd_buffer, za->cdir_size);
+        left -= za->cdir_size;
+        i = za->nentry;
+    }
+    else if (cd->lazy == NULL && (za->open_flags & ZIP_PARALLEL) && _zip_cdir_read_parallel(cd, _zip_buffer_data(cd_buffer), &za->arena)) {
+        /* all entries already parsed */
+        _zip_buffer_set_offset(cd_buffer, cd->size);
+        left = 0;
+        i = cd->nentry;
+    }
     while (left > 0) {
         bool grown = false;
         zip_int64_t entry_size;
@@ -356,7 +644,17 @@ _zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_err
             grown = true;
         }
 
-        if ((cd->entry[i].orig = _zip_dirent_new()) == NULL || (entry_size = _zip_dirent_read(cd->entry[i].orig, za->src, cd_buffer, false, error)) < 0) {
+        if (cd->lazy) {
+            entry_size = _zip_lazy_cdir_add_entry(cd->lazy, cd_buffer, error);
+        }
+        else if ((cd->entry[i].orig = _zip_dirent_new(&za->arena)) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            entry_size = -1;
+        }
+        else {
+            entry_size = _zip_dirent_read(cd->entry[i].orig, za->src, cd_buffer, false, &za->arena, error);
+        }
+        if (entry_size < 0) {
 	    if (zip_error_code_zip(error) == ZIP_ER_INCONS) {
 		zip_error_set(error, ZIP_ER_INCONS, ADD_INDEX_TO_DETAIL(zip_error_code_system(error), i));
 	    }
@@ -379,23 +677,7 @@ _zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_err
     }
 
     if (za->open_flags & ZIP_CHECKCONS) {
-        bool ok;
-
-        if (cd_buffer) {
-            ok = _zip_buffer_eof(cd_buffer);
-        }
-        else {
-            zip_int64_t offset = zip_source_tell(za->src);
-
-            if (offset < 0) {
-                zip_error_set_from_source(error, za->src);
-                _zip_cdir_free(cd);
-                return NULL;
-            }
-            ok = ((zip_uint64_t)offset == cd->offset + cd->size);
-        }
-
-        if (!ok) {
+        if (!_zip_buffer_eof(cd_buffer)) {
             zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_LENGTH_INVALID);
             _zip_buffer_free(cd_buffer);
             _zip_cdir_free(cd);
@@ -408,27 +690,82 @@ _zip_read_cdir(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_err
 }
 
 
+/* _zip_read_cdir_unchanged:
+   Checks that the entries at the start of the central directory in
+   cd_buffer are the ones already read, for zip_refresh on an archive
+   whose central directory CRC-32 was not computed.
+   Returns false and sets error to ZIP_ER_CHANGED if they differ. */
+
+static bool
+_zip_read_cdir_unchanged(zip_t *za, zip_buffer_t *cd_buffer, zip_error_t *error) {
+    zip_dirent_t de;
+    zip_error_t parse_error;
+    zip_uint64_t i;
+    bool unchanged;
+
+    unchanged = true;
+    zip_error_init(&parse_error);
+    for (i = 0; i < za->nentry && unchanged; i++) {
+        const zip_dirent_t *orig = za->entry[i].orig;
+
+        _zip_dirent_init(&de);
+        if (orig == NULL || _zip_dirent_read(&de, za->src, cd_buffer, false, NULL, &parse_error) < 0) {
+            unchanged = false;
+        }
+        else {
+            unchanged = de.version_needed == orig->version_needed && de.bitflags == orig->bitflags && de.comp_method == orig->comp_method && de.dos_time == orig->dos_time && de.dos_date == orig->dos_date && de.crc == orig->crc && de.comp_size == orig->comp_size && de.uncomp_size == orig->uncomp_size && de.disk_number == orig->disk_number && de.offset == orig->offset && de.ext_attrib == orig->ext_attrib && _zip_string_equal(de.filename, orig->filename) && _zip_string_equal(de.comment, orig->comment);
+        }
+        _zip_dirent_finalize(&de);
+    }
+    zip_error_fini(&parse_error);
+
+    if (!unchanged || _zip_buffer_offset(cd_buffer) != za->cdir_size) {
+        zip_error_set(error, ZIP_ER_CHANGED, 0);
+        return false;
+    }
+
+    return true;
+}
+
+
 /* _zip_checkcons:
    Checks the consistency of the central directory by comparing central
    directory entries with local headers and checking for plausible
    file and header offsets. Returns -1 if not plausible, else the
-   difference between the lowest and the highest fileposition reached */
+   difference between the lowest and the highest fileposition reached.
+   Only entries from first on are checked (the others were checked
+   before zip_refresh).
+
+   Local headers are checked in order of their offset, reading headers
+   that are close together with one read of up to CHECKCONS_BUFSIZE
+   bytes.  With ZIP_PARALLEL, headers of one read are checked using
+   several threads. */
 
 static zip_int64_t
-_zip_checkcons(zip_t *za, zip_cdir_t *cd, zip_error_t *error) {
-    zip_uint64_t i;
+_zip_checkcons(zip_t *za, zip_cdir_t *cd, zip_uint64_t first, zip_error_t *error) {
+    zip_uint64_t i, nchecked;
     zip_uint64_t min, max, j;
-    struct zip_dirent temp;
+    zip_checkcons_t cc;
+    zip_uint64_t pos, data_alloc;
+    unsigned int t;
+    bool ok;
+
+    if (cd->lazy) {
+        for (i = first; i < cd->nentry; i++) {
+            if (!_zip_lazy_cdir_read_entry(cd->lazy, cd->entry + i, i, error)) {
+                return -1;
+            }
+        }
+    }
 
-    _zip_dirent_init(&temp);
-    if (cd->nentry) {
-        max = cd->entry[0].orig->offset;
-        min = cd->entry[0].orig->offset;
+    if (cd->nentry > first) {
+        max = cd->entry[first].orig->offset;
+        min = cd->entry[first].orig->offset;
     }
     else
         min = max = 0;
 
-    for (i = 0; i < cd->nentry; i++) {
+    for (i = first; i < cd->nentry; i++) {
         if (cd->entry[i].orig->offset < min)
             min = cd->entry[i].orig->offset;
         if (min > (zip_uint64_t)cd->offset) {
@@ -443,37 +780,235 @@ _zip_checkcons(zip_t *za, zip_cdir_t *cd, zip_error_t *error) {
             zip_error_set(error, ZIP_ER_NOZIP, 0);
             return -1;
         }
+    }
+
+    if (cd->nentry <= first) {
+        return (zip_int64_t)(max - min);
+    }
+    nchecked = cd->nentry - first;
 
-        if (zip_source_seek(za->src, (zip_int64_t)cd->entry[i].orig->offset, SEEK_SET) < 0) {
+    if (nchecked > SIZE_MAX / sizeof(*cc.entries) || (cc.entries = (zip_checkcons_entry_t *)malloc(sizeof(*cc.entries) * (size_t)nchecked)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+    for (i = 0; i < nchecked; i++) {
+        cc.entries[i].offset = cd->entry[first + i].orig->offset;
+        cc.entries[i].index = first + i;
+    }
+    qsort(cc.entries, (size_t)nchecked, sizeof(*cc.entries), _zip_checkcons_compare);
+
+    cc.cd = cd;
+    cc.data = NULL;
+    data_alloc = 0;
+    ok = true;
+
+    for (pos = 0; ok && pos < nchecked; pos = cc.end) {
+        zip_uint64_t need, limit, failed;
+        zip_int64_t n;
+
+        /* collect headers that fit into one read */
+        cc.start = pos;
+        cc.data_offset = cc.entries[pos].offset;
+        limit = cc.data_offset + CHECKCONS_BUFSIZE;
+        need = cc.data_offset + _zip_checkcons_header_size(cd, cc.entries + pos);
+        for (cc.end = pos + 1; cc.end < nchecked; cc.end++) {
+            j = cc.entries[cc.end].offset + _zip_checkcons_header_size(cd, cc.entries + cc.end);
+            if (j > limit) {
+                break;
+            }
+            if (j > need) {
+                need = j;
+            }
+        }
+        if (need > limit) {
+            need = limit;
+        }
+
+        if (need - cc.data_offset > data_alloc) {
+            zip_uint8_t *data;
+
+            if ((data = (zip_uint8_t *)realloc(cc.data, (size_t)(need - cc.data_offset))) == NULL) {
+                zip_error_set(error, ZIP_ER_MEMORY, 0);
+                ok = false;
+                break;
+            }
+            cc.data = data;
+            data_alloc = need - cc.data_offset;
+        }
+
+        if (zip_source_seek(za->src, (zip_int64_t)cc.data_offset, SEEK_SET) < 0 || (n = zip_source_read(za->src, cc.data, need - cc.data_offset)) < 0) {
             zip_error_set_from_source(error, za->src);
-            return -1;
+            ok = false;
+            break;
         }
+        cc.data_length = (zip_uint64_t)n;
 
-        if (_zip_dirent_read(&temp, za->src, NULL, true, error) == -1) {
-	    if (zip_error_code_zip(error) == ZIP_ER_INCONS) {
-		zip_error_set(error, ZIP_ER_INCONS, ADD_INDEX_TO_DETAIL(zip_error_code_system(error), i));
-	    }
-            _zip_dirent_finalize(&temp);
-            return -1;
+        cc.nthreads = 1;
+        if (za->open_flags & ZIP_PARALLEL) {
+            cc.nthreads = _zip_parallel_threads(cc.end - cc.start, CHECKCONS_PARALLEL_MIN_ENTRIES);
+        }
+        for (t = 0; t < cc.nthreads; t++) {
+            cc.failed[t] = cc.end;
+            zip_error_init(&cc.error[t]);
         }
 
-        if (_zip_headercomp(cd->entry[i].orig, &temp) != 0) {
-            zip_error_set(error, ZIP_ER_INCONS, MAKE_DETAIL_WITH_INDEX(ZIP_ER_DETAIL_ENTRY_HEADER_MISMATCH, i));
-            _zip_dirent_finalize(&temp);
-            return -1;
+        _zip_parallel_run(cc.nthreads, _zip_checkcons_batch, &cc);
+
+        failed = cc.end;
+        for (t = 0; t < cc.nthreads; t++) {
+            if (cc.failed[t] < failed) {
+                failed = cc.failed[t];
+                _zip_error_copy(error, &cc.error[t]);
+            }
+            zip_error_fini(&cc.error[t]);
         }
 
-        cd->entry[i].orig->extra_fields = _zip_ef_merge(cd->entry[i].orig->extra_fields, temp.extra_fields);
-        cd->entry[i].orig->local_extra_fields_read = 1;
-        temp.extra_fields = NULL;
+        /* headers not completely read are read separately */
+        for (j = cc.start; j < failed; j++) {
+            if (_zip_checkcons_in_data(&cc, cc.entries + j) == NULL) {
+                if (zip_source_seek(za->src, (zip_int64_t)cc.entries[j].offset, SEEK_SET) < 0) {
+                    zip_error_set_from_source(error, za->src);
+                    failed = j;
+                    break;
+                }
+                if (!_zip_checkcons_entry(cd, cc.entries[j].index, za->src, NULL, error)) {
+                    failed = j;
+                    break;
+                }
+            }
+        }
 
-        _zip_dirent_finalize(&temp);
+        if (failed < cc.end) {
+            ok = false;
+        }
+    }
+
+    free(cc.data);
+    free(cc.entries);
+
+    if (!ok) {
+        return -1;
     }
 
     return (max - min) < ZIP_INT64_MAX ? (zip_int64_t)(max - min) : ZIP_INT64_MAX;
 }
 
 
+/* Check local header of entry index against its central directory entry,
+   reading it from buffer if given, otherwise from current position of src. */
+
+static bool
+_zip_checkcons_entry(zip_cdir_t *cd, zip_uint64_t index, zip_source_t *src, zip_buffer_t *buffer, zip_error_t *error) {
+    struct zip_dirent temp;
+
+    _zip_dirent_init(&temp);
+
+    if (_zip_dirent_read(&temp, src, buffer, true, NULL, error) == -1) {
+        if (zip_error_code_zip(error) == ZIP_ER_INCONS) {
+            zip_error_set(error, ZIP_ER_INCONS, ADD_INDEX_TO_DETAIL(zip_error_code_system(error), index));
+        }
+        _zip_dirent_finalize(&temp);
+        return false;
+    }
+
+    if (_zip_headercomp(cd->entry[index].orig, &temp) != 0) {
+        zip_error_set(error, ZIP_ER_INCONS, MAKE_DETAIL_WITH_INDEX(ZIP_ER_DETAIL_ENTRY_HEADER_MISMATCH, index));
+        _zip_dirent_finalize(&temp);
+        return false;
+    }
+
+    cd->entry[index].orig->extra_fields = _zip_ef_merge(cd->entry[index].orig->extra_fields, temp.extra_fields);
+    cd->entry[index].orig->local_extra_fields_read = 1;
+    temp.extra_fields = NULL;
+
+    _zip_dirent_finalize(&temp);
+
+    return true;
+}
+
+
+/* Check the local headers of thread's share of the current batch that were read completely. */
+
+static void
+_zip_checkcons_batch(void *ud, unsigned int thread) {
+    zip_checkcons_t *cc = (zip_checkcons_t *)ud;
+    zip_uint64_t n = cc->end - cc->start;
+    zip_uint64_t start = cc->start + n * thread / cc->nthreads;
+    zip_uint64_t end = cc->start + n * (thread + 1) / cc->nthreads;
+    zip_uint64_t pos;
+
+    for (pos = start; pos < end; pos++) {
+        const zip_uint8_t *header;
+        zip_buffer_t *buffer;
+        bool ok;
+
+        if ((header = _zip_checkcons_in_data(cc, cc->entries + pos)) == NULL) {
+            continue;
+        }
+
+        if ((buffer = _zip_buffer_new((zip_uint8_t *)header, cc->data_offset + cc->data_length - cc->entries[pos].offset)) == NULL) {
+            zip_error_set(&cc->error[thread], ZIP_ER_MEMORY, 0);
+            ok = false;
+        }
+        else {
+            ok = _zip_checkcons_entry(cc->cd, cc->entries[pos].index, NULL, buffer, &cc->error[thread]);
+            _zip_buffer_free(buffer);
+        }
+        if (!ok) {
+            cc->failed[thread] = pos;
+            return;
+        }
+    }
+}
+
+
+static int
+_zip_checkcons_compare(const void *a, const void *b) {
+    const zip_checkcons_entry_t *ea = (const zip_checkcons_entry_t *)a;
+    const zip_checkcons_entry_t *eb = (const zip_checkcons_entry_t *)b;
+
+    if (ea->offset != eb->offset) {
+        return ea->offset < eb->offset ? -1 : 1;
+    }
+    if (ea->index != eb->index) {
+        return ea->index < eb->index ? -1 : 1;
+    }
+    return 0;
+}
+
+
+/* Expected size of local header of entry, assuming extra fields are not much larger than in the central directory. */
+
+static zip_uint64_t
+_zip_checkcons_header_size(const zip_cdir_t *cd, const zip_checkcons_entry_t *entry) {
+    const zip_dirent_t *de = cd->entry[entry->index].orig;
+
+    return LENTRYSIZE + _zip_string_length(de->filename) + _zip_ef_size(de->extra_fields, ZIP_EF_BOTH) + CHECKCONS_HEADER_SLACK;
+}
+
+
+/* Return start of local header of entry if it has been read completely, NULL otherwise. */
+
+static const zip_uint8_t *
+_zip_checkcons_in_data(const zip_checkcons_t *cc, const zip_checkcons_entry_t *entry) {
+    const zip_uint8_t *header;
+    zip_uint64_t left;
+
+    if (entry->offset < cc->data_offset || entry->offset - cc->data_offset > cc->data_length || cc->data_offset + cc->data_length - entry->offset < LENTRYSIZE) {
+        return NULL;
+    }
+    header = cc->data + (entry->offset - cc->data_offset);
+    left = cc->data_offset + cc->data_length - entry->offset;
+
+    /* file name and extra field lengths */
+    if (LENTRYSIZE + (zip_uint64_t)(header[26] | (header[27] << 8)) + (zip_uint64_t)(header[28] | (header[29] << 8)) > left) {
+        return NULL;
+    }
+
+    return header;
+}
+
+
 /* _zip_headercomp:
    compares a central directory entry and a local file header
    Return 0 if they are consistent, -1 if not. */
@@ -486,7 +1021,7 @@ _zip_headercomp(const zip_dirent_t *central, const zip_dirent_t *local) {
 	   and global headers for the bitflags */
 	|| (central->bitflags != local->bitflags)
 #endif
-        || (central->comp_method != local->comp_method) || (central->last_mod != local->last_mod) || !_zip_string_equal(central->filename, local->filename))
+        || (central->comp_method != local->comp_method) || (central->dos_time != local->dos_time) || (central->dos_date != local->dos_date) || !_zip_string_equal(central->filename, local->filename))
         return -1;
 
     if ((central->crc != local->crc) || (central->comp_size != local->comp_size) || (central->uncomp_size != local->uncomp_size)) {
@@ -550,95 +1085,221 @@ _zip_file_exists(zip_source_t *src, zip_error_t *error) {
 }
 
 
-static zip_cdir_t *
-_zip_find_central_dir(zip_t *za, zip_uint64_t len) {
-    zip_cdir_t *cdir, *cdirnew;
-    const zip_uint8_t *match;
-    zip_int64_t buf_offset;
-    zip_uint64_t buflen;
-    zip_int64_t a;
-    zip_int64_t best;
+/* _zip_find_central_dir:
+   Searches the end of the archive for end-of-central-directory
+   records, reading it in increasing steps until a record matching
+   the end of the archive is found.  Candidates are ranked using only
+   the fields of their EOCD records, and the central directories of
+   at most EOCD_MAX_ATTEMPTS of them are read, best first.
+   See _zip_read_cdir for refresh. */
+
+zip_cdir_t *
+_zip_find_central_dir(zip_t *za, zip_uint64_t len, bool refresh) {
+    zip_cdir_t *cdir;
+    zip_eocd_t *candidates, *tmp;
+    zip_uint64_t ncandidates, candidates_alloc, i;
+    zip_uint8_t *data;
+    const zip_uint8_t *tail, *match;
+    zip_uint64_t maxlen, buflen, newlen, buf_offset, scan_start, scan_end, error_position;
     zip_error_t error;
     zip_buffer_t *buffer;
+    bool ok;
+    int best;
 
     if (len < EOCDLEN) {
         zip_error_set(&za->error, ZIP_ER_NOZIP, 0);
         return NULL;
     }
 
-    buflen = (len < CDBUFSIZE ? len : CDBUFSIZE);
-    if (zip_source_seek(za->src, -(zip_int64_t)buflen, SEEK_END) < 0) {
-        zip_error_t *src_error = zip_source_error(za->src);
-        if (zip_error_code_zip(src_error) != ZIP_ER_SEEK || zip_error_code_system(src_error) != EFBIG) {
-            /* seek before start of file on my machine */
-            _zip_error_copy(&za->error, src_error);
-            return NULL;
-        }
-    }
-    if ((buf_offset = zip_source_tell(za->src)) < 0) {
-        zip_error_set_from_source(&za->error, za->src);
-        return NULL;
+    maxlen = (len < CDBUFSIZE ? len : CDBUFSIZE);
+    /* if the source provides its data in memory, search it there instead of reading it;
+       if a mapped file is truncated meanwhile, this raises SIGBUS, as would copying from the mapping */
+    if ((tail = _zip_source_get_data(za->src, len - maxlen, maxlen, NULL)) != NULL) {
+        data = NULL;
     }
-
-    if ((buffer = _zip_buffer_new_from_source(za->src, buflen, NULL, &za->error)) == NULL) {
+    else if ((data = (zip_uint8_t *)malloc(maxlen)) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
         return NULL;
     }
 
+    candidates = NULL;
+    ncandidates = candidates_alloc = 0;
+    buffer = NULL;
+    buflen = 0;
+    buf_offset = len;
     best = -1;
-    cdir = NULL;
-    if (buflen >= CDBUFSIZE) {
-        /* EOCD64 locator is before EOCD, so leave place for it */
-        _zip_buffer_set_offset(buffer, EOCD64LOCLEN);
-    }
+    ok = true;
+    error_position = 0;
     zip_error_set(&error, ZIP_ER_NOZIP, 0);
 
-    match = _zip_buffer_get(buffer, 0);
-    /* The size of buffer never greater than CDBUFSIZE. */
-    while (_zip_buffer_left(buffer) >= EOCDLEN && (match = _zip_memmem(match, (size_t)_zip_buffer_left(buffer) - (EOCDLEN - 4), (const unsigned char *)EOCD_MAGIC, 4)) != NULL) {
-        _zip_buffer_set_offset(buffer, (zip_uint64_t)(match - _zip_buffer_data(buffer)));
-        if ((cdirnew = _zip_read_cdir(za, buffer, (zip_uint64_t)buf_offset, &error)) != NULL) {
-            if (cdir) {
-                if (best <= 0) {
-                    best = _zip_checkcons(za, cdir, &error);
-                }
+    /* records can start no later than EOCDLEN bytes before end of archive */
+    scan_end = len - EOCDLEN + 1;
+
+    while (ok && buflen < maxlen && best < EOCD_SCORE_BEST) {
+        newlen = (buflen == 0 ? EOCD_TAIL_SIZE : buflen * 2);
+        if (newlen > maxlen) {
+            newlen = maxlen;
+        }
 
-                a = _zip_checkcons(za, cdirnew, &error);
-                if (best < a) {
-                    _zip_cdir_free(cdir);
-                    cdir = cdirnew;
-                    best = a;
+        if (tail == NULL) {
+            /* read the part of the tail not read yet in front of what we have */
+            if (zip_source_seek(za->src, (zip_int64_t)(len - newlen), SEEK_SET) < 0) {
+                zip_error_set_from_source(&za->error, za->src);
+                ok = false;
+                break;
+            }
+            if (_zip_read(za->src, data + maxlen - newlen, newlen - buflen, &za->error) < 0) {
+                ok = false;
+                break;
+            }
+        }
+        buflen = newlen;
+        buf_offset = len - buflen;
+
+        _zip_buffer_free(buffer);
+        /* buffer is only read from */
+        if ((buffer = _zip_buffer_new((tail != NULL ? (zip_uint8_t *)tail : data) + maxlen - buflen, buflen)) == NULL) {
+            zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+            ok = false;
+            break;
+        }
+
+        /* EOCD64 locator is before EOCD, so leave place for it unless we are at the beginning of the archive */
+        scan_start = (buf_offset == 0 ? 0 : buf_offset + EOCD64LOCLEN);
+        if (scan_start >= scan_end) {
+            continue;
+        }
+
+        match = _zip_buffer_data(buffer) + (scan_start - buf_offset);
+        while ((match = _zip_memmem(match, (size_t)(scan_end - buf_offset - (zip_uint64_t)(match - _zip_buffer_data(buffer))) + 3, (const unsigned char *)EOCD_MAGIC, 4)) != NULL) {
+            zip_eocd_t eocd;
+            zip_error_t candidate_error;
+
+            zip_error_init(&candidate_error);
+            _zip_buffer_set_offset(buffer, (zip_uint64_t)(match - _zip_buffer_data(buffer)));
+            if (_zip_read_eocd_record(za, buffer, buf_offset, &eocd, &candidate_error)) {
+                if (ncandidates == candidates_alloc) {
+                    zip_uint64_t new_alloc = (candidates_alloc == 0 ? 8 : candidates_alloc * 2);
+
+                    if ((tmp = (zip_eocd_t *)realloc(candidates, sizeof(*candidates) * new_alloc)) == NULL) {
+                        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+                        zip_error_fini(&candidate_error);
+                        ok = false;
+                        break;
+                    }
+                    candidates = tmp;
+                    candidates_alloc = new_alloc;
                 }
-                else {
-                    _zip_cdir_free(cdirnew);
+                eocd.score = _zip_eocd_score(za, buffer, buf_offset, len, &eocd);
+                if (eocd.score > best) {
+                    best = eocd.score;
                 }
+                candidates[ncandidates++] = eocd;
             }
-            else {
-                cdir = cdirnew;
-                if (za->open_flags & ZIP_CHECKCONS)
-                    best = _zip_checkcons(za, cdir, &error);
-                else {
-                    best = 0;
-                }
+            else if (buf_offset + (zip_uint64_t)(match - _zip_buffer_data(buffer)) >= error_position) {
+                /* report error of last record in archive if none is usable */
+                error_position = buf_offset + (zip_uint64_t)(match - _zip_buffer_data(buffer));
+                _zip_error_copy(&error, &candidate_error);
             }
-            cdirnew = NULL;
+            zip_error_fini(&candidate_error);
+            match++;
         }
+        scan_end = scan_start;
+    }
 
-        match++;
-        _zip_buffer_set_offset(buffer, (zip_uint64_t)(match - _zip_buffer_data(buffer)));
+    if (!ok) {
+        _zip_buffer_free(buffer);
+        free(candidates);
+        free(data);
+        return NULL;
+    }
+
+    if (ncandidates > 1) {
+        qsort(candidates, (size_t)ncandidates, sizeof(*candidates), _zip_eocd_compare);
+    }
+
+    cdir = NULL;
+    for (i = 0; i < ncandidates && i < EOCD_MAX_ATTEMPTS; i++) {
+        if ((cdir = _zip_read_cdir(za, buffer, buf_offset, candidates + i, refresh, &error)) != NULL) {
+            /* on refresh, entries already read were checked when they were read */
+            if ((za->open_flags & ZIP_CHECKCONS) == 0 || _zip_checkcons(za, cdir, refresh ? za->nentry : 0, &error) >= 0) {
+                break;
+            }
+            _zip_cdir_free(cdir);
+            cdir = NULL;
+        }
     }
 
     _zip_buffer_free(buffer);
+    free(candidates);
+    free(data);
 
-    if (best < 0) {
+    if (cdir == NULL) {
         _zip_error_copy(&za->error, &error);
-        _zip_cdir_free(cdir);
-        return NULL;
     }
 
     return cdir;
 }
 
 
+/* _zip_eocd_score:
+   Rates how plausible eocd is using only fields of the EOCD records:
+   the central directory should end where the (Zip64) EOCD starts, the
+   comment should extend to the end of the archive, and there should be
+   a central directory entry at the start of the central directory.
+   Returns a score between 0 and EOCD_SCORE_BEST. */
+
+static int
+_zip_eocd_score(zip_t *za, zip_buffer_t *buffer, zip_uint64_t buf_offset, zip_uint64_t len, const zip_eocd_t *eocd) {
+    zip_uint8_t magic[4];
+    int score = 0;
+
+    if (eocd->offset + eocd->size == eocd->cdir_end) {
+        score += 4;
+    }
+    if (eocd->position + EOCDLEN + eocd->comment_length == len) {
+        score += 2;
+    }
+
+    if (eocd->nentry == 0) {
+        if (eocd->size == 0) {
+            score += 1;
+        }
+    }
+    else if (eocd->size >= CDENTRYSIZE) {
+        if (eocd->offset >= buf_offset) {
+            if (memcmp(_zip_buffer_data(buffer) + (eocd->offset - buf_offset), CENTRAL_MAGIC, 4) == 0) {
+                score += 1;
+            }
+        }
+        else if (zip_source_seek(za->src, (zip_int64_t)eocd->offset, SEEK_SET) == 0 && zip_source_read(za->src, magic, 4) == 4 && memcmp(magic, CENTRAL_MAGIC, 4) == 0) {
+            score += 1;
+        }
+    }
+
+    return score;
+}
+
+
+/* _zip_eocd_compare:
+   Sorts EOCD candidates by descending score, candidates closer to the
+   end of the archive first. */
+
+static int
+_zip_eocd_compare(const void *a, const void *b) {
+    const zip_eocd_t *ea = (const zip_eocd_t *)a;
+    const zip_eocd_t *eb = (const zip_eocd_t *)b;
+
+    if (ea->score != eb->score) {
+        return eb->score - ea->score;
+    }
+    if (ea->position != eb->position) {
+        return ea->position < eb->position ? 1 : -1;
+    }
+    return 0;
+}
+
+
 static const unsigned char *_zip_memmem(const unsigned char *big, size_t biglen, const unsigned char *little, size_t littlelen) {
     const unsigned char *p;
 
@@ -664,14 +1325,13 @@ static const unsigned char *_zip_memmem(const unsigned char *big, size_t biglen,
 }
 
 
-static zip_cdir_t *
-_zip_read_eocd(zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_error_t *error) {
-    zip_cdir_t *cd;
+static bool
+_zip_read_eocd(zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_eocd_t *eocd, zip_error_t *error) {
     zip_uint64_t i, nentry, size, offset, eocd_offset;
 
     if (_zip_buffer_left(buffer) < EOCDLEN) {
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_EOCD_LENGTH_INVALID);
-        return NULL;
+        return false;
     }
 
     eocd_offset = _zip_buffer_offset(buffer);
@@ -680,7 +1340,7 @@ _zip_read_eocd(zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags
 
     if (_zip_buffer_get_32(buffer) != 0) {
         zip_error_set(error, ZIP_ER_MULTIDISK, 0);
-        return NULL;
+        return false;
     }
 
     /* number of cdir-entries on this disk */
@@ -690,7 +1350,7 @@ _zip_read_eocd(zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags
 
     if (nentry != i) {
         zip_error_set(error, ZIP_ER_NOZIP, 0);
-        return NULL;
+        return false;
     }
 
     size = _zip_buffer_get_32(buffer);
@@ -698,36 +1358,34 @@ _zip_read_eocd(zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags
 
     if (offset + size < offset) {
         zip_error_set(error, ZIP_ER_SEEK, EFBIG);
-        return NULL;
+        return false;
     }
 
     if (offset + size > buf_offset + eocd_offset) {
         /* cdir spans past EOCD record */
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_OVERLAPS_EOCD);
-        return NULL;
+        return false;
     }
 
     if ((flags & ZIP_CHECKCONS) && offset + size != buf_offset + eocd_offset) {
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_LENGTH_INVALID);
-        return NULL;
+        return false;
     }
 
-    if ((cd = _zip_cdir_new(nentry, error)) == NULL)
-        return NULL;
-
-    cd->is_zip64 = false;
-    cd->size = size;
-    cd->offset = offset;
+    eocd->is_zip64 = false;
+    eocd->cdir_end = buf_offset + eocd_offset;
+    eocd->nentry = nentry;
+    eocd->size = size;
+    eocd->offset = offset;
 
-    return cd;
+    return true;
 }
 
 
-static zip_cdir_t *
-_zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_error_t *error) {
-    zip_cdir_t *cd;
+static bool
+_zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offset, unsigned int flags, zip_eocd_t *eocd, zip_error_t *error) {
     zip_uint64_t offset;
-    zip_uint8_t eocd[EOCD64LEN];
+    zip_uint8_t data[EOCD64LEN];
     zip_uint64_t eocd_offset;
     zip_uint64_t size, nentry, i, eocdloc_offset;
     bool free_buffer;
@@ -744,13 +1402,13 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
     /* valid seek value for start of EOCD */
     if (eocd_offset > ZIP_INT64_MAX) {
         zip_error_set(error, ZIP_ER_SEEK, EFBIG);
-        return NULL;
+        return false;
     }
 
     /* does EOCD fit before EOCD locator? */
     if (eocd_offset + EOCD64LEN > eocdloc_offset + buf_offset) {
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_EOCD64_OVERLAPS_EOCD);
-        return NULL;
+        return false;
     }
 
     /* make sure current position of buffer is beginning of EOCD */
@@ -761,10 +1419,10 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
     else {
         if (zip_source_seek(src, (zip_int64_t)eocd_offset, SEEK_SET) < 0) {
             zip_error_set_from_source(error, src);
-            return NULL;
+            return false;
         }
-        if ((buffer = _zip_buffer_new_from_source(src, EOCD64LEN, eocd, error)) == NULL) {
-            return NULL;
+        if ((buffer = _zip_buffer_new_from_source(src, EOCD64LEN, data, error)) == NULL) {
+            return false;
         }
         free_buffer = true;
     }
@@ -774,7 +1432,7 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
         if (free_buffer) {
             _zip_buffer_free(buffer);
         }
-        return NULL;
+        return false;
     }
 
     /* size of EOCD */
@@ -786,7 +1444,7 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
         if (free_buffer) {
             _zip_buffer_free(buffer);
         }
-        return NULL;
+        return false;
     }
 
     _zip_buffer_get(buffer, 4); /* skip version made by/needed */
@@ -808,14 +1466,14 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
         if (free_buffer) {
             _zip_buffer_free(buffer);
         }
-        return NULL;
+        return false;
     }
     if (num_disks != 0 || eocd_disk != 0) {
         zip_error_set(error, ZIP_ER_MULTIDISK, 0);
         if (free_buffer) {
             _zip_buffer_free(buffer);
         }
-        return NULL;
+        return false;
     }
 
     nentry = _zip_buffer_get_64(buffer);
@@ -826,7 +1484,7 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
         if (free_buffer) {
             _zip_buffer_free(buffer);
         }
-        return NULL;
+        return false;
     }
 
     size = _zip_buffer_get_64(buffer);
@@ -838,7 +1496,7 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
         if (free_buffer) {
             _zip_buffer_free(buffer);
         }
-        return NULL;
+        return false;
     }
 
     if (free_buffer) {
@@ -847,29 +1505,28 @@ _zip_read_eocd64(zip_source_t *src, zip_buffer_t *buffer, zip_uint64_t buf_offse
 
     if (offset > ZIP_INT64_MAX || offset + size < offset) {
         zip_error_set(error, ZIP_ER_SEEK, EFBIG);
-        return NULL;
+        return false;
     }
     if (offset + size > buf_offset + eocd_offset) {
         /* cdir spans past EOCD record */
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_OVERLAPS_EOCD);
-        return NULL;
+        return false;
     }
     if ((flags & ZIP_CHECKCONS) && offset + size != buf_offset + eocd_offset) {
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_OVERLAPS_EOCD);
-        return NULL;
+        return false;
     }
 
     if (nentry > size / CDENTRYSIZE) {
         zip_error_set(error, ZIP_ER_INCONS, ZIP_ER_DETAIL_CDIR_INVALID);
-        return NULL;
+        return false;
     }
 
-    if ((cd = _zip_cdir_new(nentry, error)) == NULL)
-        return NULL;
+    eocd->is_zip64 = true;
+    eocd->cdir_end = eocd_offset;
+    eocd->nentry = nentry;
+    eocd->size = size;
+    eocd->offset = offset;
 
-    cd->is_zip64 = true;
-    cd->size = size;
-    cd->offset = offset;
-
-    return cd;
+    return true;
 }
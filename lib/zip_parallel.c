@@ -0,0 +1,396 @@
+/*
+  zip_parallel.c -- parallel parsing of large central directories
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "zipint.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+typedef struct {
+    zip_arena_t arena;
+    zip_error_t error;
+    bool ok;
+} cdir_chunk_t;
+
+typedef struct {
+    zip_entry_t *entry;
+    zip_uint8_t *data;
+    const zip_uint64_t *offset;
+    zip_uint64_t nentry;
+    unsigned int nchunks;
+    cdir_chunk_t *chunk;
+} cdir_parallel_t;
+
+typedef struct {
+    zip_entry_t *entry;
+    const zip_uint8_t **names;
+    zip_uint64_t nentry;
+    unsigned int nchunks;
+    zip_error_t *error;
+    bool *ok;
+} names_parallel_t;
+
+#ifdef HAVE_PTHREAD
+typedef struct {
+    zip_parallel_function_t function;
+    void *ud;
+    unsigned int index;
+} thread_t;
+
+static void *thread_main(void *ud);
+#endif
+
+static zip_uint64_t *cdir_scan(zip_cdir_t *cd, const zip_uint8_t *data, zip_uint64_t *nentryp);
+static void cdir_read_chunk(void *ud, unsigned int index);
+static void get_names_chunk(void *ud, unsigned int index);
+
+
+/* Parse entries of central directory in data (of cd->size bytes) using several threads.
+   Returns false, without setting an error, if the central directory should be parsed sequentially instead,
+   either because it is too small or because it is damaged (in which case sequential parsing reports the error). */
+
+bool
+_zip_cdir_read_parallel(zip_cdir_t *cd, zip_uint8_t *data, zip_arena_t *arena) {
+    cdir_parallel_t ctx;
+    zip_uint64_t *offset, nentry, nentry_orig, i;
+    unsigned int nthreads, j;
+    bool ok;
+
+    if ((offset = cdir_scan(cd, data, &nentry)) == NULL) {
+        return false;
+    }
+
+    if ((nthreads = _zip_parallel_threads(nentry, ZIP_PARALLEL_MIN_ENTRIES)) < 2) {
+        free(offset);
+        return false;
+    }
+
+    if ((ctx.chunk = (cdir_chunk_t *)malloc(sizeof(*ctx.chunk) * nthreads)) == NULL) {
+        free(offset);
+        return false;
+    }
+    nentry_orig = cd->nentry;
+    if (nentry > cd->nentry && !_zip_cdir_grow(cd, nentry - cd->nentry, NULL)) {
+        free(ctx.chunk);
+        free(offset);
+        return false;
+    }
+
+    ctx.entry = cd->entry;
+    ctx.data = data;
+    ctx.offset = offset;
+    ctx.nentry = nentry;
+    ctx.nchunks = nthreads;
+    for (j = 0; j < nthreads; j++) {
+        _zip_arena_init(&ctx.chunk[j].arena);
+        zip_error_init(&ctx.chunk[j].error);
+        ctx.chunk[j].ok = true;
+    }
+
+    _zip_parallel_run(nthreads, cdir_read_chunk, &ctx);
+
+    ok = true;
+    for (j = 0; j < nthreads; j++) {
+        ok = ok && ctx.chunk[j].ok;
+        zip_error_fini(&ctx.chunk[j].error);
+    }
+
+    if (ok) {
+        for (j = 0; j < nthreads; j++) {
+            _zip_arena_merge(arena, &ctx.chunk[j].arena);
+        }
+    }
+    else {
+        for (i = 0; i < nentry; i++) {
+            _zip_dirent_free(cd->entry[i].orig);
+            cd->entry[i].orig = NULL;
+        }
+        for (j = 0; j < nthreads; j++) {
+            _zip_arena_fini(&ctx.chunk[j].arena);
+        }
+        /* let sequential parsing handle InfoZIP entry count itself */
+        cd->nentry = cd->nentry_alloc = nentry_orig;
+    }
+
+    free(ctx.chunk);
+    free(offset);
+
+    return ok;
+}
+
+
+/* Get names of all entries of za into names, using several threads. */
+
+bool
+_zip_get_names_parallel(zip_t *za, const zip_uint8_t **names, unsigned int nthreads, zip_error_t *error) {
+    names_parallel_t ctx;
+    unsigned int j;
+    bool ok;
+
+    ctx.entry = za->entry;
+    ctx.names = names;
+    ctx.nentry = za->nentry;
+    ctx.nchunks = nthreads;
+    if ((ctx.error = (zip_error_t *)malloc(sizeof(*ctx.error) * nthreads)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+    if ((ctx.ok = (bool *)malloc(sizeof(*ctx.ok) * nthreads)) == NULL) {
+        free(ctx.error);
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+    for (j = 0; j < nthreads; j++) {
+        zip_error_init(&ctx.error[j]);
+        ctx.ok[j] = true;
+    }
+
+    _zip_parallel_run(nthreads, get_names_chunk, &ctx);
+
+    ok = true;
+    for (j = 0; j < nthreads; j++) {
+        if (ok && !ctx.ok[j]) {
+            _zip_error_copy(error, &ctx.error[j]);
+            ok = false;
+        }
+        zip_error_fini(&ctx.error[j]);
+    }
+
+    free(ctx.error);
+    free(ctx.ok);
+
+    return ok;
+}
+
+
+/* Call function(ud, index) for index from 0 to n - 1, concurrently if possible. */
+
+void
+_zip_parallel_run(unsigned int n, zip_parallel_function_t function, void *ud) {
+#ifdef HAVE_PTHREAD
+    pthread_t *tid;
+    thread_t *thread;
+    bool *started;
+    unsigned int i;
+
+    if (n > 1) {
+        tid = (pthread_t *)malloc(sizeof(*tid) * n);
+        thread = (thread_t *)malloc(sizeof(*thread) * n);
+        started = (bool *)malloc(sizeof(*started) * n);
+
+        if (tid != NULL && thread != NULL && started != NULL) {
+            for (i = 1; i < n; i++) {
+                thread[i].function = function;
+                thread[i].ud = ud;
+                thread[i].index = i;
+                started[i] = pthread_create(tid + i, NULL, thread_main, thread + i) == 0;
+            }
+
+            function(ud, 0);
+
+            for (i = 1; i < n; i++) {
+                if (started[i]) {
+                    pthread_join(tid[i], NULL);
+                }
+                else {
+                    function(ud, i);
+                }
+            }
+
+            free(tid);
+            free(thread);
+            free(started);
+            return;
+        }
+
+        free(tid);
+        free(thread);
+        free(started);
+    }
+#endif
+
+    {
+        unsigned int j;
+
+        for (j = 0; j < n; j++) {
+            function(ud, j);
+        }
+    }
+}
+
+
+/* Number of threads to use for nitems items, so that each gets at least min_items_per_thread. */
+
+unsigned int
+_zip_parallel_threads(zip_uint64_t nitems, zip_uint64_t min_items_per_thread) {
+#if defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    zip_uint64_t n = nitems / min_items_per_thread;
+
+    if (ncpu < 2 || n < 2) {
+        return 1;
+    }
+    if (n > (zip_uint64_t)ncpu) {
+        n = (zip_uint64_t)ncpu;
+    }
+    if (n > ZIP_PARALLEL_MAX_THREADS) {
+        n = ZIP_PARALLEL_MAX_THREADS;
+    }
+
+    return (unsigned int)n;
+#else
+    (void)nitems;
+    (void)min_items_per_thread;
+    return 1;
+#endif
+}
+
+
+/* Find start of each entry using only fixed size part of headers.
+   Returns NULL if the entries are not exactly as announced by the end of central directory record. */
+
+static zip_uint64_t *
+cdir_scan(zip_cdir_t *cd, const zip_uint8_t *data, zip_uint64_t *nentryp) {
+    zip_uint64_t *offset, *new_offset;
+    zip_uint64_t n, n_alloc, off;
+
+    n_alloc = cd->nentry + 1;
+    if (n_alloc == 0 || n_alloc > SIZE_MAX / sizeof(*offset) || (offset = (zip_uint64_t *)malloc(sizeof(*offset) * n_alloc)) == NULL) {
+        return NULL;
+    }
+
+    n = 0;
+    off = 0;
+    while (off < cd->size) {
+        const zip_uint8_t *p = data + off;
+        zip_uint64_t size;
+
+        if (cd->size - off < CDENTRYSIZE || memcmp(p, CENTRAL_MAGIC, 4) != 0) {
+            free(offset);
+            return NULL;
+        }
+
+        size = CDENTRYSIZE + (zip_uint64_t)(p[28] | (p[29] << 8)) + (zip_uint64_t)(p[30] | (p[31] << 8)) + (zip_uint64_t)(p[32] | (p[33] << 8));
+        if (size > cd->size - off) {
+            free(offset);
+            return NULL;
+        }
+
+        if (n + 1 == n_alloc) {
+            /* InfoZIP stores nentries % 0x10000 */
+            if (cd->is_zip64 || n_alloc + 0x10000 > SIZE_MAX / sizeof(*offset) || (new_offset = (zip_uint64_t *)realloc(offset, sizeof(*offset) * (n_alloc + 0x10000))) == NULL) {
+                free(offset);
+                return NULL;
+            }
+            offset = new_offset;
+            n_alloc += 0x10000;
+        }
+
+        offset[n++] = off;
+        off += size;
+    }
+    offset[n] = off;
+
+    if (n < cd->nentry || (n - cd->nentry) % 0x10000 != 0) {
+        free(offset);
+        return NULL;
+    }
+
+    *nentryp = n;
+    return offset;
+}
+
+
+static void
+cdir_read_chunk(void *ud, unsigned int index) {
+    cdir_parallel_t *ctx = (cdir_parallel_t *)ud;
+    cdir_chunk_t *chunk = ctx->chunk + index;
+    zip_uint64_t first = ctx->nentry * index / ctx->nchunks;
+    zip_uint64_t last = ctx->nentry * (index + 1) / ctx->nchunks;
+    zip_buffer_t *buffer;
+    zip_uint64_t i;
+
+    if ((buffer = _zip_buffer_new(ctx->data + ctx->offset[first], ctx->offset[last] - ctx->offset[first])) == NULL) {
+        chunk->ok = false;
+        return;
+    }
+
+    for (i = first; i < last; i++) {
+        zip_entry_t *entry = ctx->entry + i;
+
+        if ((entry->orig = _zip_dirent_new(&chunk->arena)) == NULL) {
+            chunk->ok = false;
+            break;
+        }
+        if (_zip_dirent_read(entry->orig, NULL, buffer, false, &chunk->arena, &chunk->error) != (zip_int64_t)(ctx->offset[i + 1] - ctx->offset[i])) {
+            chunk->ok = false;
+            break;
+        }
+    }
+
+    _zip_buffer_free(buffer);
+}
+
+
+static void
+get_names_chunk(void *ud, unsigned int index) {
+    names_parallel_t *ctx = (names_parallel_t *)ud;
+    zip_uint64_t first = ctx->nentry * index / ctx->nchunks;
+    zip_uint64_t last = ctx->nentry * (index + 1) / ctx->nchunks;
+    zip_uint64_t i;
+
+    for (i = first; i < last; i++) {
+        if ((ctx->names[i] = _zip_string_get(ctx->entry[i].orig->filename, NULL, 0, &ctx->error[index])) == NULL) {
+            ctx->ok[index] = false;
+            return;
+        }
+    }
+}
+
+
+#ifdef HAVE_PTHREAD
+static void *
+thread_main(void *ud) {
+    thread_t *thread = (thread_t *)ud;
+
+    thread->function(thread->ud, thread->index);
+
+    return NULL;
+}
+#endif
@@ -0,0 +1,642 @@
+/*
+  zip_read_files.c -- read many files, using several threads
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "zipint.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* Unchanged, unencrypted files are read by worker threads, which
+   decompress them independently of the archive, using only
+   positional reads of the archive source.  All other files are read
+   in the calling thread with zip_fopen_index().  The callback is
+   always called in the calling thread, which also reads files while
+   it has nothing to report.
+
+   Positional reads may run concurrently with each other, but not with
+   anything else using the archive source, like reading a file with
+   zip_fopen_index(). */
+
+#define READ_FILES_DEFAULT_MEMORY (64 * 1024 * 1024) /* default limit for data of files read but not yet reported */
+
+typedef enum { JOB_PENDING, JOB_RUNNING, JOB_DONE } job_state_t;
+
+typedef struct {
+    zip_uint64_t index;
+    bool direct; /* read by workers, otherwise in calling thread */
+    zip_uint16_t comp_method;
+    zip_uint16_t bitflags;
+    zip_uint32_t crc;
+    zip_uint64_t comp_size;
+    zip_uint64_t size;
+    zip_uint64_t offset; /* of local header */
+
+    job_state_t state;
+    zip_uint8_t *data;
+    zip_error_t error;
+} job_t;
+
+typedef struct {
+    zip_t *za;
+    zip_flags_t flags;
+    zip_read_files_callback callback;
+    void *ud;
+    bool read_at; /* archive source supports concurrent positional reads */
+    bool threads; /* workers are running */
+
+    job_t *job;
+    zip_uint64_t njob;
+    zip_uint64_t next;          /* first job not yet started by workers */
+    zip_uint64_t next_indirect; /* first job possibly not yet started by calling thread */
+    zip_uint64_t nreported;
+    zip_uint64_t *done; /* finished jobs not yet reported, for ZIP_FL_UNORDERED */
+    zip_uint64_t done_start;
+    zip_uint64_t done_end;
+    zip_uint64_t memory; /* size of data of started jobs not yet reported */
+    zip_uint64_t max_memory;
+    bool abort;
+    zip_error_t error;
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;   /* job finished, job reported, or abort */
+    pthread_rwlock_t io_lock; /* shared for positional reads of archive source, exclusive for other access */
+#endif
+} read_files_t;
+
+static void finish_job(read_files_t *ctx, job_t *job);
+static void lock(read_files_t *ctx);
+static void lock_io(read_files_t *ctx, bool exclusive);
+static zip_uint64_t job_memory(const job_t *job);
+static job_t *next_job(read_files_t *ctx);
+static job_t *next_report(read_files_t *ctx);
+static void read_files_thread(void *ud, unsigned int index);
+static bool read_indirect(read_files_t *ctx, job_t *job);
+static bool read_job(read_files_t *ctx, job_t *job);
+static bool read_source(read_files_t *ctx, zip_uint8_t *data, zip_uint64_t length, zip_uint64_t offset, zip_error_t *error);
+static void report(read_files_t *ctx);
+static void signal_changed(read_files_t *ctx);
+static void unlock(read_files_t *ctx);
+static void unlock_io(read_files_t *ctx);
+static void wait_changed(read_files_t *ctx);
+static void work(read_files_t *ctx);
+
+
+ZIP_EXTERN int
+zip_read_files(zip_t *za, const zip_uint64_t *indices, zip_uint64_t nindices, zip_flags_t flags, zip_uint64_t max_memory, zip_read_files_callback callback, void *ud) {
+    read_files_t ctx;
+    zip_uint64_t i;
+    unsigned int nthreads;
+    bool ok;
+
+    if (za == NULL) {
+        return -1;
+    }
+    if ((indices == NULL && nindices > 0) || callback == NULL || (flags & ~(ZIP_FL_UNCHANGED | ZIP_FL_UNORDERED)) != 0) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+    if (nindices == 0) {
+        return 0;
+    }
+
+    if (nindices > SIZE_MAX / sizeof(*ctx.job) || (ctx.job = (job_t *)malloc(sizeof(*ctx.job) * (size_t)nindices)) == NULL) {
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+    ctx.done = NULL;
+    if ((flags & ZIP_FL_UNORDERED) && (ctx.done = (zip_uint64_t *)malloc(sizeof(*ctx.done) * (size_t)nindices)) == NULL) {
+        free(ctx.job);
+        zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+
+    ctx.max_memory = max_memory > 0 ? max_memory : READ_FILES_DEFAULT_MEMORY;
+
+    /* directory entries are only read here, workers don't touch za */
+    for (i = 0; i < nindices; i++) {
+        job_t *job = ctx.job + i;
+        zip_entry_t *entry;
+        zip_dirent_t *de;
+
+        if (indices[i] >= za->nentry) {
+            zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+            break;
+        }
+        entry = za->entry + indices[i];
+        if (!_zip_lazy_cdir_read_entry(za->lazy_cdir, entry, indices[i], &za->error)) {
+            break;
+        }
+
+        job->index = indices[i];
+        job->state = JOB_PENDING;
+        job->data = NULL;
+        zip_error_init(&job->error);
+
+        de = entry->orig;
+        job->direct = de != NULL && ((flags & ZIP_FL_UNCHANGED) || (entry->source == NULL && !entry->deleted)) && de->encryption_method == ZIP_EM_NONE && (de->comp_method == ZIP_CM_STORE || _zip_get_compression_algorithm(de->comp_method, false) != NULL);
+        if (job->direct) {
+            job->comp_method = (zip_uint16_t)de->comp_method;
+            job->bitflags = de->bitflags;
+            job->crc = de->crc;
+            job->comp_size = de->comp_size;
+            job->size = de->uncomp_size;
+            job->offset = de->offset;
+            /* don't hold compressed and uncompressed data of files larger than limit, decompress them while reading */
+            if (job_memory(job) > ctx.max_memory) {
+                job->direct = false;
+            }
+        }
+        else {
+            job->size = 0;
+        }
+    }
+    if (i < nindices) {
+        zip_uint64_t j;
+
+        for (j = 0; j < i; j++) {
+            zip_error_fini(&ctx.job[j].error);
+        }
+        free(ctx.job);
+        free(ctx.done);
+        return -1;
+    }
+
+    ctx.za = za;
+    ctx.flags = flags;
+    ctx.callback = callback;
+    ctx.ud = ud;
+    ctx.read_at = ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(za->src), ZIP_SOURCE_READ_AT);
+    ctx.njob = nindices;
+    ctx.next = 0;
+    ctx.next_indirect = 0;
+    ctx.nreported = 0;
+    ctx.done_start = 0;
+    ctx.done_end = 0;
+    ctx.memory = 0;
+    ctx.abort = false;
+    zip_error_init(&ctx.error);
+
+    /* calling thread reports files, the others read them */
+    nthreads = _zip_parallel_threads(nindices, 1);
+#ifdef HAVE_PTHREAD
+    if (nthreads > 1) {
+        if (pthread_mutex_init(&ctx.mutex, NULL) != 0) {
+            nthreads = 1;
+        }
+        else if (pthread_cond_init(&ctx.changed, NULL) != 0) {
+            pthread_mutex_destroy(&ctx.mutex);
+            nthreads = 1;
+        }
+        else if (pthread_rwlock_init(&ctx.io_lock, NULL) != 0) {
+            pthread_cond_destroy(&ctx.changed);
+            pthread_mutex_destroy(&ctx.mutex);
+            nthreads = 1;
+        }
+    }
+#endif
+    ctx.threads = nthreads > 1;
+    if (ctx.threads) {
+        _zip_parallel_run(nthreads + 1, read_files_thread, &ctx);
+#ifdef HAVE_PTHREAD
+        pthread_rwlock_destroy(&ctx.io_lock);
+        pthread_cond_destroy(&ctx.changed);
+        pthread_mutex_destroy(&ctx.mutex);
+#endif
+    }
+    else {
+        report(&ctx);
+    }
+
+    ok = zip_error_code_zip(&ctx.error) == ZIP_ER_OK;
+    if (!ok) {
+        _zip_error_copy(&za->error, &ctx.error);
+    }
+
+    for (i = 0; i < nindices; i++) {
+        free(ctx.job[i].data);
+        zip_error_fini(&ctx.job[i].error);
+    }
+    zip_error_fini(&ctx.error);
+    free(ctx.job);
+    free(ctx.done);
+
+    return ok ? 0 : -1;
+}
+
+
+/* mark job as done, called with lock held */
+static void
+finish_job(read_files_t *ctx, job_t *job) {
+    job->state = JOB_DONE;
+    /* compressed data has been freed */
+    ctx->memory -= job_memory(job) - job->size;
+    if (ctx->done != NULL) {
+        ctx->done[ctx->done_end++] = (zip_uint64_t)(job - ctx->job);
+    }
+    signal_changed(ctx);
+}
+
+
+static void
+lock(read_files_t *ctx) {
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&ctx->mutex);
+#else
+    (void)ctx;
+#endif
+}
+
+
+/* lock archive source, shared only for positional reads */
+static void
+lock_io(read_files_t *ctx, bool exclusive) {
+#ifdef HAVE_PTHREAD
+    if (ctx->threads) {
+        if (exclusive || !ctx->read_at) {
+            pthread_rwlock_wrlock(&ctx->io_lock);
+        }
+        else {
+            pthread_rwlock_rdlock(&ctx->io_lock);
+        }
+    }
+#else
+    (void)ctx;
+    (void)exclusive;
+#endif
+}
+
+
+/* memory needed while reading job: its data, plus its compressed data if it has to be decompressed */
+static zip_uint64_t
+job_memory(const job_t *job) {
+    if (job->comp_method == ZIP_CM_STORE) {
+        return job->size;
+    }
+    return job->comp_size > ZIP_UINT64_MAX - job->size ? ZIP_UINT64_MAX : job->size + job->comp_size;
+}
+
+
+/* start next job for workers, NULL if there is none or if its data would exceed memory limit; called with lock held */
+static job_t *
+next_job(read_files_t *ctx) {
+    job_t *job;
+
+    while (ctx->next < ctx->njob && !ctx->job[ctx->next].direct) {
+        ctx->next++;
+    }
+    if (ctx->next == ctx->njob) {
+        return NULL;
+    }
+
+    job = ctx->job + ctx->next;
+    if (job_memory(job) > ctx->max_memory - ZIP_MIN(ctx->memory, ctx->max_memory)) {
+        return NULL;
+    }
+
+    job->state = JOB_RUNNING;
+    ctx->memory += job_memory(job);
+    ctx->next++;
+
+    return job;
+}
+
+
+/* next job to report, possibly not read yet if calling thread has to read it; called with lock held */
+static job_t *
+next_report(read_files_t *ctx) {
+    job_t *job;
+
+    if (ctx->done == NULL) {
+        job = ctx->job + ctx->nreported;
+        if (job->state == JOB_DONE || !job->direct) {
+            return job;
+        }
+        return NULL;
+    }
+
+    if (ctx->done_start < ctx->done_end) {
+        return ctx->job + ctx->done[ctx->done_start++];
+    }
+    while (ctx->next_indirect < ctx->njob) {
+        job = ctx->job + ctx->next_indirect++;
+        if (!job->direct) {
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void
+read_files_thread(void *ud, unsigned int index) {
+    read_files_t *ctx = (read_files_t *)ud;
+
+    if (index == 0) {
+        report(ctx);
+    }
+    else {
+        work(ctx);
+    }
+}
+
+
+/* read file of job using zip_fopen_index(), only in calling thread */
+static bool
+read_indirect(read_files_t *ctx, job_t *job) {
+    zip_file_t *zf;
+    zip_uint64_t size, alloc;
+    zip_int64_t n;
+
+    if ((zf = zip_fopen_index(ctx->za, job->index, ctx->flags & ZIP_FL_UNCHANGED)) == NULL) {
+        _zip_error_copy(&job->error, &ctx->za->error);
+        return false;
+    }
+
+    size = 0;
+    alloc = 0;
+    do {
+        if (size == alloc) {
+            /* size is known for unchanged files, allocate one byte more to detect end-of-file without growing buffer */
+            zip_uint64_t new_alloc = alloc > 0 ? alloc * 2 : job->size > 0 && job->size < ZIP_UINT64_MAX ? job->size + 1 : BUFSIZE;
+            zip_uint8_t *data;
+
+            if (new_alloc > SIZE_MAX || (data = (zip_uint8_t *)realloc(job->data, (size_t)new_alloc)) == NULL) {
+                zip_error_set(&job->error, ZIP_ER_MEMORY, 0);
+                zip_fclose(zf);
+                return false;
+            }
+            job->data = data;
+            alloc = new_alloc;
+        }
+
+        if ((n = zip_fread(zf, job->data + size, alloc - size)) < 0) {
+            _zip_error_copy(&job->error, zip_file_get_error(zf));
+            zip_fclose(zf);
+            return false;
+        }
+        size += (zip_uint64_t)n;
+    } while (n > 0);
+
+    zip_fclose(zf);
+    job->size = size;
+
+    return true;
+}
+
+
+/* read and verify data of unchanged, unencrypted file, without using za */
+static bool
+read_job(read_files_t *ctx, job_t *job) {
+    zip_uint8_t header[LENTRYSIZE];
+    zip_buffer_t *buffer;
+    zip_uint64_t offset;
+    zip_uint64_t i;
+    uLong crc;
+
+    if (job->size > SIZE_MAX || (job->data = (zip_uint8_t *)malloc(job->size > 0 ? (size_t)job->size : 1)) == NULL) {
+        zip_error_set(&job->error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    if (!read_source(ctx, header, sizeof(header), job->offset, &job->error)) {
+        return false;
+    }
+    if ((buffer = _zip_buffer_new(header, sizeof(header))) == NULL) {
+        zip_error_set(&job->error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+    if (memcmp(_zip_buffer_get(buffer, 4), LOCAL_MAGIC, 4) != 0) {
+        zip_error_set(&job->error, ZIP_ER_NOZIP, 0);
+        _zip_buffer_free(buffer);
+        return false;
+    }
+    _zip_buffer_set_offset(buffer, LENTRYSIZE - 4);
+    offset = job->offset + LENTRYSIZE + _zip_buffer_get_16(buffer);
+    offset += _zip_buffer_get_16(buffer);
+    _zip_buffer_free(buffer);
+
+    if (job->comp_method == ZIP_CM_STORE) {
+        if (job->comp_size != job->size) {
+            zip_error_set(&job->error, ZIP_ER_DATA_LENGTH, 0);
+            return false;
+        }
+        if (!read_source(ctx, job->data, job->size, offset, &job->error)) {
+            return false;
+        }
+    }
+    else {
+        zip_uint8_t *compressed;
+        bool ok;
+
+        if (job->comp_size > SIZE_MAX || (compressed = (zip_uint8_t *)malloc(job->comp_size > 0 ? (size_t)job->comp_size : 1)) == NULL) {
+            zip_error_set(&job->error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+        /* contexts of archive are not thread safe */
+        ok = read_source(ctx, compressed, job->comp_size, offset, &job->error) && _zip_decompress_buffer(NULL, job->comp_method, job->bitflags, compressed, job->comp_size, job->data, job->size, &job->error);
+        free(compressed);
+        if (!ok) {
+            return false;
+        }
+    }
+
+    crc = crc32(0, Z_NULL, 0);
+    for (i = 0; i < job->size; i += UINT_MAX) {
+        crc = crc32(crc, job->data + i, (uInt)ZIP_MIN(UINT_MAX, job->size - i));
+    }
+    if ((zip_uint32_t)crc != job->crc) {
+        zip_error_set(&job->error, ZIP_ER_CRC, 0);
+        return false;
+    }
+
+    return true;
+}
+
+
+/* read length bytes at offset of archive source, concurrently if supported */
+static bool
+read_source(read_files_t *ctx, zip_uint8_t *data, zip_uint64_t length, zip_uint64_t offset, zip_error_t *error) {
+    zip_source_t *src = ctx->za->src;
+    int ret;
+
+    lock_io(ctx, false);
+    ret = _zip_read_at_offset(src, offset, data, length, error);
+    unlock_io(ctx);
+    if (ret < 0 && ctx->read_at && ctx->threads) {
+        /* error of source may have been overwritten by concurrent read, so retry alone */
+        _zip_error_clear(error);
+        lock_io(ctx, true);
+        ret = _zip_read_at_offset(src, offset, data, length, error);
+        unlock_io(ctx);
+    }
+
+    return ret == 0;
+}
+
+
+/* report files to callback, reading files while waiting for workers */
+static void
+report(read_files_t *ctx) {
+    job_t *job;
+    int ret;
+
+    lock(ctx);
+    while (!ctx->abort && ctx->nreported < ctx->njob) {
+        if ((job = next_report(ctx)) != NULL) {
+            if (!job->direct) {
+                job->state = JOB_RUNNING;
+                unlock(ctx);
+                lock_io(ctx, true);
+                (void)read_indirect(ctx, job);
+                unlock_io(ctx);
+                lock(ctx);
+                job->state = JOB_DONE;
+            }
+
+            if (zip_error_code_zip(&job->error) != ZIP_ER_OK) {
+                _zip_error_copy(&ctx->error, &job->error);
+                break;
+            }
+
+            unlock(ctx);
+            ret = ctx->callback(ctx->za, job->index, job->data, job->size, ctx->ud);
+            lock(ctx);
+
+            free(job->data);
+            job->data = NULL;
+            if (job->direct) {
+                ctx->memory -= job->size;
+            }
+            ctx->nreported++;
+            signal_changed(ctx);
+
+            if (ret < 0) {
+                zip_error_set(&ctx->error, ZIP_ER_CANCELLED, 0);
+                break;
+            }
+            continue;
+        }
+
+        /* help workers, or do their work if threads couldn't be started */
+        if ((job = next_job(ctx)) != NULL) {
+            unlock(ctx);
+            (void)read_job(ctx, job);
+            lock(ctx);
+            finish_job(ctx, job);
+            continue;
+        }
+
+        wait_changed(ctx);
+    }
+
+    ctx->abort = true;
+    signal_changed(ctx);
+    unlock(ctx);
+}
+
+
+static void
+signal_changed(read_files_t *ctx) {
+#ifdef HAVE_PTHREAD
+    pthread_cond_broadcast(&ctx->changed);
+#else
+    (void)ctx;
+#endif
+}
+
+
+static void
+unlock(read_files_t *ctx) {
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&ctx->mutex);
+#else
+    (void)ctx;
+#endif
+}
+
+
+static void
+unlock_io(read_files_t *ctx) {
+#ifdef HAVE_PTHREAD
+    if (ctx->threads) {
+        pthread_rwlock_unlock(&ctx->io_lock);
+    }
+#else
+    (void)ctx;
+#endif
+}
+
+
+/* wait for change by other thread, called with lock held; only called if other threads are running jobs */
+static void
+wait_changed(read_files_t *ctx) {
+#ifdef HAVE_PTHREAD
+    pthread_cond_wait(&ctx->changed, &ctx->mutex);
+#else
+    (void)ctx;
+#endif
+}
+
+
+/* read files until all are started or reporting is aborted */
+static void
+work(read_files_t *ctx) {
+    job_t *job;
+
+    lock(ctx);
+    while (!ctx->abort) {
+        if ((job = next_job(ctx)) == NULL) {
+            if (ctx->next == ctx->njob) {
+                break;
+            }
+            wait_changed(ctx);
+            continue;
+        }
+
+        unlock(ctx);
+        (void)read_job(ctx, job);
+        lock(ctx);
+        finish_job(ctx, job);
+    }
+    unlock(ctx);
+}
@@ -0,0 +1,120 @@
+/*
+  zip_readahead.c -- announce data of files that will be read soon
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "zipint.h"
+
+static void readahead_range(zip_t *za, zip_uint64_t start, zip_uint64_t end);
+
+
+ZIP_EXTERN int
+zip_set_readahead(zip_t *za, zip_uint64_t length) {
+    if (za == NULL) {
+        return -1;
+    }
+
+    za->readahead = length;
+    za->readahead_next = 0;
+    return 0;
+}
+
+
+/* Called when data of file idx, length bytes at offset, is opened
+   for reading from start to end.  If the caller asked for read-ahead,
+   tell the archive source so, and that data of the following files, up
+   to za->readahead bytes, will be read soon, so it can start reading
+   it in the background.  Files already announced are skipped, adjacent
+   files are announced together, and ranges shorter than
+   ZIP_READAHEAD_MIN_SIZE are not announced at all: the operating system
+   reads that much anyway, so the hint would only cost a system call.
+   Since this is only a hint, errors are ignored. */
+
+void
+_zip_readahead(zip_t *za, zip_uint64_t idx, zip_uint64_t offset, zip_uint64_t length) {
+    zip_error_t error;
+    zip_uint64_t i, announced, start, end;
+
+    if (za->readahead == 0 || !ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(za->src), ZIP_SOURCE_ADVISE)) {
+        return;
+    }
+
+    if (length >= ZIP_READAHEAD_MIN_SIZE) {
+        _zip_source_advise(za->src, offset, length, ZIP_SOURCE_ADVICE_SEQUENTIAL);
+    }
+
+    zip_error_init(&error);
+    announced = 0;
+    start = end = 0;
+    for (i = idx + 1; i < za->nentry && announced < za->readahead; i++) {
+        zip_entry_t *entry = za->entry + i;
+        zip_dirent_t *de;
+        zip_uint64_t size;
+
+        if (!_zip_lazy_cdir_read_entry(za->lazy_cdir, entry, i, &error)) {
+            break;
+        }
+        if ((de = entry->orig) == NULL || entry->deleted || entry->source != NULL) {
+            /* original data won't be read */
+            continue;
+        }
+
+        /* local header usually matches central one, exact size doesn't matter for a hint */
+        size = LENTRYSIZE + _zip_string_length(de->filename) + de->comp_size;
+        if (i >= za->readahead_next) {
+            if (end > start && (de->offset < start || de->offset > end + ZIP_READAHEAD_MIN_SIZE)) {
+                readahead_range(za, start, end);
+                start = end = 0;
+            }
+            if (end == start) {
+                start = de->offset;
+            }
+            end = ZIP_MAX(end, de->offset + size);
+        }
+        announced += size;
+    }
+    zip_error_fini(&error);
+    readahead_range(za, start, end);
+
+    if (i > za->readahead_next) {
+        za->readahead_next = i;
+    }
+}
+
+
+static void
+readahead_range(zip_t *za, zip_uint64_t start, zip_uint64_t end) {
+    if (end - start >= ZIP_READAHEAD_MIN_SIZE) {
+        _zip_source_advise(za->src, start, end - start, ZIP_SOURCE_ADVICE_WILLNEED);
+    }
+}
@@ -0,0 +1,205 @@
+/*
+  zip_refresh.c -- read entries added to archive since it was opened
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+
+#include <zlib.h>
+
+#include "zipint.h"
+
+/* Archives that are only appended to (entries written after the
+   last one, followed by a new central directory that repeats the old
+   one) can be refreshed by reading only the new entries.  Whether the
+   old entries are unchanged is checked using the CRC-32 of the
+   central directory, which zip_refresh computes for the central
+   directory it reads (on first refresh of an archive opened with
+   ZIP_LAZY, from the raw central directory kept in memory).  Without
+   it, the old entries are parsed again and compared field by field. */
+
+
+zip_uint32_t
+_zip_cdir_crc(const zip_uint8_t *data, zip_uint64_t length) {
+    uLong crc = crc32(0, Z_NULL, 0);
+
+    while (length > 0) {
+        uInt n = (uInt)ZIP_MIN(length, ZIP_UINT32_MAX);
+
+        crc = crc32(crc, (const Bytef *)data, n);
+        data += n;
+        length -= n;
+    }
+
+    return (zip_uint32_t)crc;
+}
+
+
+ZIP_EXTERN int
+zip_refresh(zip_t *za, zip_source_t *src) {
+    zip_source_t *old_src;
+    zip_cdir_t *cdir;
+    zip_stat_t st;
+    zip_uint64_t nentry, idx;
+    const zip_uint8_t *name;
+
+    if (za == NULL) {
+        return -1;
+    }
+
+    if ((za->open_flags & ZIP_RDONLY) == 0) {
+        zip_error_set(&za->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    if (!za->cdir_crc_valid && za->lazy_cdir != NULL && za->lazy_cdir->size == za->cdir_size) {
+        /* opened with ZIP_LAZY, raw central directory is still available */
+        za->cdir_crc = _zip_cdir_crc(za->lazy_cdir->data, za->cdir_size);
+        za->cdir_crc_valid = true;
+    }
+
+    old_src = za->src;
+    if (src == NULL) {
+        src = old_src;
+    }
+    else {
+        if ((zip_source_supports(src) & ZIP_SOURCE_SUPPORTS_SEEKABLE) != ZIP_SOURCE_SUPPORTS_SEEKABLE) {
+            zip_error_set(&za->error, ZIP_ER_OPNOTSUPP, 0);
+            return -1;
+        }
+        if (zip_source_open(src) < 0) {
+            zip_error_set_from_source(&za->error, src);
+            return -1;
+        }
+    }
+
+    zip_stat_init(&st);
+    if (zip_source_stat(src, &st) < 0) {
+        zip_error_set_from_source(&za->error, src);
+        cdir = NULL;
+    }
+    else if ((st.valid & ZIP_STAT_SIZE) == 0) {
+        zip_error_set(&za->error, ZIP_ER_SEEK, EOPNOTSUPP);
+        cdir = NULL;
+    }
+    else if (st.size == 0 && zip_source_accept_empty(src)) {
+        /* still empty */
+        if (za->nentry > 0 || za->cdir_size > 0) {
+            zip_error_set(&za->error, ZIP_ER_CHANGED, 0);
+            cdir = NULL;
+        }
+        else if ((cdir = _zip_cdir_new(0, &za->error)) != NULL) {
+            cdir->crc = za->cdir_crc;
+            cdir->crc_valid = za->cdir_crc_valid;
+        }
+    }
+    else {
+        za->src = src;
+        cdir = _zip_find_central_dir(za, st.size, true);
+        za->src = old_src;
+    }
+
+    /* names of entries already read must be in hash before new ones */
+    if (cdir != NULL && !_zip_hash_reserve_capacity(za->names, cdir->nentry, &za->error)) {
+        _zip_cdir_free(cdir);
+        cdir = NULL;
+    }
+
+    /* add names of new entries before taking them, so archive is unchanged on error */
+    nentry = za->nentry;
+    if (cdir != NULL) {
+        for (idx = nentry; idx < cdir->nentry; idx++) {
+            zip_error_t error;
+            bool ok;
+
+            if ((name = _zip_string_get(cdir->entry[idx].orig->filename, NULL, 0, &za->error)) == NULL) {
+                break;
+            }
+            /* duplicate names are ignored, as when opening without ZIP_CHECKCONS */
+            zip_error_init(&error);
+            ok = _zip_hash_add(za->names, name, idx, ZIP_FL_UNCHANGED, &error) || zip_error_code_zip(&error) == ZIP_ER_EXISTS;
+            if (!ok) {
+                _zip_error_copy(&za->error, &error);
+            }
+            zip_error_fini(&error);
+            if (!ok) {
+                break;
+            }
+        }
+        if (idx < cdir->nentry) {
+            while (idx-- > nentry) {
+                /* converted name was cached by first call */
+                _zip_hash_remove_unchanged(za->names, _zip_string_get(cdir->entry[idx].orig->filename, NULL, 0, NULL), idx);
+            }
+            _zip_cdir_free(cdir);
+            cdir = NULL;
+        }
+    }
+
+    if (cdir == NULL) {
+        if (src != old_src) {
+            zip_source_close(src);
+        }
+        return -1;
+    }
+
+    /* keep entries already read, take new ones from cdir */
+    for (idx = 0; idx < nentry; idx++) {
+        cdir->entry[idx] = za->entry[idx];
+    }
+    free(za->entry);
+    za->entry = cdir->entry;
+    za->nentry = cdir->nentry;
+    za->nentry_alloc = cdir->nentry_alloc;
+
+    _zip_string_free(za->comment_orig);
+    za->comment_orig = cdir->comment;
+    za->cdir_offset = cdir->offset;
+    za->cdir_size = cdir->size;
+    za->cdir_crc = cdir->crc;
+    za->cdir_crc_valid = cdir->crc_valid;
+
+    free(cdir);
+
+    if (src != old_src) {
+        za->src = src;
+        zip_source_close(old_src);
+        zip_source_free(old_src);
+    }
+
+    _zip_name_index_add(za, nentry);
+
+    for (idx = nentry; idx < za->nentry; idx++) {
+        _zip_dir_index_update(za, idx);
+    }
+
+    return 0;
+}
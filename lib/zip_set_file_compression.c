@@ -83,7 +83,7 @@ zip_set_file_compression(zip_t *za, zip_uint64_t idx, zip_int32_t method, zip_ui
         }
 
         e->changes->comp_method = method;
-        e->changes->compression_level = (zip_uint16_t)flags;
+        e->changes->compression_level = flags;
         e->changes->changed |= ZIP_DIRENT_COMP_METHOD;
     }
 
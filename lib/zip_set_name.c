@@ -153,5 +153,8 @@ _zip_set_name(zip_t *za, zip_uint64_t idx, const char *name, zip_flags_t flags)
         e->changes->filename = str;
     }
 
+    _zip_name_index_update(za, idx);
+    _zip_dir_index_update(za, idx);
+
     return 0;
 }
@@ -72,6 +72,7 @@ struct read_data {
 static buffer_t *buffer_clone(buffer_t *buffer, zip_uint64_t length, zip_error_t *error);
 static zip_uint64_t buffer_find_fragment(const buffer_t *buffer, zip_uint64_t offset);
 static void buffer_free(buffer_t *buffer);
+static const zip_uint8_t *buffer_get_data(const buffer_t *buffer, zip_uint64_t offset, zip_uint64_t length, zip_error_t *error);
 static bool buffer_grow_fragments(buffer_t *buffer, zip_uint64_t capacity, zip_error_t *error);
 static buffer_t *buffer_new(const zip_buffer_fragment_t *fragments, zip_uint64_t nfragments, int free_data, zip_error_t *error);
 static zip_int64_t buffer_read(buffer_t *buffer, zip_uint8_t *data, zip_uint64_t length);
@@ -220,6 +221,18 @@ read_data(void *state, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
         free(ctx);
         return 0;
 
+    case ZIP_SOURCE_GET_DATA: {
+        zip_source_args_get_data_t *args = ZIP_SOURCE_GET_ARGS(zip_source_args_get_data_t, data, len, &ctx->error);
+
+        if (args == NULL) {
+            return -1;
+        }
+        if ((args->data = buffer_get_data(ctx->in, args->offset, args->length, &ctx->error)) == NULL) {
+            return -1;
+        }
+        return 0;
+    }
+
     case ZIP_SOURCE_GET_FILE_ATTRIBUTES: {
         if (len < sizeof(ctx->attributes)) {
             zip_error_set(&ctx->error, ZIP_ER_INVAL, 0);
@@ -287,7 +300,7 @@ read_data(void *state, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
     }
 
     case ZIP_SOURCE_SUPPORTS:
-        return zip_source_make_command_bitmap(ZIP_SOURCE_GET_FILE_ATTRIBUTES, ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT, ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, ZIP_SOURCE_SEEK, ZIP_SOURCE_TELL, ZIP_SOURCE_BEGIN_WRITE, ZIP_SOURCE_BEGIN_WRITE_CLONING, ZIP_SOURCE_COMMIT_WRITE, ZIP_SOURCE_REMOVE, ZIP_SOURCE_ROLLBACK_WRITE, ZIP_SOURCE_SEEK_WRITE, ZIP_SOURCE_TELL_WRITE, ZIP_SOURCE_WRITE, ZIP_SOURCE_SUPPORTS_REOPEN, -1);
+        return zip_source_make_command_bitmap(ZIP_SOURCE_GET_FILE_ATTRIBUTES, ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT, ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, ZIP_SOURCE_SEEK, ZIP_SOURCE_TELL, ZIP_SOURCE_BEGIN_WRITE, ZIP_SOURCE_BEGIN_WRITE_CLONING, ZIP_SOURCE_COMMIT_WRITE, ZIP_SOURCE_REMOVE, ZIP_SOURCE_ROLLBACK_WRITE, ZIP_SOURCE_SEEK_WRITE, ZIP_SOURCE_TELL_WRITE, ZIP_SOURCE_WRITE, ZIP_SOURCE_SUPPORTS_REOPEN, ZIP_SOURCE_GET_DATA, -1);
 
     case ZIP_SOURCE_TELL:
         if (ctx->in->offset > ZIP_INT64_MAX) {
@@ -425,6 +438,31 @@ buffer_free(buffer_t *buffer) {
 }
 
 
+/* Return pointer to length bytes at offset, which must be in one fragment. */
+
+static const zip_uint8_t *
+buffer_get_data(const buffer_t *buffer, zip_uint64_t offset, zip_uint64_t length, zip_error_t *error) {
+    zip_uint64_t fragment;
+
+    if (offset > buffer->size || length > buffer->size - offset) {
+        zip_error_set(error, ZIP_ER_EOF, 0);
+        return NULL;
+    }
+    if (buffer->nfragments == 0) {
+        zip_error_set(error, ZIP_ER_OPNOTSUPP, 0);
+        return NULL;
+    }
+
+    fragment = buffer_find_fragment(buffer, offset);
+    if (offset + length > buffer->fragment_offsets[fragment + 1]) {
+        zip_error_set(error, ZIP_ER_OPNOTSUPP, 0);
+        return NULL;
+    }
+
+    return buffer->fragments[fragment].data + (offset - buffer->fragment_offsets[fragment]);
+}
+
+
 static bool
 buffer_grow_fragments(buffer_t *buffer, zip_uint64_t capacity, zip_error_t *error) {
     zip_buffer_fragment_t *fragments;
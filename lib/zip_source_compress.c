@@ -31,6 +31,7 @@
   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -52,6 +53,22 @@ struct context {
 
     zip_compression_algorithm_t *algorithm;
     void *ud;
+
+    zip_compression_pool_t *pool; /* pool to return context to when source is freed, or NULL */
+};
+
+/* Decompression contexts of freed sources are kept by the archive and
+   reused for the next file using the same method, which saves setting
+   up the compression library and allocating its buffers for each file.
+   Sources can outlive their archive, so the pool is reference counted. */
+
+#define COMPRESSION_POOL_SIZE 4
+
+struct zip_compression_pool {
+    unsigned int refcount; /* archive and contexts using pool */
+    bool closed;           /* archive was discarded, don't keep contexts */
+    unsigned int nentry;
+    struct context *entry[COMPRESSION_POOL_SIZE];
 };
 
 
@@ -86,7 +103,12 @@ static size_t implementations_size = sizeof(implementations) / sizeof(implementa
 static zip_source_t *compression_source_new(zip_t *za, zip_source_t *src, zip_int32_t method, bool compress, int compression_flags);
 static zip_int64_t compress_callback(zip_source_t *, void *, void *, zip_uint64_t, zip_source_cmd_t);
 static void context_free(struct context *ctx);
+static zip_uint64_t context_memory_usage(void *ud);
 static struct context *context_new(zip_int32_t method, bool compress, int compression_flags, zip_compression_algorithm_t *algorithm);
+static void context_release(struct context *ctx);
+static struct context *decompression_context_get(zip_t *za, zip_int32_t method, zip_compression_algorithm_t *algorithm);
+static struct context *pool_get(zip_t *za, zip_int32_t method);
+static void pool_unref(zip_compression_pool_t *pool);
 static zip_int64_t compress_read(zip_source_t *, struct context *, void *, zip_uint64_t);
 
 zip_compression_algorithm_t *
@@ -143,20 +165,168 @@ compression_source_new(zip_t *za, zip_source_t *src, zip_int32_t method, bool co
         return NULL;
     }
 
-    if ((ctx = context_new(method, compress, compression_flags, algorithm)) == NULL) {
+    if ((ctx = compress ? context_new(method, compress, compression_flags, algorithm) : decompression_context_get(za, method, algorithm)) == NULL) {
         zip_error_set(&za->error, ZIP_ER_MEMORY, 0);
         return NULL;
     }
 
     if ((s2 = zip_source_layered(za, src, compress_callback, ctx)) == NULL) {
-        context_free(ctx);
+        context_release(ctx);
         return NULL;
     }
+    s2->memory_usage = context_memory_usage;
 
     return s2;
 }
 
 
+/* decompress length bytes of data of file compressed with method and
+   with general purpose bit flags bitflags into out, which must be
+   filled exactly; za is only used to reuse contexts and may be NULL */
+bool
+_zip_decompress_buffer(zip_t *za, zip_int32_t method, zip_uint16_t bitflags, const zip_uint8_t *data, zip_uint64_t length, zip_uint8_t *out, zip_uint64_t out_length, zip_error_t *error) {
+    zip_compression_algorithm_t *algorithm;
+    struct context *ctx;
+    zip_stat_t st;
+    zip_file_attributes_t attributes;
+    zip_uint64_t in_offset, out_offset;
+    bool end;
+
+    if ((algorithm = _zip_get_compression_algorithm(method, false)) == NULL) {
+        zip_error_set(error, ZIP_ER_COMPNOTSUPP, 0);
+        return false;
+    }
+    if ((ctx = decompression_context_get(za, method, algorithm)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+
+    /* some algorithms need these, like LZMA for data without end marker */
+    zip_stat_init(&st);
+    st.valid = ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE | ZIP_STAT_COMP_METHOD;
+    st.size = out_length;
+    st.comp_size = length;
+    st.comp_method = method;
+    zip_file_attributes_init(&attributes);
+    attributes.valid = ZIP_FILE_ATTRIBUTES_GENERAL_PURPOSE_BIT_FLAGS;
+    attributes.general_purpose_bit_flags = bitflags;
+    attributes.general_purpose_bit_mask = ZIP_FILE_ATTRIBUTES_GENERAL_PURPOSE_BIT_FLAGS_ALLOWED_MASK;
+    if (!ctx->algorithm->start(ctx->ud, &st, &attributes)) {
+        _zip_error_copy(error, &ctx->error);
+        context_release(ctx);
+        return false;
+    }
+
+    /* all input and output are passed at once, so this loops only to signal end of input */
+    in_offset = 0;
+    out_offset = 0;
+    ctx->end_of_input = false;
+    end = false;
+    while (!end) {
+        zip_uint8_t excess;
+        zip_uint8_t *buffer;
+        zip_uint64_t n;
+        zip_compression_status_t ret;
+
+        /* detect data past end of out */
+        if (out_offset < out_length) {
+            buffer = out + out_offset;
+            n = out_length - out_offset;
+        }
+        else {
+            buffer = &excess;
+            n = 1;
+        }
+
+        ret = ctx->algorithm->process(ctx->ud, buffer, &n);
+        if (ret == ZIP_COMPRESSION_ERROR) {
+            if (zip_error_code_zip(&ctx->error) == ZIP_ER_OK) {
+                zip_error_set(&ctx->error, ZIP_ER_INTERNAL, 0);
+            }
+            break;
+        }
+        if (n > 0 && buffer == &excess) {
+            zip_error_set(&ctx->error, ZIP_ER_DATA_LENGTH, 0);
+            break;
+        }
+        out_offset += n;
+
+        switch (ret) {
+        case ZIP_COMPRESSION_END:
+            end = true;
+            break;
+
+        case ZIP_COMPRESSION_NEED_DATA:
+            if (in_offset < length) {
+                /* compression libraries take at most UINT_MAX bytes at once */
+                n = ZIP_MIN(length - in_offset, UINT_MAX);
+                if (!ctx->algorithm->input(ctx->ud, (zip_uint8_t *)data + in_offset, n)) {
+                    end = true;
+                    break;
+                }
+                in_offset += n;
+            }
+            else if (!ctx->end_of_input) {
+                ctx->end_of_input = true;
+                ctx->algorithm->end_of_input(ctx->ud);
+            }
+            else {
+                end = true;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (!ctx->algorithm->end(ctx->ud) && zip_error_code_zip(&ctx->error) == ZIP_ER_OK) {
+        zip_error_set(&ctx->error, ZIP_ER_INTERNAL, 0);
+    }
+    if (zip_error_code_zip(&ctx->error) == ZIP_ER_OK && out_offset != out_length) {
+        zip_error_set(&ctx->error, ZIP_ER_DATA_LENGTH, 0);
+    }
+    if (zip_error_code_zip(&ctx->error) != ZIP_ER_OK) {
+        _zip_error_copy(error, &ctx->error);
+        context_release(ctx);
+        return false;
+    }
+
+    context_release(ctx);
+    return true;
+}
+
+
+/* get context for decompressing method, reusing one kept by archive if possible; za may be NULL */
+static struct context *
+decompression_context_get(zip_t *za, zip_int32_t method, zip_compression_algorithm_t *algorithm) {
+    struct context *ctx;
+
+    if (za != NULL && (ctx = pool_get(za, method)) != NULL) {
+        return ctx;
+    }
+
+    if ((ctx = context_new(method, false, 0, algorithm)) == NULL) {
+        return NULL;
+    }
+    if (za == NULL) {
+        return ctx;
+    }
+
+    if (za->decompression_pool == NULL && (za->decompression_pool = (zip_compression_pool_t *)malloc(sizeof(*za->decompression_pool))) != NULL) {
+        za->decompression_pool->refcount = 1;
+        za->decompression_pool->closed = false;
+        za->decompression_pool->nentry = 0;
+    }
+    /* without a pool, the context is simply not reused */
+    if ((ctx->pool = za->decompression_pool) != NULL) {
+        ctx->pool->refcount++;
+    }
+
+    return ctx;
+}
+
+
 static struct context *
 context_new(zip_int32_t method, bool compress, int compression_flags, zip_compression_algorithm_t *algorithm) {
     struct context *ctx;
@@ -172,6 +342,7 @@ context_new(zip_int32_t method, bool compress, int compression_flags, zip_compre
     ctx->end_of_input = false;
     ctx->end_of_stream = false;
     ctx->is_stored = false;
+    ctx->pool = NULL;
 
     if ((ctx->ud = ctx->algorithm->allocate(ZIP_CM_ACTUAL(method), compression_flags, &ctx->error)) == NULL) {
         zip_error_fini(&ctx->error);
@@ -191,11 +362,105 @@ context_free(struct context *ctx) {
 
     ctx->algorithm->deallocate(ctx->ud);
     zip_error_fini(&ctx->error);
+    pool_unref(ctx->pool);
 
     free(ctx);
 }
 
 
+/* return context to its pool if there is room, otherwise free it */
+static void
+context_release(struct context *ctx) {
+    zip_compression_pool_t *pool = ctx->pool;
+
+    if (pool == NULL || pool->closed || pool->nentry == COMPRESSION_POOL_SIZE) {
+        context_free(ctx);
+        return;
+    }
+
+    _zip_error_clear(&ctx->error);
+    pool->entry[pool->nentry++] = ctx;
+}
+
+
+/* includes buffer and state of compression library */
+static zip_uint64_t
+context_memory_usage(void *ud) {
+    struct context *ctx = (struct context *)ud;
+
+    return sizeof(*ctx) + ctx->algorithm->memory_usage(ctx->ud);
+}
+
+
+/* free unused contexts and drop reference of archive */
+void
+_zip_compression_pool_close(zip_compression_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pool->closed = true;
+    while (pool->nentry > 0) {
+        context_free(pool->entry[--pool->nentry]);
+    }
+    pool_unref(pool);
+}
+
+
+/* memory used by unused contexts kept for reuse */
+zip_uint64_t
+_zip_compression_pool_memory_usage(const zip_compression_pool_t *pool) {
+    zip_uint64_t usage;
+    unsigned int i;
+
+    if (pool == NULL) {
+        return 0;
+    }
+
+    usage = sizeof(*pool);
+    for (i = 0; i < pool->nentry; i++) {
+        usage += context_memory_usage(pool->entry[i]);
+    }
+
+    return usage;
+}
+
+
+/* take unused context for method from pool of archive, or NULL if there is none */
+static struct context *
+pool_get(zip_t *za, zip_int32_t method) {
+    zip_compression_pool_t *pool = za->decompression_pool;
+    struct context *ctx;
+    unsigned int i;
+
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    for (i = pool->nentry; i > 0; i--) {
+        ctx = pool->entry[i - 1];
+        if (ctx->method == method) {
+            pool->entry[i - 1] = pool->entry[--pool->nentry];
+            return ctx;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void
+pool_unref(zip_compression_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    if (--pool->refcount == 0) {
+        free(pool);
+    }
+}
+
+
 static zip_int64_t
 compress_read(zip_source_t *src, struct context *ctx, void *data, zip_uint64_t len) {
     zip_compression_status_t ret;
@@ -369,7 +634,7 @@ compress_callback(zip_source_t *src, void *ud, void *data, zip_uint64_t len, zip
         return zip_error_to_data(&ctx->error, data, len);
 
     case ZIP_SOURCE_FREE:
-        context_free(ctx);
+        context_release(ctx);
         return 0;
 
     case ZIP_SOURCE_GET_FILE_ATTRIBUTES: {
@@ -48,12 +48,14 @@ struct crc_context {
     zip_uint32_t crc;
 };
 
+static zip_uint64_t crc_memory_usage(void *);
 static zip_int64_t crc_read(zip_source_t *, void *, void *, zip_uint64_t, zip_source_cmd_t);
 
 
 zip_source_t *
 zip_source_crc_create(zip_source_t *src, int validate, zip_error_t *error) {
     struct crc_context *ctx;
+    zip_source_t *s2;
 
     if (src == NULL) {
         zip_error_set(error, ZIP_ER_INVAL, 0);
@@ -72,7 +74,19 @@ zip_source_crc_create(zip_source_t *src, int validate, zip_error_t *error) {
     ctx->crc = (zip_uint32_t)crc32(0, NULL, 0);
     ctx->size = 0;
 
-    return zip_source_layered_create(src, crc_read, ctx, error);
+    if ((s2 = zip_source_layered_create(src, crc_read, ctx, error)) == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    s2->memory_usage = crc_memory_usage;
+
+    return s2;
+}
+
+
+static zip_uint64_t
+crc_memory_usage(void *_ctx) {
+    return sizeof(struct crc_context);
 }
 
 
@@ -172,7 +186,7 @@ crc_read(zip_source_t *src, void *_ctx, void *data, zip_uint64_t len, zip_source
             return -1;
         }
 
-        return mask & ~zip_source_make_command_bitmap(ZIP_SOURCE_BEGIN_WRITE, ZIP_SOURCE_COMMIT_WRITE, ZIP_SOURCE_ROLLBACK_WRITE, ZIP_SOURCE_SEEK_WRITE, ZIP_SOURCE_TELL_WRITE, ZIP_SOURCE_REMOVE, ZIP_SOURCE_GET_FILE_ATTRIBUTES, -1);
+        return mask & ~zip_source_make_command_bitmap(ZIP_SOURCE_BEGIN_WRITE, ZIP_SOURCE_COMMIT_WRITE, ZIP_SOURCE_ROLLBACK_WRITE, ZIP_SOURCE_SEEK_WRITE, ZIP_SOURCE_TELL_WRITE, ZIP_SOURCE_REMOVE, ZIP_SOURCE_GET_FILE_ATTRIBUTES, -1) & ~ZIP_SOURCE_SUPPORTS_DIRECT_ACCESS;
     }
 
     case ZIP_SOURCE_SEEK: {
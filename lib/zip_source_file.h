@@ -67,17 +67,23 @@ struct zip_source_file_context {
 
 /* The following methods must be implemented to support each feature:
    - close, read, seek, and stat must always be implemented.
+   - read_at is optional, it is used for reading from an offset without changing the file position.
+   - get_data is optional, it is used for accessing data in memory without copying; the pointer must stay valid until close.
+   - advise is optional, it is used for passing hints about data that will be read soon to the operating system.
    - To support specifying the file by name, open, and strdup must be implemented.
    - For write support, the file must be specified by name and close, commit_write, create_temp_output, remove, rollback_write, and tell must be implemented.
    - create_temp_output_cloning is always optional. */
 
 struct zip_source_file_operations {
+    void (*advise)(zip_source_file_context_t *ctx, zip_uint64_t offset, zip_uint64_t len, int advice);
     void (*close)(zip_source_file_context_t *ctx);
     zip_int64_t (*commit_write)(zip_source_file_context_t *ctx);
     zip_int64_t (*create_temp_output)(zip_source_file_context_t *ctx);
     zip_int64_t (*create_temp_output_cloning)(zip_source_file_context_t *ctx, zip_uint64_t len);
+    const void *(*get_data)(zip_source_file_context_t *ctx, zip_uint64_t offset, zip_uint64_t len);
     bool (*open)(zip_source_file_context_t *ctx);
     zip_int64_t (*read)(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len);
+    zip_int64_t (*read_at)(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len, zip_uint64_t offset);
     zip_int64_t (*remove)(zip_source_file_context_t *ctx);
     void (*rollback_write)(zip_source_file_context_t *ctx);
     bool (*seek)(zip_source_file_context_t *ctx, void *f, zip_int64_t offset, int whence);
@@ -87,4 +93,7 @@ struct zip_source_file_operations {
     zip_int64_t (*write)(zip_source_file_context_t *ctx, const void *data, zip_uint64_t len);
 };
 
+/* at most this many bytes of data that will be read sequentially are requested in advance, read-ahead of the operating system takes over from there */
+#define ZIP_SOURCE_FILE_WILLNEED_MAX (1024 * 1024)
+
 zip_source_t *zip_source_file_common_new(const char *fname, void *file, zip_uint64_t start, zip_int64_t len, const zip_stat_t *st, zip_source_file_operations_t *ops, void *ops_userdata, zip_error_t *error);
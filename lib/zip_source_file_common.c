@@ -40,6 +40,7 @@
 #include "zip_source_file.h"
 
 static zip_int64_t read_file(void *state, void *data, zip_uint64_t len, zip_source_cmd_t cmd);
+static zip_uint64_t file_memory_usage(void *state);
 
 static void
 zip_source_file_stat_init(zip_source_file_stat_t *st) {
@@ -181,6 +182,15 @@ zip_source_file_common_new(const char *fname, void *file, zip_uint64_t start, zi
         }
 
         ctx->supports |= ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_GET_FILE_ATTRIBUTES);
+        if (sb.regular_file && ops->read_at != NULL) {
+            ctx->supports |= ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_READ_AT);
+        }
+        if (sb.regular_file && ops->get_data != NULL) {
+            ctx->supports |= ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_GET_DATA);
+        }
+        if (sb.regular_file && ops->advise != NULL) {
+            ctx->supports |= ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_ADVISE);
+        }
     }
 
     ctx->supports |= ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_ACCEPT_EMPTY);
@@ -195,11 +205,28 @@ zip_source_file_common_new(const char *fname, void *file, zip_uint64_t start, zi
         free(ctx);
         return NULL;
     }
+    zs->memory_usage = file_memory_usage;
 
     return zs;
 }
 
 
+static zip_uint64_t
+file_memory_usage(void *state) {
+    zip_source_file_context_t *ctx = (zip_source_file_context_t *)state;
+    zip_uint64_t usage = sizeof(*ctx);
+
+    if (ctx->fname) {
+        usage += strlen(ctx->fname) + 1;
+    }
+    if (ctx->tmpname) {
+        usage += strlen(ctx->tmpname) + 1;
+    }
+
+    return usage;
+}
+
+
 static zip_int64_t
 read_file(void *state, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
     zip_source_file_context_t *ctx;
@@ -212,6 +239,21 @@ read_file(void *state, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
     case ZIP_SOURCE_ACCEPT_EMPTY:
         return 0;
 
+    case ZIP_SOURCE_ADVISE: {
+        zip_source_args_advise_t *args;
+
+        args = ZIP_SOURCE_GET_ARGS(zip_source_args_advise_t, data, len, &ctx->error);
+        if (args == NULL) {
+            return -1;
+        }
+
+        /* only supported for regular files, so len is valid */
+        if (args->offset < ctx->len && args->length > 0) {
+            ctx->ops->advise(ctx, ctx->start + args->offset, ZIP_MIN(args->length, ctx->len - args->offset), args->advice);
+        }
+        return 0;
+    }
+
     case ZIP_SOURCE_BEGIN_WRITE:
         /* write support should not be set if fname is NULL */
         if (ctx->fname == NULL) {
@@ -257,6 +299,26 @@ read_file(void *state, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
         free(ctx);
         return 0;
 
+    case ZIP_SOURCE_GET_DATA: {
+        zip_source_args_get_data_t *args;
+
+        args = ZIP_SOURCE_GET_ARGS(zip_source_args_get_data_t, data, len, &ctx->error);
+        if (args == NULL) {
+            return -1;
+        }
+
+        /* only supported for regular files, so len is valid */
+        if (args->offset > ctx->len || args->length > ctx->len - args->offset) {
+            zip_error_set(&ctx->error, ZIP_ER_EOF, 0);
+            return -1;
+        }
+
+        if ((args->data = ctx->ops->get_data(ctx, ctx->start + args->offset, args->length)) == NULL) {
+            return -1;
+        }
+        return 0;
+    }
+
     case ZIP_SOURCE_GET_FILE_ATTRIBUTES:
         if (len < sizeof(ctx->attributes)) {
             zip_error_set(&ctx->error, ZIP_ER_INVAL, 0);
@@ -301,6 +363,32 @@ read_file(void *state, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
         return i;
     }
 
+    case ZIP_SOURCE_READ_AT: {
+        zip_source_args_read_at_t *args;
+        zip_uint64_t n;
+
+        args = ZIP_SOURCE_GET_ARGS(zip_source_args_read_at_t, data, len, &ctx->error);
+        if (args == NULL) {
+            return -1;
+        }
+
+        n = args->length;
+        if (ctx->len > 0) {
+            if (args->offset >= ctx->len) {
+                return 0;
+            }
+            n = ZIP_MIN(ctx->len - args->offset, n);
+        }
+
+        /* The actual offset inside the file must be representable as zip_int64_t. */
+        if (args->offset > ZIP_INT64_MAX - ctx->start) {
+            zip_error_set(&ctx->error, ZIP_ER_SEEK, EOVERFLOW);
+            return -1;
+        }
+
+        return ctx->ops->read_at(ctx, args->data, n, ctx->start + args->offset);
+    }
+
     case ZIP_SOURCE_REMOVE:
         return ctx->ops->remove(ctx);
 
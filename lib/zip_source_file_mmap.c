@@ -0,0 +1,298 @@
+/*
+  zip_source_file_mmap.c -- read-only file source using a memory mapping
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "zipint.h"
+
+#include "zip_source_file.h"
+#include "zip_source_file_stdio.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    int fd;
+    zip_uint8_t *data; /* mapping of file, NULL if it couldn't be mapped */
+    zip_uint64_t size; /* size of file when it was opened */
+    zip_uint64_t offset;
+} zip_mmap_file_t;
+
+static void _zip_mmap_op_advise(zip_source_file_context_t *ctx, zip_uint64_t offset, zip_uint64_t len, int advice);
+static void _zip_mmap_op_close(zip_source_file_context_t *ctx);
+static const void *_zip_mmap_op_get_data(zip_source_file_context_t *ctx, zip_uint64_t offset, zip_uint64_t len);
+static bool _zip_mmap_op_open(zip_source_file_context_t *ctx);
+static zip_int64_t _zip_mmap_op_read(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len);
+static zip_int64_t _zip_mmap_op_read_at(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len, zip_uint64_t offset);
+static bool _zip_mmap_op_seek(zip_source_file_context_t *ctx, void *f, zip_int64_t offset, int whence);
+static char *_zip_mmap_op_strdup(zip_source_file_context_t *ctx, const char *string);
+static zip_int64_t _zip_mmap_op_tell(zip_source_file_context_t *ctx, void *f);
+
+/* clang-format off */
+static zip_source_file_operations_t ops_mmap = {
+    _zip_mmap_op_advise,
+    _zip_mmap_op_close,
+    NULL,
+    NULL,
+    NULL,
+    _zip_mmap_op_get_data,
+    _zip_mmap_op_open,
+    _zip_mmap_op_read,
+    _zip_mmap_op_read_at,
+    NULL,
+    NULL,
+    _zip_mmap_op_seek,
+    _zip_stdio_op_stat,
+    _zip_mmap_op_strdup,
+    _zip_mmap_op_tell,
+    NULL
+};
+/* clang-format on */
+
+
+/* Create read-only source for file fname that reads from a memory
+   mapping.  Files that can't be mapped are read using stdio. */
+
+zip_source_t *
+_zip_source_file_mmap_create(const char *fname, zip_error_t *error) {
+    struct stat sb;
+
+    if (fname == NULL) {
+        zip_error_set(error, ZIP_ER_INVAL, 0);
+        return NULL;
+    }
+
+    if (stat(fname, &sb) < 0 || !S_ISREG(sb.st_mode) || sb.st_size == 0 || (zip_uint64_t)sb.st_size > SIZE_MAX) {
+        return zip_source_file_create(fname, 0, -1, error);
+    }
+
+    return zip_source_file_common_new(fname, NULL, 0, -1, NULL, &ops_mmap, NULL, error);
+}
+
+
+/* have kernel start reading pages of mapping, or of file if it couldn't be mapped */
+static void
+_zip_mmap_op_advise(zip_source_file_context_t *ctx, zip_uint64_t offset, zip_uint64_t len, int advice) {
+    zip_mmap_file_t *file = (zip_mmap_file_t *)ctx->f;
+    long page_size;
+    zip_uint64_t start;
+
+    if (offset >= file->size) {
+        return;
+    }
+    len = ZIP_MIN(len, file->size - offset);
+    /* POSIX_MADV_SEQUENTIAL would let pages be dropped right after they are read */
+    if (advice == ZIP_SOURCE_ADVICE_SEQUENTIAL) {
+        len = ZIP_MIN(len, ZIP_SOURCE_FILE_WILLNEED_MAX);
+    }
+
+    if (file->data != NULL) {
+        page_size = sysconf(_SC_PAGESIZE);
+        start = page_size > 0 ? offset - offset % (zip_uint64_t)page_size : offset;
+        (void)posix_madvise(file->data + start, (size_t)(len + (offset - start)), POSIX_MADV_WILLNEED);
+    }
+#ifdef HAVE_POSIX_FADVISE
+    else if ((off_t)offset >= 0 && (zip_uint64_t)(off_t)offset == offset) {
+        (void)posix_fadvise(file->fd, (off_t)offset, (off_t)len, POSIX_FADV_WILLNEED);
+    }
+#endif
+}
+
+
+static void
+_zip_mmap_op_close(zip_source_file_context_t *ctx) {
+    zip_mmap_file_t *file = (zip_mmap_file_t *)ctx->f;
+
+    if (file->data != NULL) {
+        munmap(file->data, (size_t)file->size);
+    }
+    close(file->fd);
+    free(file);
+}
+
+
+static const void *
+_zip_mmap_op_get_data(zip_source_file_context_t *ctx, zip_uint64_t offset, zip_uint64_t len) {
+    zip_mmap_file_t *file = (zip_mmap_file_t *)ctx->f;
+
+    if (file->data == NULL) {
+        zip_error_set(&ctx->error, ZIP_ER_OPNOTSUPP, 0);
+        return NULL;
+    }
+    if (offset > file->size || len > file->size - offset) {
+        zip_error_set(&ctx->error, ZIP_ER_EOF, 0);
+        return NULL;
+    }
+
+    return file->data + offset;
+}
+
+
+static bool
+_zip_mmap_op_open(zip_source_file_context_t *ctx) {
+    zip_mmap_file_t *file;
+    struct stat sb;
+    void *data;
+    int fd;
+
+    if ((fd = open(ctx->fname, O_RDONLY | O_CLOEXEC)) < 0) {
+        zip_error_set(&ctx->error, ZIP_ER_OPEN, errno);
+        return false;
+    }
+    if (fstat(fd, &sb) < 0) {
+        zip_error_set(&ctx->error, ZIP_ER_READ, errno);
+        close(fd);
+        return false;
+    }
+    if ((file = (zip_mmap_file_t *)malloc(sizeof(*file))) == NULL) {
+        zip_error_set(&ctx->error, ZIP_ER_MEMORY, 0);
+        close(fd);
+        return false;
+    }
+
+    file->fd = fd;
+    file->data = NULL;
+    file->size = (zip_uint64_t)sb.st_size;
+    file->offset = 0;
+
+    /* if mapping fails, e.g. because address space is exhausted, read from fd instead */
+    if (S_ISREG(sb.st_mode) && sb.st_size > 0 && (zip_uint64_t)sb.st_size <= SIZE_MAX) {
+        if ((data = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_SHARED, fd, 0)) != MAP_FAILED) {
+            file->data = (zip_uint8_t *)data;
+        }
+    }
+
+    ctx->f = file;
+    return true;
+}
+
+
+static zip_int64_t
+_zip_mmap_op_read(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len) {
+    zip_mmap_file_t *file = (zip_mmap_file_t *)ctx->f;
+    zip_int64_t n;
+
+    if ((n = _zip_mmap_op_read_at(ctx, buf, len, file->offset)) > 0) {
+        file->offset += (zip_uint64_t)n;
+    }
+
+    return n;
+}
+
+
+static zip_int64_t
+_zip_mmap_op_read_at(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len, zip_uint64_t offset) {
+    zip_mmap_file_t *file = (zip_mmap_file_t *)ctx->f;
+
+    if (file->data == NULL) {
+        ssize_t n;
+
+        if (len > SSIZE_MAX) {
+            len = SSIZE_MAX;
+        }
+        if ((off_t)offset < 0 || (zip_uint64_t)(off_t)offset != offset) {
+            zip_error_set(&ctx->error, ZIP_ER_SEEK, EOVERFLOW);
+            return -1;
+        }
+
+        do {
+            n = pread(file->fd, buf, (size_t)len, (off_t)offset);
+        } while (n < 0 && errno == EINTR);
+
+        if (n < 0) {
+            zip_error_set(&ctx->error, ZIP_ER_READ, errno);
+            return -1;
+        }
+        return (zip_int64_t)n;
+    }
+
+    /* pages beyond the end of a file truncated after it was opened raise SIGBUS, see ZIP_MMAP in zip_open(3) */
+    if (offset >= file->size) {
+        return 0;
+    }
+
+    len = ZIP_MIN(len, ZIP_MIN(file->size - offset, (zip_uint64_t)ZIP_INT64_MAX));
+    (void)memcpy_s(buf, (size_t)len, file->data + offset, (size_t)len);
+
+    return (zip_int64_t)len;
+}
+
+
+static bool
+_zip_mmap_op_seek(zip_source_file_context_t *ctx, void *f, zip_int64_t offset, int whence) {
+    zip_mmap_file_t *file = (zip_mmap_file_t *)f;
+    zip_int64_t base;
+
+    switch (whence) {
+    case SEEK_SET:
+        base = 0;
+        break;
+
+    case SEEK_CUR:
+        base = (zip_int64_t)file->offset;
+        break;
+
+    case SEEK_END:
+        base = (zip_int64_t)file->size;
+        break;
+
+    default:
+        zip_error_set(&ctx->error, ZIP_ER_SEEK, EINVAL);
+        return false;
+    }
+
+    if ((offset > 0 && base > ZIP_INT64_MAX - offset) || base + offset < 0) {
+        zip_error_set(&ctx->error, ZIP_ER_SEEK, EINVAL);
+        return false;
+    }
+
+    file->offset = (zip_uint64_t)(base + offset);
+    return true;
+}
+
+
+static char *
+_zip_mmap_op_strdup(zip_source_file_context_t *ctx, const char *string) {
+    return strdup(string);
+}
+
+
+static zip_int64_t
+_zip_mmap_op_tell(zip_source_file_context_t *ctx, void *f) {
+    zip_mmap_file_t *file = (zip_mmap_file_t *)f;
+
+    return (zip_int64_t)file->offset;
+}
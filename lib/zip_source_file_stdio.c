@@ -37,9 +37,13 @@
 #include "zip_source_file_stdio.h"
 
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#ifdef HAVE_PREAD
+#include <unistd.h>
+#endif
 
 #ifdef _WIN32
 #ifndef S_IWUSR
@@ -49,12 +53,23 @@
 
 /* clang-format off */
 static zip_source_file_operations_t ops_stdio_read = {
+#ifdef HAVE_POSIX_FADVISE
+    _zip_stdio_op_advise,
+#else
+    NULL,
+#endif
     _zip_stdio_op_close,
     NULL,
     NULL,
     NULL,
     NULL,
+    NULL,
     _zip_stdio_op_read,
+#ifdef HAVE_PREAD
+    _zip_stdio_op_read_at,
+#else
+    NULL,
+#endif
     NULL,
     NULL,
     _zip_stdio_op_seek,
@@ -87,6 +102,25 @@ zip_source_filep_create(FILE *file, zip_uint64_t start, zip_int64_t length, zip_
 }
 
 
+#ifdef HAVE_POSIX_FADVISE
+/* pass hint on to kernel, which starts reading the data in the background */
+void
+_zip_stdio_op_advise(zip_source_file_context_t *ctx, zip_uint64_t offset, zip_uint64_t len, int advice) {
+    int fd = fileno((FILE *)ctx->f);
+
+    if ((off_t)offset < 0 || (zip_uint64_t)(off_t)offset != offset || (off_t)len < 0 || (zip_uint64_t)(off_t)len != len) {
+        return;
+    }
+
+    /* POSIX_FADV_SEQUENTIAL is not used: Linux ignores the range and changes read-ahead for the whole file descriptor, also for other files in the archive */
+    if (advice == ZIP_SOURCE_ADVICE_SEQUENTIAL) {
+        len = ZIP_MIN(len, ZIP_SOURCE_FILE_WILLNEED_MAX);
+    }
+    (void)posix_fadvise(fd, (off_t)offset, (off_t)len, POSIX_FADV_WILLNEED);
+}
+#endif
+
+
 void
 _zip_stdio_op_close(zip_source_file_context_t *ctx) {
     fclose((FILE *)ctx->f);
@@ -111,6 +145,34 @@ _zip_stdio_op_read(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len)
 }
 
 
+#ifdef HAVE_PREAD
+/* read from file descriptor, so the position and buffer of the stream are not affected */
+zip_int64_t
+_zip_stdio_op_read_at(zip_source_file_context_t *ctx, void *buf, zip_uint64_t len, zip_uint64_t offset) {
+    ssize_t i;
+
+    if (len > SSIZE_MAX) {
+        len = SSIZE_MAX;
+    }
+    if ((off_t)offset < 0 || (zip_uint64_t)(off_t)offset != offset) {
+        zip_error_set(&ctx->error, ZIP_ER_SEEK, EOVERFLOW);
+        return -1;
+    }
+
+    do {
+        i = pread(fileno((FILE *)ctx->f), buf, (size_t)len, (off_t)offset);
+    } while (i < 0 && errno == EINTR);
+
+    if (i < 0) {
+        zip_error_set(&ctx->error, ZIP_ER_READ, errno);
+        return -1;
+    }
+
+    return (zip_int64_t)i;
+}
+#endif
+
+
 bool
 _zip_stdio_op_seek(zip_source_file_context_t *ctx, void *f, zip_int64_t offset, int whence) {
 #if ZIP_FSEEK_MAX > ZIP_INT64_MAX
@@ -70,6 +70,11 @@ static FILE *_zip_fopen_close_on_exec(const char *name, bool writeable);
 
 /* clang-format off */
 static zip_source_file_operations_t ops_stdio_named = {
+#ifdef HAVE_POSIX_FADVISE
+    _zip_stdio_op_advise,
+#else
+    NULL,
+#endif
     _zip_stdio_op_close,
     _zip_stdio_op_commit_write,
     _zip_stdio_op_create_temp_output,
@@ -78,8 +83,14 @@ static zip_source_file_operations_t ops_stdio_named = {
 #else
     NULL,
 #endif
+    NULL,
     _zip_stdio_op_open,
     _zip_stdio_op_read,
+#ifdef HAVE_PREAD
+    _zip_stdio_op_read_at,
+#else
+    NULL,
+#endif
     _zip_stdio_op_remove,
     _zip_stdio_op_rollback_write,
     _zip_stdio_op_seek,
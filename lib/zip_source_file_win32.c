@@ -40,14 +40,17 @@ static bool _zip_stat_win32(zip_source_file_context_t *ctx, zip_source_file_stat
 /* clang-format off */
 
 static zip_source_file_operations_t ops_win32_read = {
+    NULL,
     _zip_win32_op_close,
     NULL,
     NULL,
     NULL,
     NULL,
+    NULL,
     _zip_win32_op_read,
     NULL,
     NULL,
+    NULL,
     _zip_win32_op_seek,
     _zip_win32_op_stat,
     NULL,
@@ -46,12 +46,15 @@ static HANDLE win32_named_open(zip_source_file_context_t *ctx, const char *name,
 
 /* clang-format off */
 zip_source_file_operations_t _zip_source_file_win32_named_ops = {
+    NULL,
     _zip_win32_op_close,
     _zip_win32_named_op_commit_write,
     _zip_win32_named_op_create_temp_output,
     NULL,
+    NULL,
     _zip_win32_named_op_open,
     _zip_win32_op_read,
+    NULL,
     _zip_win32_named_op_remove,
     _zip_win32_named_op_rollback_write,
     _zip_win32_op_seek,
@@ -94,6 +94,7 @@ _zip_source_new(zip_error_t *error) {
     src->eof = false;
     src->had_read_error = false;
     src->bytes_read = 0;
+    src->memory_usage = NULL;
 
     return src;
 }
@@ -69,7 +69,8 @@ zip_int64_t zip_source_pass_to_lower_layer(zip_source_t *src, void *data, zip_ui
             zip_error_set(&src->error, ZIP_ER_INTERNAL, 0);
             return -1;
         }
-        return *(zip_int64_t *)data;
+        /* would bypass the transformation done in ZIP_SOURCE_READ, so the callback has to implement them itself */
+        return *(zip_int64_t *)data & ~ZIP_SOURCE_SUPPORTS_DIRECT_ACCESS;
 
     default:
         zip_error_set(&src->error, ZIP_ER_OPNOTSUPP, 0);
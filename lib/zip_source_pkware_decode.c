@@ -48,6 +48,7 @@ static int decrypt_header(zip_source_t *, struct trad_pkware *);
 static zip_int64_t pkware_decrypt(zip_source_t *, void *, void *, zip_uint64_t, zip_source_cmd_t);
 static struct trad_pkware *trad_pkware_new(const char *password, zip_error_t *error);
 static void trad_pkware_free(struct trad_pkware *);
+static zip_uint64_t trad_pkware_memory_usage(void *);
 
 
 zip_source_t *
@@ -72,6 +73,7 @@ zip_source_pkware_decode(zip_t *za, zip_source_t *src, zip_uint16_t em, int flag
         trad_pkware_free(ctx);
         return NULL;
     }
+    s2->memory_usage = trad_pkware_memory_usage;
 
     return s2;
 }
@@ -217,3 +219,11 @@ trad_pkware_free(struct trad_pkware *ctx) {
     free(ctx->password);
     free(ctx);
 }
+
+
+static zip_uint64_t
+trad_pkware_memory_usage(void *ud) {
+    struct trad_pkware *ctx = (struct trad_pkware *)ud;
+
+    return sizeof(*ctx) + strlen(ctx->password) + 1;
+}
@@ -90,6 +90,105 @@ zip_source_read(zip_source_t *src, void *data, zip_uint64_t len) {
 }
 
 
+/* Read len bytes at offset, without changing read position or EOF
+   state of src, so several readers can share src. */
+
+zip_int64_t
+zip_source_read_at(zip_source_t *src, void *data, zip_uint64_t len, zip_uint64_t offset) {
+    zip_source_args_read_at_t args;
+    zip_uint64_t bytes_read;
+    zip_int64_t n;
+
+    if (src->source_closed) {
+        return -1;
+    }
+    if (!ZIP_SOURCE_IS_OPEN_READING(src) || len > ZIP_INT64_MAX || offset > ZIP_INT64_MAX || (len > 0 && data == NULL)) {
+        zip_error_set(&src->error, ZIP_ER_INVAL, 0);
+        return -1;
+    }
+
+    if (len == 0) {
+        return 0;
+    }
+
+    bytes_read = 0;
+    while (bytes_read < len) {
+        args.data = (zip_uint8_t *)data + bytes_read;
+        args.length = len - bytes_read;
+        args.offset = offset + bytes_read;
+
+        if ((n = _zip_source_call(src, &args, sizeof(args), ZIP_SOURCE_READ_AT)) < 0) {
+            if (bytes_read == 0) {
+                return -1;
+            }
+            else {
+                return (zip_int64_t)bytes_read;
+            }
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        bytes_read += (zip_uint64_t)n;
+    }
+
+    return (zip_int64_t)bytes_read;
+}
+
+
+/* Get pointer to length bytes at offset of src without copying.  The
+   data is only valid while src is open. */
+
+const zip_uint8_t *
+_zip_source_get_data(zip_source_t *src, zip_uint64_t offset, zip_uint64_t length, zip_error_t *error) {
+    zip_source_args_get_data_t args;
+
+    if (src->source_closed || !ZIP_SOURCE_IS_OPEN_READING(src)) {
+        zip_error_set(error, ZIP_ER_INVAL, 0);
+        return NULL;
+    }
+    if (!ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(src), ZIP_SOURCE_GET_DATA)) {
+        zip_error_set(error, ZIP_ER_OPNOTSUPP, 0);
+        return NULL;
+    }
+
+    args.data = NULL;
+    args.length = length;
+    args.offset = offset;
+
+    if (_zip_source_call(src, &args, sizeof(args), ZIP_SOURCE_GET_DATA) < 0) {
+        zip_error_set_from_source(error, src);
+        return NULL;
+    }
+    if (args.data == NULL) {
+        zip_error_set(error, ZIP_ER_INTERNAL, 0);
+        return NULL;
+    }
+
+    return (const zip_uint8_t *)args.data;
+}
+
+
+/* Tell src that length bytes at offset will be read soon.  This is
+   only a hint, so errors are ignored. */
+
+void
+_zip_source_advise(zip_source_t *src, zip_uint64_t offset, zip_uint64_t length, int advice) {
+    zip_source_args_advise_t args;
+
+    if (src->source_closed || !ZIP_SOURCE_IS_OPEN_READING(src) || !ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(src), ZIP_SOURCE_ADVISE)) {
+        return;
+    }
+
+    args.offset = offset;
+    args.length = length;
+    args.advice = advice;
+
+    (void)_zip_source_call(src, &args, sizeof(args), ZIP_SOURCE_ADVISE);
+}
+
+
 bool
 _zip_source_eof(zip_source_t *src) {
     return src->eof;
@@ -0,0 +1,244 @@
+/*
+  zip_source_restartable.c -- decompression that can restart in the middle
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+
+#include "zipint.h"
+
+/* Layer for decompressors that can restart in the middle of their
+   data, like at checkpoints of deflated data or at frames of zstd data
+   with a seek table.  Seeking only records the new position; on the
+   next read, the decompressor is asked to restart at or before it if
+   that is closer, and data up to the position is decompressed and
+   skipped. */
+
+struct context {
+    zip_error_t error;
+
+    const zip_restartable_decompressor_t *decompressor;
+    void *ud;
+
+    zip_uint64_t size;       /* size of uncompressed data */
+    zip_uint64_t out_offset; /* offset in uncompressed data of next output of decompressor */
+    zip_uint64_t position;   /* offset in uncompressed data of next read */
+};
+
+static zip_uint64_t restartable_memory_usage(void *ud);
+static zip_int64_t restartable_read(zip_source_t *src, void *ud, void *data, zip_uint64_t len, zip_source_cmd_t cmd);
+static bool restartable_seek(zip_source_t *src, struct context *ctx);
+
+
+/* decompress src using decompressor, which takes ownership of ud; ud is freed on error */
+zip_source_t *
+_zip_source_restartable_new(zip_source_t *src, const zip_restartable_decompressor_t *decompressor, void *ud, zip_error_t *error) {
+    struct context *ctx;
+    zip_source_t *s2;
+
+    if ((ctx = (struct context *)malloc(sizeof(*ctx))) == NULL) {
+        decompressor->free(ud);
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+
+    zip_error_init(&ctx->error);
+    ctx->decompressor = decompressor;
+    ctx->ud = ud;
+    ctx->size = 0;
+
+    if ((s2 = zip_source_layered_create(src, restartable_read, ctx, error)) == NULL) {
+        decompressor->free(ud);
+        zip_error_fini(&ctx->error);
+        free(ctx);
+        return NULL;
+    }
+    s2->memory_usage = restartable_memory_usage;
+
+    return s2;
+}
+
+
+static zip_uint64_t
+restartable_memory_usage(void *ud) {
+    struct context *ctx = (struct context *)ud;
+
+    return sizeof(*ctx) + ctx->decompressor->memory_usage(ctx->ud);
+}
+
+
+static zip_int64_t
+restartable_read(zip_source_t *src, void *ud, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
+    struct context *ctx = (struct context *)ud;
+    zip_int64_t n;
+
+    switch (cmd) {
+    case ZIP_SOURCE_OPEN: {
+        zip_stat_t st;
+
+        if (zip_source_stat(src, &st) < 0) {
+            zip_error_set_from_source(&ctx->error, src);
+            return -1;
+        }
+        if ((st.valid & ZIP_STAT_SIZE) == 0) {
+            zip_error_set(&ctx->error, ZIP_ER_INTERNAL, 0);
+            return -1;
+        }
+
+        ctx->size = st.size;
+        ctx->out_offset = 0;
+        ctx->position = 0;
+
+        if (!ctx->decompressor->start(ctx->ud, src, &ctx->error)) {
+            return -1;
+        }
+        return 0;
+    }
+
+    case ZIP_SOURCE_READ:
+        /* the archive and its state for restarting are gone once it is closed */
+        if (src->source_closed) {
+            zip_error_set(&ctx->error, ZIP_ER_ZIPCLOSED, 0);
+            return -1;
+        }
+
+        if (ctx->position != ctx->out_offset && !restartable_seek(src, ctx)) {
+            return -1;
+        }
+        if ((n = ctx->decompressor->decompress(ctx->ud, src, ctx->out_offset, (zip_uint8_t *)data, len, &ctx->error)) < 0) {
+            return -1;
+        }
+        if (n == 0 && len > 0 && ctx->out_offset < ctx->size) {
+            zip_error_set(&ctx->error, ZIP_ER_DATA_LENGTH, 0);
+            return -1;
+        }
+        ctx->out_offset += (zip_uint64_t)n;
+        ctx->position += (zip_uint64_t)n;
+        return n;
+
+    case ZIP_SOURCE_CLOSE:
+        if (!ctx->decompressor->end(ctx->ud, &ctx->error)) {
+            return -1;
+        }
+        return 0;
+
+    case ZIP_SOURCE_SEEK: {
+        zip_int64_t new_position = zip_source_seek_compute_offset(ctx->position, ctx->size, data, len, &ctx->error);
+
+        if (new_position < 0) {
+            return -1;
+        }
+
+        /* decompression is moved to new position on next read */
+        ctx->position = (zip_uint64_t)new_position;
+        return 0;
+    }
+
+    case ZIP_SOURCE_TELL:
+        return (zip_int64_t)ctx->position;
+
+    case ZIP_SOURCE_STAT: {
+        zip_stat_t *st = (zip_stat_t *)data;
+
+        st->comp_method = ZIP_CM_STORE;
+        st->valid |= ZIP_STAT_COMP_METHOD;
+        return 0;
+    }
+
+    case ZIP_SOURCE_ERROR:
+        return zip_error_to_data(&ctx->error, data, len);
+
+    case ZIP_SOURCE_FREE:
+        ctx->decompressor->free(ctx->ud);
+        zip_error_fini(&ctx->error);
+        free(ctx);
+        return 0;
+
+    case ZIP_SOURCE_GET_FILE_ATTRIBUTES: {
+        zip_file_attributes_t *attributes = (zip_file_attributes_t *)data;
+
+        if (len < sizeof(*attributes)) {
+            zip_error_set(&ctx->error, ZIP_ER_INVAL, 0);
+            return -1;
+        }
+
+        attributes->valid |= ZIP_FILE_ATTRIBUTES_VERSION_NEEDED | ZIP_FILE_ATTRIBUTES_GENERAL_PURPOSE_BIT_FLAGS;
+        attributes->version_needed = 20;
+        attributes->general_purpose_bit_mask = ZIP_FILE_ATTRIBUTES_GENERAL_PURPOSE_BIT_FLAGS_ALLOWED_MASK;
+        attributes->general_purpose_bit_flags = 0;
+
+        return sizeof(*attributes);
+    }
+
+    case ZIP_SOURCE_SUPPORTS:
+        return ZIP_SOURCE_SUPPORTS_SEEKABLE | zip_source_make_command_bitmap(ZIP_SOURCE_GET_FILE_ATTRIBUTES, ZIP_SOURCE_SUPPORTS_REOPEN, -1);
+
+    default:
+        return zip_source_pass_to_lower_layer(src, data, len, cmd);
+    }
+}
+
+
+/* move decompression to ctx->position, restarting closer to it if possible */
+static bool
+restartable_seek(zip_source_t *src, struct context *ctx) {
+    if (!ctx->decompressor->restart(ctx->ud, src, ctx->position, &ctx->out_offset, &ctx->error)) {
+        return false;
+    }
+
+    if (ctx->out_offset < ctx->position) {
+        DEFINE_BYTE_ARRAY(b, BUFSIZE);
+        zip_int64_t n;
+
+        if (!byte_array_init(b, BUFSIZE)) {
+            zip_error_set(&ctx->error, ZIP_ER_MEMORY, 0);
+            return false;
+        }
+
+        while (ctx->out_offset < ctx->position) {
+            if ((n = ctx->decompressor->decompress(ctx->ud, src, ctx->out_offset, b, ZIP_MIN(BUFSIZE, ctx->position - ctx->out_offset), &ctx->error)) < 0) {
+                byte_array_fini(b);
+                return false;
+            }
+            if (n == 0) {
+                /* data ends before uncompressed size */
+                zip_error_set(&ctx->error, ZIP_ER_DATA_LENGTH, 0);
+                byte_array_fini(b);
+                return false;
+            }
+            ctx->out_offset += (zip_uint64_t)n;
+        }
+
+        byte_array_fini(b);
+    }
+
+    return true;
+}
@@ -55,6 +55,7 @@ struct window {
     bool needs_seek;
 };
 
+static zip_uint64_t window_memory_usage(void *);
 static zip_int64_t window_read(zip_source_t *, void *, void *, zip_uint64_t, zip_source_cmd_t);
 
 
@@ -67,6 +68,7 @@ zip_source_window_create(zip_source_t *src, zip_uint64_t start, zip_int64_t len,
 zip_source_t *
 _zip_source_window_new(zip_source_t *src, zip_uint64_t start, zip_int64_t length, zip_stat_t *st, zip_file_attributes_t *attributes, zip_t *source_archive, zip_uint64_t source_index, zip_error_t *error) {
     struct window *ctx;
+    zip_source_t *s2;
 
     if (src == NULL || length < -1 || (source_archive == NULL && source_index != 0)) {
         zip_error_set(error, ZIP_ER_INVAL, 0);
@@ -103,7 +105,7 @@ _zip_source_window_new(zip_source_t *src, zip_uint64_t start, zip_int64_t length
     ctx->source_archive = source_archive;
     ctx->source_index = source_index;
     zip_error_init(&ctx->error);
-    ctx->supports = (zip_source_supports(src) & (ZIP_SOURCE_SUPPORTS_SEEKABLE | ZIP_SOURCE_SUPPORTS_REOPEN)) | (zip_source_make_command_bitmap(ZIP_SOURCE_GET_FILE_ATTRIBUTES, ZIP_SOURCE_SUPPORTS, ZIP_SOURCE_TELL, -1));
+    ctx->supports = (zip_source_supports(src) & (ZIP_SOURCE_SUPPORTS_SEEKABLE | ZIP_SOURCE_SUPPORTS_REOPEN | zip_source_make_command_bitmap(ZIP_SOURCE_READ_AT, ZIP_SOURCE_GET_DATA, ZIP_SOURCE_ADVISE, -1))) | (zip_source_make_command_bitmap(ZIP_SOURCE_GET_FILE_ATTRIBUTES, ZIP_SOURCE_SUPPORTS, ZIP_SOURCE_TELL, -1));
     ctx->needs_seek = (ctx->supports & ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_SEEK)) ? true : false;
 
     if (st) {
@@ -112,8 +114,20 @@ _zip_source_window_new(zip_source_t *src, zip_uint64_t start, zip_int64_t length
             return NULL;
         }
     }
-    
-    return zip_source_layered_create(src, window_read, ctx, error);
+
+    if ((s2 = zip_source_layered_create(src, window_read, ctx, error)) == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    s2->memory_usage = window_memory_usage;
+
+    return s2;
+}
+
+
+static zip_uint64_t
+window_memory_usage(void *_ctx) {
+    return sizeof(struct window);
 }
 
 
@@ -168,6 +182,10 @@ window_read(zip_source_t *src, void *_ctx, void *data, zip_uint64_t len, zip_sou
             }
             ctx->start += offset;
             ctx->end += offset;
+        }
+
+        if (ctx->source_archive) {
+            _zip_readahead(ctx->source_archive, ctx->source_index, ctx->start, ctx->end_valid ? ctx->end - ctx->start : 0);
             ctx->source_archive = NULL;
         }
 
@@ -208,16 +226,26 @@ window_read(zip_source_t *src, void *_ctx, void *data, zip_uint64_t len, zip_sou
             return 0;
         }
 
-        if (ctx->needs_seek) {
-            if (zip_source_seek(src, (zip_int64_t)ctx->offset, SEEK_SET) < 0) {
+        /* Reading at offset doesn't move the position of src, so
+           windows sharing src don't have to seek before each read. */
+        if (ctx->supports & ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_READ_AT)) {
+            if ((ret = zip_source_read_at(src, data, len, ctx->offset)) < 0) {
                 zip_error_set_from_source(&ctx->error, src);
                 return -1;
             }
         }
+        else {
+            if (ctx->needs_seek) {
+                if (zip_source_seek(src, (zip_int64_t)ctx->offset, SEEK_SET) < 0) {
+                    zip_error_set_from_source(&ctx->error, src);
+                    return -1;
+                }
+            }
 
-        if ((ret = zip_source_read(src, data, len)) < 0) {
-            zip_error_set(&ctx->error, ZIP_ER_EOF, 0);
-            return -1;
+            if ((ret = zip_source_read(src, data, len)) < 0) {
+                zip_error_set(&ctx->error, ZIP_ER_EOF, 0);
+                return -1;
+            }
         }
 
         ctx->offset += (zip_uint64_t)ret;
@@ -230,6 +258,75 @@ window_read(zip_source_t *src, void *_ctx, void *data, zip_uint64_t len, zip_sou
         }
         return ret;
 
+    case ZIP_SOURCE_ADVISE: {
+        zip_source_args_advise_t *args = ZIP_SOURCE_GET_ARGS(zip_source_args_advise_t, data, len, &ctx->error);
+        zip_uint64_t length;
+
+        if (args == NULL) {
+            return -1;
+        }
+        if (args->offset > ZIP_UINT64_MAX - ctx->start) {
+            return 0;
+        }
+
+        length = args->length;
+        if (ctx->end_valid) {
+            if (args->offset >= ctx->end - ctx->start) {
+                return 0;
+            }
+            length = ZIP_MIN(length, ctx->end - ctx->start - args->offset);
+        }
+
+        _zip_source_advise(src, ctx->start + args->offset, length, args->advice);
+        return 0;
+    }
+
+    case ZIP_SOURCE_GET_DATA: {
+        zip_source_args_get_data_t *args = ZIP_SOURCE_GET_ARGS(zip_source_args_get_data_t, data, len, &ctx->error);
+        const zip_uint8_t *window_data;
+
+        if (args == NULL) {
+            return -1;
+        }
+        if (args->offset > ZIP_UINT64_MAX - ctx->start || (ctx->end_valid && (args->offset > ctx->end - ctx->start || args->length > ctx->end - ctx->start - args->offset))) {
+            zip_error_set(&ctx->error, ZIP_ER_EOF, 0);
+            return -1;
+        }
+
+        if ((window_data = _zip_source_get_data(src, ctx->start + args->offset, args->length, &ctx->error)) == NULL) {
+            return -1;
+        }
+        args->data = window_data;
+        return 0;
+    }
+
+    case ZIP_SOURCE_READ_AT: {
+        zip_source_args_read_at_t *args = ZIP_SOURCE_GET_ARGS(zip_source_args_read_at_t, data, len, &ctx->error);
+        zip_uint64_t length;
+
+        if (args == NULL) {
+            return -1;
+        }
+        if (args->offset > ZIP_UINT64_MAX - ctx->start) {
+            zip_error_set(&ctx->error, ZIP_ER_INVAL, 0);
+            return -1;
+        }
+
+        length = args->length;
+        if (ctx->end_valid) {
+            if (args->offset >= ctx->end - ctx->start) {
+                return 0;
+            }
+            length = ZIP_MIN(length, ctx->end - ctx->start - args->offset);
+        }
+
+        if ((ret = zip_source_read_at(src, args->data, length, ctx->start + args->offset)) < 0) {
+            zip_error_set_from_source(&ctx->error, src);
+            return -1;
+        }
+        return ret;
+    }
+
     case ZIP_SOURCE_SEEK: {
         zip_int64_t new_offset;
         
@@ -268,7 +268,19 @@ zip_source_t *_zip_source_zip_new(zip_t *srcza, zip_uint64_t srcidx, zip_flags_t
         src = s2;
     }
     if (needs_decompress) {
-        s2 = zip_source_decompress(srcza, src, st.comp_method);
+        if (!changed_data && !needs_decrypt && have_size && _zip_checkpoints_usable(srcza, srcidx, st.comp_method, src)) {
+            /* seekable, so partial reads below don't decompress everything before start */
+            s2 = _zip_source_checkpoint_inflate_new(srcza, srcidx, src, error);
+        }
+#if defined(HAVE_LIBZSTD)
+        else if (!changed_data && !needs_decrypt && have_size && st.comp_method == ZIP_CM_ZSTD) {
+            /* seekable if data has a seek table */
+            s2 = _zip_source_zstd_decompress(srcza, src, st.size, error);
+        }
+#endif
+        else {
+            s2 = zip_source_decompress(srcza, src, st.comp_method);
+        }
         zip_source_free(src);
         if (s2 == NULL) {
             return NULL;
@@ -0,0 +1,404 @@
+/*
+  zip_source_zstd_seekable.c -- decompress zstd data using its seek table
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <stdlib.h>
+#include <zstd.h>
+
+#include "zipint.h"
+
+/* Data written in the zstd seekable format consists of independent
+   frames, followed by a skippable frame containing the compressed and
+   uncompressed size of each frame.  Using this seek table,
+   decompression can restart at the frame containing the requested
+   offset instead of at the start of the data.
+
+   The seek table is only looked for on the first seek, so reading
+   sequentially costs nothing extra. */
+
+/* smaller data is cheap to decompress from the start, and keeps using pooled decompression contexts */
+#define SEEKABLE_MIN_SIZE (16 * 1024)
+
+struct context {
+    bool seek_table_read;
+    zip_uint64_t nframes;      /* 0 if data has no seek table */
+    zip_uint64_t *in_offsets;  /* offset of frames in compressed data, nframes + 1 entries */
+    zip_uint64_t *out_offsets; /* offset of frames in uncompressed data, nframes + 1 entries */
+
+    zip_uint64_t in_offset; /* offset in compressed data of end of buffer */
+    bool end_of_input;
+
+    ZSTD_DStream *zdstream;
+    ZSTD_inBuffer in;
+    zip_uint8_t buffer[BUFSIZE];
+};
+
+static zip_uint64_t find_frame(struct context *ctx, zip_uint64_t offset);
+static int read_seek_table(zip_source_t *src, struct context *ctx, zip_error_t *error);
+static bool restart_at(zip_source_t *src, struct context *ctx, zip_uint64_t in_offset, zip_error_t *error);
+static zip_int64_t zstd_seekable_decompress(void *ud, zip_source_t *src, zip_uint64_t out_offset, zip_uint8_t *data, zip_uint64_t length, zip_error_t *error);
+static bool zstd_seekable_end(void *ud, zip_error_t *error);
+static void zstd_seekable_free(void *ud);
+static zip_uint64_t zstd_seekable_memory_usage(void *ud);
+static bool zstd_seekable_restart(void *ud, zip_source_t *src, zip_uint64_t offset, zip_uint64_t *out_offset, zip_error_t *error);
+static bool zstd_seekable_start(void *ud, zip_source_t *src, zip_error_t *error);
+
+static const zip_restartable_decompressor_t zstd_seekable_decompressor = {
+    zstd_seekable_start,
+    zstd_seekable_decompress,
+    zstd_seekable_restart,
+    zstd_seekable_end,
+    zstd_seekable_memory_usage,
+    zstd_seekable_free
+};
+
+
+/* decompress zstd data of uncompressed size size from src, using its seek table if it has one */
+zip_source_t *
+_zip_source_zstd_decompress(zip_t *za, zip_source_t *src, zip_uint64_t size, zip_error_t *error) {
+    struct context *ctx;
+
+    /* jumping to a frame needs to seek in the compressed data */
+    if (size < SEEKABLE_MIN_SIZE || !ZIP_SOURCE_CHECK_SUPPORTED(zip_source_supports(src), ZIP_SOURCE_SEEK)) {
+        return zip_source_decompress(za, src, ZIP_CM_ZSTD);
+    }
+
+    if ((ctx = (struct context *)malloc(sizeof(*ctx))) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    ctx->seek_table_read = false;
+    ctx->nframes = 0;
+    ctx->in_offsets = NULL;
+    ctx->out_offsets = NULL;
+    ctx->zdstream = NULL;
+
+    return _zip_source_restartable_new(src, &zstd_seekable_decompressor, ctx, error);
+}
+
+
+/* index of frame containing offset in uncompressed data */
+static zip_uint64_t
+find_frame(struct context *ctx, zip_uint64_t offset) {
+    zip_uint64_t low, high;
+
+    low = 0;
+    high = ctx->nframes;
+    while (low < high) {
+        zip_uint64_t mid = low + (high - low) / 2;
+
+        if (ctx->out_offsets[mid] <= offset) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low > 0 ? low - 1 : 0;
+}
+
+
+/* read seek table from end of open src, returns 1 if found, 0 if data has none, -1 on error; moves read position of src */
+static int
+read_seek_table(zip_source_t *src, struct context *ctx, zip_error_t *error) {
+    zip_stat_t st;
+    zip_buffer_t *buffer;
+    zip_uint8_t footer[ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE];
+    zip_uint64_t nframes, entry_size, table_size, i;
+    zip_uint64_t *in_offsets, *out_offsets;
+    zip_uint8_t descriptor;
+    zip_uint32_t magic;
+
+    if (zip_source_stat(src, &st) < 0) {
+        zip_error_set_from_source(error, src);
+        return -1;
+    }
+    if ((st.valid & ZIP_STAT_COMP_SIZE) == 0 || (st.valid & ZIP_STAT_SIZE) == 0 || st.comp_size < 8 + ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE || st.comp_size > ZIP_INT64_MAX) {
+        return 0;
+    }
+
+    if (zip_source_seek(src, (zip_int64_t)(st.comp_size - ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE), SEEK_SET) < 0) {
+        zip_error_set_from_source(error, src);
+        return -1;
+    }
+    if ((buffer = _zip_buffer_new_from_source(src, sizeof(footer), footer, error)) == NULL) {
+        return -1;
+    }
+    nframes = _zip_buffer_get_32(buffer);
+    descriptor = _zip_buffer_get_8(buffer);
+    magic = _zip_buffer_get_32(buffer);
+    _zip_buffer_free(buffer);
+
+    /* bit 7: entries include checksum, bits 2-6: reserved */
+    entry_size = ZIP_ZSTD_SEEK_TABLE_ENTRY_SIZE + ((descriptor & 0x80) ? 4 : 0);
+    table_size = 8 + nframes * entry_size + ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE;
+    if (magic != ZIP_ZSTD_SEEKABLE_MAGIC || (descriptor & 0x7c) != 0 || nframes == 0 || table_size > st.comp_size) {
+        return 0;
+    }
+
+    if (zip_source_seek(src, (zip_int64_t)(st.comp_size - table_size), SEEK_SET) < 0) {
+        zip_error_set_from_source(error, src);
+        return -1;
+    }
+    if ((buffer = _zip_buffer_new_from_source(src, table_size - ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE, NULL, error)) == NULL) {
+        return -1;
+    }
+
+    if (_zip_buffer_get_32(buffer) != ZIP_ZSTD_SKIPPABLE_MAGIC || _zip_buffer_get_32(buffer) != table_size - 8) {
+        _zip_buffer_free(buffer);
+        return 0;
+    }
+
+    if (nframes + 1 > SIZE_MAX / sizeof(in_offsets[0]) || (in_offsets = (zip_uint64_t *)malloc((size_t)(nframes + 1) * sizeof(in_offsets[0]))) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        _zip_buffer_free(buffer);
+        return -1;
+    }
+    if ((out_offsets = (zip_uint64_t *)malloc((size_t)(nframes + 1) * sizeof(out_offsets[0]))) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        free(in_offsets);
+        _zip_buffer_free(buffer);
+        return -1;
+    }
+
+    in_offsets[0] = 0;
+    out_offsets[0] = 0;
+    for (i = 0; i < nframes; i++) {
+        in_offsets[i + 1] = in_offsets[i] + _zip_buffer_get_32(buffer);
+        out_offsets[i + 1] = out_offsets[i] + _zip_buffer_get_32(buffer);
+        if (descriptor & 0x80) {
+            (void)_zip_buffer_get_32(buffer);
+        }
+    }
+    _zip_buffer_free(buffer);
+
+    /* frames must cover data exactly */
+    if (in_offsets[nframes] != st.comp_size - table_size || out_offsets[nframes] != st.size) {
+        free(in_offsets);
+        free(out_offsets);
+        return 0;
+    }
+
+    ctx->nframes = nframes;
+    ctx->in_offsets = in_offsets;
+    ctx->out_offsets = out_offsets;
+
+    return 1;
+}
+
+
+/* restart decompression at frame starting at in_offset in compressed data */
+static bool
+restart_at(zip_source_t *src, struct context *ctx, zip_uint64_t in_offset, zip_error_t *error) {
+    if (in_offset > ZIP_INT64_MAX || zip_source_seek(src, (zip_int64_t)in_offset, SEEK_SET) < 0) {
+        zip_error_set_from_source(error, src);
+        return false;
+    }
+    if (ZSTD_isError(ZSTD_initDStream(ctx->zdstream))) {
+        zip_error_set(error, ZIP_ER_INTERNAL, 0);
+        return false;
+    }
+    ctx->in.src = NULL;
+    ctx->in.size = 0;
+    ctx->in.pos = 0;
+    ctx->in_offset = in_offset;
+    ctx->end_of_input = false;
+
+    return true;
+}
+
+
+/* decompress up to length bytes at out_offset */
+static zip_int64_t
+zstd_seekable_decompress(void *ud, zip_source_t *src, zip_uint64_t out_offset, zip_uint8_t *data, zip_uint64_t length, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+    zip_uint64_t done;
+    ZSTD_outBuffer out;
+    zip_int64_t n;
+    size_t ret;
+
+    done = 0;
+    while (done < length) {
+        size_t in_pos;
+
+        if (ctx->in.pos == ctx->in.size && !ctx->end_of_input) {
+            zip_uint64_t want = sizeof(ctx->buffer);
+
+            /* without seek table, zstd skips it like any skippable frame */
+            if (ctx->nframes > 0) {
+                want = ZIP_MIN(want, ctx->in_offsets[ctx->nframes] - ctx->in_offset);
+            }
+            if (want == 0) {
+                n = 0;
+            }
+            else if ((n = zip_source_read(src, ctx->buffer, want)) < 0) {
+                zip_error_set_from_source(error, src);
+                return -1;
+            }
+            if (n == 0) {
+                ctx->end_of_input = true;
+            }
+            ctx->in_offset += (zip_uint64_t)n;
+            ctx->in.src = ctx->buffer;
+            ctx->in.size = (size_t)n;
+            ctx->in.pos = 0;
+        }
+
+        out.dst = data + done;
+        out.size = (size_t)ZIP_MIN(SIZE_MAX, length - done);
+        out.pos = 0;
+        in_pos = ctx->in.pos;
+
+        ret = ZSTD_decompressStream(ctx->zdstream, &out, &ctx->in);
+        if (ZSTD_isError(ret)) {
+            zip_error_set(error, ZIP_ER_COMPRESSED_DATA, 0);
+            return -1;
+        }
+
+        done += out.pos;
+
+        if (out.pos == 0 && ctx->in.pos == in_pos && ctx->end_of_input) {
+            /* end of data */
+            break;
+        }
+    }
+
+    return (zip_int64_t)done;
+}
+
+
+static bool
+zstd_seekable_end(void *ud, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+
+    ZSTD_freeDStream(ctx->zdstream);
+    ctx->zdstream = NULL;
+    return true;
+}
+
+
+static void
+zstd_seekable_free(void *ud) {
+    struct context *ctx = (struct context *)ud;
+
+    if (ctx == NULL) {
+        return;
+    }
+
+    if (ctx->zdstream != NULL) {
+        ZSTD_freeDStream(ctx->zdstream);
+    }
+    free(ctx->in_offsets);
+    free(ctx->out_offsets);
+    free(ctx);
+}
+
+
+static zip_uint64_t
+zstd_seekable_memory_usage(void *ud) {
+    struct context *ctx = (struct context *)ud;
+    zip_uint64_t usage = sizeof(*ctx);
+
+    if (ctx->nframes > 0) {
+        usage += 2 * (ctx->nframes + 1) * sizeof(ctx->in_offsets[0]);
+    }
+#if ZSTD_VERSION_NUMBER >= 10400
+    if (ctx->zdstream) {
+        usage += ZSTD_sizeof_DStream(ctx->zdstream);
+    }
+#endif
+
+    return usage;
+}
+
+
+/* restart at the frame containing offset if that is faster than continuing from out_offset */
+static bool
+zstd_seekable_restart(void *ud, zip_source_t *src, zip_uint64_t offset, zip_uint64_t *out_offset, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+    zip_uint64_t frame;
+    bool moved = false;
+
+    if (!ctx->seek_table_read) {
+        if (read_seek_table(src, ctx, error) < 0) {
+            return false;
+        }
+        ctx->seek_table_read = true;
+        moved = true;
+    }
+
+    if (ctx->nframes == 0) {
+        if (offset < *out_offset) {
+            *out_offset = 0;
+            return restart_at(src, ctx, 0, error);
+        }
+    }
+    else {
+        frame = find_frame(ctx, offset);
+        if (offset < *out_offset || ctx->out_offsets[frame] > *out_offset) {
+            *out_offset = ctx->out_offsets[frame];
+            return restart_at(src, ctx, ctx->in_offsets[frame], error);
+        }
+    }
+
+    /* continue where reading the seek table interrupted us */
+    if (moved && (ctx->in_offset > ZIP_INT64_MAX || zip_source_seek(src, (zip_int64_t)ctx->in_offset, SEEK_SET) < 0)) {
+        zip_error_set_from_source(error, src);
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool
+zstd_seekable_start(void *ud, zip_source_t *src, zip_error_t *error) {
+    struct context *ctx = (struct context *)ud;
+
+    if ((ctx->zdstream = ZSTD_createDStream()) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return false;
+    }
+    if (ZSTD_isError(ZSTD_initDStream(ctx->zdstream))) {
+        zip_error_set(error, ZIP_ER_INTERNAL, 0);
+        return false;
+    }
+    ctx->in_offset = 0;
+    ctx->end_of_input = false;
+    ctx->in.src = NULL;
+    ctx->in.size = 0;
+    ctx->in.pos = 0;
+
+    return true;
+}
@@ -0,0 +1,726 @@
+/*
+  zip_stream.c -- read archives sequentially from non-seekable sources
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zipint.h"
+
+#define STREAM_BUFFER_SIZE 65536
+/* signature, CRC, and 64 bit sizes of data descriptor, and signature of following record */
+#define DESCRIPTOR_LOOKAHEAD 28
+
+/* Entries are read in the order of their local headers, which are
+   the only metadata available before the central directory.  If an
+   entry's sizes are only given in a data descriptor after its data,
+   the end of the data is found by looking for a data descriptor whose
+   compressed size matches the amount of data before it and that is
+   followed by another header. */
+
+typedef struct zip_stream_file zip_stream_file_t;
+
+struct zip_stream {
+    zip_t *za; /* for error, password, time conversion, and creating layered sources */
+    zip_source_t *src;
+
+    zip_uint8_t *buffer;
+    zip_uint64_t buffer_size;
+    zip_uint64_t start; /* unconsumed data is buffer[start, end) */
+    zip_uint64_t end;
+    bool eof;  /* src has no more data */
+    bool done; /* central directory reached */
+
+    zip_uint64_t nentry; /* number of entries read */
+    zip_dirent_t *de;    /* current entry, NULL if none */
+    zip_stat_t st;
+    bool data_descriptor; /* size of data unknown, ends with data descriptor */
+    bool zip64;           /* data descriptor probably uses 64 bit sizes */
+    bool opened;          /* zip_stream_fopen was called for entry */
+    bool data_end;        /* all data of entry consumed */
+    zip_uint64_t data_read;  /* bytes of entry data consumed */
+    zip_uint64_t scanned;    /* no data descriptor starts before this offset in entry data */
+    zip_stream_file_t *file; /* source reading entry data, NULL if none */
+};
+
+struct zip_stream_file {
+    zip_stream_t *stream; /* NULL once stream moved on to next entry */
+    zip_error_t error;
+};
+
+typedef struct {
+    zip_uint64_t length;
+    zip_uint32_t crc;
+    zip_uint64_t comp_size;
+    zip_uint64_t size;
+} zip_stream_descriptor_t;
+
+
+/* Make at least length bytes available in buffer, unless source ends before. */
+
+static bool
+stream_fill(zip_stream_t *zs, zip_uint64_t length) {
+    zip_uint64_t available = zs->end - zs->start;
+    zip_int64_t n;
+
+    if (available >= length || zs->eof) {
+        return true;
+    }
+
+    if (zs->buffer_size - zs->start < length) {
+        if (zs->buffer_size < length) {
+            zip_uint8_t *buffer;
+
+            if (length > SIZE_MAX || (buffer = (zip_uint8_t *)malloc((size_t)length)) == NULL) {
+                zip_error_set(&zs->za->error, ZIP_ER_MEMORY, 0);
+                return false;
+            }
+            (void)memcpy_s(buffer, (size_t)length, zs->buffer + zs->start, (size_t)available);
+            free(zs->buffer);
+            zs->buffer = buffer;
+            zs->buffer_size = length;
+        }
+        else {
+            memmove(zs->buffer, zs->buffer + zs->start, (size_t)available);
+        }
+        zs->start = 0;
+        zs->end = available;
+    }
+
+    if ((n = zip_source_read(zs->src, zs->buffer + zs->end, length - available)) < 0) {
+        zip_error_set_from_source(&zs->za->error, zs->src);
+        return false;
+    }
+    if ((zip_uint64_t)n < length - available) {
+        zs->eof = true;
+    }
+    zs->end += (zip_uint64_t)n;
+
+    return true;
+}
+
+
+static bool
+is_record_magic(const zip_uint8_t *data) {
+    return memcmp(data, LOCAL_MAGIC, 4) == 0 || memcmp(data, CENTRAL_MAGIC, 4) == 0 || memcmp(data, EOCD_MAGIC, 4) == 0 || memcmp(data, EOCD64_MAGIC, 4) == 0;
+}
+
+
+/* Check for data descriptor at position in buffer, after offset bytes of entry data.
+   Caller ensures DESCRIPTOR_LOOKAHEAD bytes are available unless at end of source. */
+
+static bool
+descriptor_check(const zip_stream_t *zs, zip_uint64_t position, zip_uint64_t offset, zip_stream_descriptor_t *descriptor) {
+    zip_uint64_t available = zs->end - position;
+    unsigned int i;
+
+    for (i = 0; i < 4; i++) {
+        bool signature = i < 2;
+        bool zip64 = (i % 2 == 0) == zs->zip64;
+        zip_uint64_t length = (signature ? 4 : 0) + 4 + (zip64 ? 16 : 8);
+        zip_buffer_t *buffer;
+        bool ok;
+
+        if (available < length || (available < length + 4 && available != length)) {
+            continue;
+        }
+        if (signature && memcmp(zs->buffer + position, DATADES_MAGIC, 4) != 0) {
+            continue;
+        }
+        if (available >= length + 4 && !is_record_magic(zs->buffer + position + length)) {
+            continue;
+        }
+
+        if ((buffer = _zip_buffer_new(zs->buffer + position + (signature ? 4 : 0), length - (signature ? 4 : 0))) == NULL) {
+            return false;
+        }
+        descriptor->crc = _zip_buffer_get_32(buffer);
+        if (zip64) {
+            descriptor->comp_size = _zip_buffer_get_64(buffer);
+            descriptor->size = _zip_buffer_get_64(buffer);
+        }
+        else {
+            descriptor->comp_size = _zip_buffer_get_32(buffer);
+            descriptor->size = _zip_buffer_get_32(buffer);
+        }
+        ok = _zip_buffer_ok(buffer) && descriptor->comp_size == offset;
+        _zip_buffer_free(buffer);
+
+        if (ok) {
+            descriptor->length = length;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/* Return number of bytes of entry data available in buffer before data descriptor.
+   If the data descriptor is next, it is consumed and 0 is returned. */
+
+static zip_int64_t
+stream_scan_descriptor(zip_stream_t *zs) {
+    for (;;) {
+        zip_stream_descriptor_t descriptor;
+        zip_uint64_t available, limit, position;
+        bool found;
+
+        if (!stream_fill(zs, DESCRIPTOR_LOOKAHEAD + BUFSIZE)) {
+            return -1;
+        }
+        available = zs->end - zs->start;
+        limit = zs->eof ? available : available - DESCRIPTOR_LOOKAHEAD;
+
+        found = false;
+        for (position = zs->scanned - zs->data_read; position < limit; position++) {
+            if (descriptor_check(zs, zs->start + position, zs->data_read + position, &descriptor)) {
+                found = true;
+                break;
+            }
+        }
+        zs->scanned = zs->data_read + position;
+
+        if (found && position == 0) {
+            zs->start += descriptor.length;
+            zs->st.comp_size = descriptor.comp_size;
+            zs->st.size = descriptor.size;
+            zs->st.valid |= ZIP_STAT_COMP_SIZE | ZIP_STAT_SIZE;
+            if (zs->de->crc_valid) {
+                zs->st.crc = descriptor.crc;
+                zs->st.valid |= ZIP_STAT_CRC;
+            }
+            zs->data_end = true;
+            return 0;
+        }
+        if (position > 0) {
+            return (zip_int64_t)position;
+        }
+        if (zs->eof) {
+            zip_error_set(&zs->za->error, ZIP_ER_EOF, 0);
+            return -1;
+        }
+    }
+}
+
+
+/* Read up to len bytes of entry data into data, or skip them if data is NULL. */
+
+static zip_int64_t
+stream_read_data(zip_stream_t *zs, zip_uint8_t *data, zip_uint64_t len) {
+    zip_uint64_t n;
+
+    if (zs->data_end || len == 0) {
+        return 0;
+    }
+
+    if (zs->data_descriptor) {
+        zip_int64_t available;
+
+        if ((available = stream_scan_descriptor(zs)) <= 0) {
+            return available;
+        }
+        n = ZIP_MIN(len, (zip_uint64_t)available);
+    }
+    else {
+        zip_uint64_t remaining = zs->st.comp_size - zs->data_read;
+
+        if (remaining == 0) {
+            zs->data_end = true;
+            return 0;
+        }
+        n = ZIP_MIN(len, remaining);
+
+        if (zs->end == zs->start) {
+            if (data != NULL && n >= STREAM_BUFFER_SIZE) {
+                /* large read, bypass buffer */
+                zip_int64_t ret;
+
+                if ((ret = zip_source_read(zs->src, data, n)) < 0) {
+                    zip_error_set_from_source(&zs->za->error, zs->src);
+                    return -1;
+                }
+                if (ret == 0) {
+                    zs->eof = true;
+                    zip_error_set(&zs->za->error, ZIP_ER_EOF, 0);
+                    return -1;
+                }
+                zs->data_read += (zip_uint64_t)ret;
+                return ret;
+            }
+
+            if (!stream_fill(zs, ZIP_MIN(n, STREAM_BUFFER_SIZE))) {
+                return -1;
+            }
+            if (zs->end == zs->start) {
+                zip_error_set(&zs->za->error, ZIP_ER_EOF, 0);
+                return -1;
+            }
+        }
+        n = ZIP_MIN(n, zs->end - zs->start);
+    }
+
+    if (data != NULL) {
+        (void)memcpy_s(data, (size_t)n, zs->buffer + zs->start, (size_t)n);
+    }
+    zs->start += n;
+    zs->data_read += n;
+
+    return (zip_int64_t)n;
+}
+
+
+static void
+stream_detach_file(zip_stream_t *zs) {
+    if (zs->file != NULL) {
+        zs->file->stream = NULL;
+        zs->file = NULL;
+    }
+}
+
+
+/* Skip rest of current entry. */
+
+static bool
+stream_skip_entry(zip_stream_t *zs) {
+    zip_int64_t n;
+
+    stream_detach_file(zs);
+
+    while ((n = stream_read_data(zs, NULL, ZIP_INT64_MAX)) > 0) {
+    }
+    if (n < 0) {
+        return false;
+    }
+
+    _zip_dirent_free(zs->de);
+    zs->de = NULL;
+
+    return true;
+}
+
+
+/* Check whether local extra fields contain a Zip64 field, which the dirent doesn't keep. */
+
+static bool
+has_zip64_extra_field(const zip_uint8_t *data, zip_uint16_t length) {
+    zip_uint32_t offset;
+
+    for (offset = 0; offset + 4 <= length; offset += 4 + (zip_uint32_t)(data[offset + 2] | (data[offset + 3] << 8))) {
+        if ((data[offset] | (data[offset + 1] << 8)) == ZIP_EF_ZIP64) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/* Read next local header; returns 1 if one was read, 0 at end of archive. */
+
+static int
+stream_read_header(zip_stream_t *zs) {
+    zip_uint16_t filename_length, ef_length;
+    zip_buffer_t *buffer;
+    zip_uint64_t size;
+    zip_int64_t n;
+
+    for (;;) {
+        if (!stream_fill(zs, 4)) {
+            return -1;
+        }
+        if (zs->end == zs->start) {
+            /* archive without central directory */
+            zs->done = true;
+            return 0;
+        }
+        if (zs->end - zs->start < 4) {
+            zip_error_set(&zs->za->error, ZIP_ER_EOF, 0);
+            return -1;
+        }
+        if (memcmp(zs->buffer + zs->start, LOCAL_MAGIC, 4) == 0) {
+            break;
+        }
+        if (zs->nentry == 0 && memcmp(zs->buffer + zs->start, DATADES_MAGIC, 4) == 0) {
+            /* marker of archive split into one segment */
+            zs->start += 4;
+            continue;
+        }
+        if (memcmp(zs->buffer + zs->start, CENTRAL_MAGIC, 4) == 0 || memcmp(zs->buffer + zs->start, EOCD_MAGIC, 4) == 0 || memcmp(zs->buffer + zs->start, EOCD64_MAGIC, 4) == 0) {
+            zs->done = true;
+            return 0;
+        }
+        zip_error_set(&zs->za->error, zs->nentry == 0 ? ZIP_ER_NOZIP : ZIP_ER_INCONS, 0);
+        return -1;
+    }
+
+    if (!stream_fill(zs, LENTRYSIZE)) {
+        return -1;
+    }
+    if (zs->end - zs->start < LENTRYSIZE) {
+        zip_error_set(&zs->za->error, ZIP_ER_EOF, 0);
+        return -1;
+    }
+    filename_length = (zip_uint16_t)(zs->buffer[zs->start + 26] | (zs->buffer[zs->start + 27] << 8));
+    ef_length = (zip_uint16_t)(zs->buffer[zs->start + 28] | (zs->buffer[zs->start + 29] << 8));
+    size = LENTRYSIZE + (zip_uint64_t)filename_length + ef_length;
+
+    if (!stream_fill(zs, size)) {
+        return -1;
+    }
+    if (zs->end - zs->start < size) {
+        zip_error_set(&zs->za->error, ZIP_ER_EOF, 0);
+        return -1;
+    }
+
+    if ((zs->de = _zip_dirent_new(NULL)) == NULL) {
+        zip_error_set(&zs->za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+    if ((buffer = _zip_buffer_new(zs->buffer + zs->start, size)) == NULL) {
+        zip_error_set(&zs->za->error, ZIP_ER_MEMORY, 0);
+        return -1;
+    }
+    n = _zip_dirent_read(zs->de, NULL, buffer, true, NULL, &zs->za->error);
+    _zip_buffer_free(buffer);
+    if (n < 0) {
+        return -1;
+    }
+
+    zs->zip64 = has_zip64_extra_field(zs->buffer + zs->start + LENTRYSIZE + filename_length, ef_length);
+    zs->start += size;
+
+    zs->data_descriptor = (zs->de->bitflags & ZIP_GPBF_DATA_DESCRIPTOR) != 0;
+    zs->opened = false;
+    zs->data_end = false;
+    zs->data_read = 0;
+    zs->scanned = 0;
+
+    zip_stat_init(&zs->st);
+    if ((zs->st.name = (const char *)_zip_string_get(zs->de->filename, NULL, 0, &zs->za->error)) == NULL) {
+        return -1;
+    }
+    zs->st.index = zs->nentry++;
+    zs->st.mtime = _zip_dirent_get_last_mod(zs->za, zs->de);
+    zs->st.comp_method = (zip_uint16_t)zs->de->comp_method;
+    zs->st.encryption_method = zs->de->encryption_method;
+    zs->st.valid = ZIP_STAT_NAME | ZIP_STAT_INDEX | ZIP_STAT_MTIME | ZIP_STAT_COMP_METHOD | ZIP_STAT_ENCRYPTION_METHOD;
+    if (!zs->data_descriptor) {
+        zs->st.size = zs->de->uncomp_size;
+        zs->st.comp_size = zs->de->comp_size;
+        zs->st.valid |= ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE;
+        if (zs->de->crc_valid) {
+            zs->st.crc = zs->de->crc;
+            zs->st.valid |= ZIP_STAT_CRC;
+        }
+    }
+
+    return 1;
+}
+
+
+static zip_int64_t
+stream_file_callback(void *ud, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
+    zip_stream_file_t *file = (zip_stream_file_t *)ud;
+    zip_stream_t *zs = file->stream;
+    zip_int64_t n;
+
+    switch (cmd) {
+    case ZIP_SOURCE_OPEN:
+    case ZIP_SOURCE_CLOSE:
+        return 0;
+
+    case ZIP_SOURCE_READ:
+        if (zs == NULL) {
+            zip_error_set(&file->error, ZIP_ER_CHANGED, 0);
+            return -1;
+        }
+        if ((n = stream_read_data(zs, (zip_uint8_t *)data, len)) < 0) {
+            _zip_error_copy(&file->error, &zs->za->error);
+            return -1;
+        }
+        return n;
+
+    case ZIP_SOURCE_STAT: {
+        zip_stat_t *st = (zip_stat_t *)data;
+
+        if (zs == NULL) {
+            zip_error_set(&file->error, ZIP_ER_CHANGED, 0);
+            return -1;
+        }
+        if (zs->data_descriptor && !zs->data_end) {
+            /* data descriptor may directly follow the data read so far */
+            if (stream_scan_descriptor(zs) < 0) {
+                _zip_error_copy(&file->error, &zs->za->error);
+                return -1;
+            }
+        }
+        *st = zs->st;
+        st->valid &= ~(ZIP_STAT_NAME | ZIP_STAT_INDEX);
+        return 0;
+    }
+
+    case ZIP_SOURCE_ERROR:
+        return zip_error_to_data(&file->error, data, len);
+
+    case ZIP_SOURCE_GET_FILE_ATTRIBUTES: {
+        zip_file_attributes_t *attributes = (zip_file_attributes_t *)data;
+
+        if (len < sizeof(*attributes)) {
+            zip_error_set(&file->error, ZIP_ER_INVAL, 0);
+            return -1;
+        }
+        if (zs == NULL) {
+            zip_error_set(&file->error, ZIP_ER_CHANGED, 0);
+            return -1;
+        }
+        /* decompressors need the flags from the local header, e.g. whether LZMA data has an end marker */
+        attributes->valid |= ZIP_FILE_ATTRIBUTES_VERSION_NEEDED | ZIP_FILE_ATTRIBUTES_GENERAL_PURPOSE_BIT_FLAGS;
+        attributes->version_needed = (zip_uint8_t)ZIP_MIN(zs->de->version_needed, ZIP_UINT8_MAX);
+        attributes->general_purpose_bit_flags = zs->de->bitflags;
+        attributes->general_purpose_bit_mask = ZIP_FILE_ATTRIBUTES_GENERAL_PURPOSE_BIT_FLAGS_ALLOWED_MASK;
+        return sizeof(*attributes);
+    }
+
+    case ZIP_SOURCE_FREE:
+        if (zs != NULL) {
+            zs->file = NULL;
+        }
+        zip_error_fini(&file->error);
+        free(file);
+        return 0;
+
+    case ZIP_SOURCE_SUPPORTS:
+        return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT, ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, ZIP_SOURCE_GET_FILE_ATTRIBUTES, -1);
+
+    default:
+        zip_error_set(&file->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+}
+
+
+ZIP_EXTERN void
+zip_stream_close(zip_stream_t *zs) {
+    if (zs == NULL) {
+        return;
+    }
+
+    stream_detach_file(zs);
+    _zip_dirent_free(zs->de);
+    zip_source_close(zs->src);
+    zip_source_free(zs->src);
+    zip_discard(zs->za);
+    free(zs->buffer);
+    free(zs);
+}
+
+
+ZIP_EXTERN zip_file_t *
+zip_stream_fopen(zip_stream_t *zs, zip_flags_t flags) {
+    zip_stream_file_t *file;
+    zip_source_t *src, *s2;
+    zip_file_t *zf;
+    bool encrypted, compressed, needs_crc;
+
+    if (zs->de == NULL || zs->opened) {
+        zip_error_set(&zs->za->error, ZIP_ER_INVAL, 0);
+        return NULL;
+    }
+
+    if (flags & ZIP_FL_ENCRYPTED) {
+        flags |= ZIP_FL_COMPRESSED;
+    }
+    encrypted = zs->st.encryption_method != ZIP_EM_NONE;
+    compressed = zs->st.comp_method != ZIP_CM_STORE;
+    needs_crc = (flags & ZIP_FL_COMPRESSED) == 0 || (!compressed && !encrypted);
+
+    if (encrypted && (flags & ZIP_FL_ENCRYPTED) == 0 && zs->za->default_password == NULL) {
+        zip_error_set(&zs->za->error, ZIP_ER_NOPASSWD, 0);
+        return NULL;
+    }
+
+    if ((file = (zip_stream_file_t *)malloc(sizeof(*file))) == NULL) {
+        zip_error_set(&zs->za->error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    file->stream = zs;
+    zip_error_init(&file->error);
+
+    if ((src = zip_source_function_create(stream_file_callback, file, &zs->za->error)) == NULL) {
+        zip_error_fini(&file->error);
+        free(file);
+        return NULL;
+    }
+    zs->file = file;
+    zs->opened = true;
+
+    /* creating a layered source calls zip_keep() on the lower layer, so we free it */
+
+    if (encrypted && (flags & ZIP_FL_ENCRYPTED) == 0) {
+        zip_encryption_implementation enc_impl;
+
+        if ((enc_impl = _zip_get_encryption_implementation(zs->st.encryption_method, ZIP_CODEC_DECODE)) == NULL) {
+            zip_error_set(&zs->za->error, ZIP_ER_ENCRNOTSUPP, 0);
+            zip_source_free(src);
+            return NULL;
+        }
+        s2 = enc_impl(zs->za, src, zs->st.encryption_method, 0, zs->za->default_password);
+        zip_source_free(src);
+        if (s2 == NULL) {
+            return NULL;
+        }
+        src = s2;
+    }
+    if (compressed && (flags & ZIP_FL_COMPRESSED) == 0) {
+        s2 = zip_source_decompress(zs->za, src, zs->st.comp_method);
+        zip_source_free(src);
+        if (s2 == NULL) {
+            return NULL;
+        }
+        src = s2;
+    }
+    if (needs_crc) {
+        s2 = zip_source_crc_create(src, 1, &zs->za->error);
+        zip_source_free(src);
+        if (s2 == NULL) {
+            return NULL;
+        }
+        src = s2;
+    }
+
+    if (zip_source_open(src) < 0) {
+        zip_error_set_from_source(&zs->za->error, src);
+        zip_source_free(src);
+        return NULL;
+    }
+
+    if ((zf = (zip_file_t *)malloc(sizeof(*zf))) == NULL) {
+        zip_error_set(&zs->za->error, ZIP_ER_MEMORY, 0);
+        zip_source_free(src);
+        return NULL;
+    }
+    zf->za = zs->za;
+    zip_error_init(&zf->error);
+    zf->src = src;
+
+    return zf;
+}
+
+
+ZIP_EXTERN zip_error_t *
+zip_stream_get_error(zip_stream_t *zs) {
+    return &zs->za->error;
+}
+
+
+ZIP_EXTERN int
+zip_stream_next(zip_stream_t *zs, zip_stat_t *st) {
+    int ret;
+
+    if (zs->de != NULL && !stream_skip_entry(zs)) {
+        return -1;
+    }
+    if (zs->done) {
+        return 0;
+    }
+
+    if ((ret = stream_read_header(zs)) <= 0) {
+        if (ret < 0) {
+            _zip_dirent_free(zs->de);
+            zs->de = NULL;
+        }
+        return ret;
+    }
+
+    if (st != NULL) {
+        *st = zs->st;
+    }
+    return 1;
+}
+
+
+ZIP_EXTERN zip_stream_t *
+zip_stream_open(zip_source_t *src, zip_error_t *error) {
+    zip_stream_t *zs;
+
+    if (src == NULL) {
+        zip_error_set(error, ZIP_ER_INVAL, 0);
+        return NULL;
+    }
+
+    if ((zs = (zip_stream_t *)malloc(sizeof(*zs))) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    if ((zs->buffer = (zip_uint8_t *)malloc(STREAM_BUFFER_SIZE)) == NULL) {
+        free(zs);
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    if ((zs->za = _zip_new(error)) == NULL) {
+        free(zs->buffer);
+        free(zs);
+        return NULL;
+    }
+
+    if (zip_source_open(src) < 0) {
+        zip_error_set_from_source(error, src);
+        zip_discard(zs->za);
+        free(zs->buffer);
+        free(zs);
+        return NULL;
+    }
+
+    zs->src = src;
+    zs->buffer_size = STREAM_BUFFER_SIZE;
+    zs->start = 0;
+    zs->end = 0;
+    zs->eof = false;
+    zs->done = false;
+    zs->nentry = 0;
+    zs->de = NULL;
+    zs->opened = false;
+    zs->data_end = false;
+    zs->data_read = 0;
+    zs->scanned = 0;
+    zs->file = NULL;
+    zip_stat_init(&zs->st);
+
+    return zs;
+}
+
+
+ZIP_EXTERN int
+zip_stream_set_default_password(zip_stream_t *zs, const char *password) {
+    return zip_set_default_password(zs->za, password);
+}
@@ -70,9 +70,11 @@ _zip_string_free(zip_string_t *s) {
     if (s == NULL)
         return;
 
-    free(s->raw);
     free(s->converted);
-    free(s);
+    if (!s->from_arena) {
+        free(s->raw);
+        free(s);
+    }
 }
 
 
@@ -119,6 +121,16 @@ _zip_string_length(const zip_string_t *s) {
 
 zip_string_t *
 _zip_string_new(const zip_uint8_t *raw, zip_uint16_t length, zip_flags_t flags, zip_error_t *error) {
+    return _zip_string_new_arena(raw, length, flags, NULL, error);
+}
+
+
+/* _zip_string_new_arena:
+   Like _zip_string_new, but if arena is non-NULL, allocates string
+   and raw data from it in one piece. */
+
+zip_string_t *
+_zip_string_new_arena(const zip_uint8_t *raw, zip_uint16_t length, zip_flags_t flags, zip_arena_t *arena, zip_error_t *error) {
     zip_string_t *s;
     zip_encoding_type_t expected_encoding;
 
@@ -140,14 +152,24 @@ _zip_string_new(const zip_uint8_t *raw, zip_uint16_t length, zip_flags_t flags,
         return NULL;
     }
 
-    if ((s = (zip_string_t *)malloc(sizeof(*s))) == NULL) {
-        zip_error_set(error, ZIP_ER_MEMORY, 0);
-        return NULL;
+    if (arena) {
+        if ((s = (zip_string_t *)_zip_arena_alloc(arena, sizeof(*s) + (size_t)length + 1, error)) == NULL) {
+            return NULL;
+        }
+        s->raw = (zip_uint8_t *)(s + 1);
+        s->from_arena = true;
     }
+    else {
+        if ((s = (zip_string_t *)malloc(sizeof(*s))) == NULL) {
+            zip_error_set(error, ZIP_ER_MEMORY, 0);
+            return NULL;
+        }
 
-    if ((s->raw = (zip_uint8_t *)malloc((size_t)length + 1)) == NULL) {
-        free(s);
-        return NULL;
+        if ((s->raw = (zip_uint8_t *)malloc((size_t)length + 1)) == NULL) {
+            free(s);
+            return NULL;
+        }
+        s->from_arena = false;
     }
 
     (void)memcpy_s(s->raw, length + 1, raw, length);
@@ -46,7 +46,7 @@ zip_unchange(zip_t *za, zip_uint64_t idx) {
 int
 _zip_unchange(zip_t *za, zip_uint64_t idx, int allow_duplicates) {
     zip_int64_t i;
-    bool renamed;
+    bool renamed, deleted;
 
     if (idx >= za->nentry) {
         zip_error_set(&za->error, ZIP_ER_INVAL, 0);
@@ -54,7 +54,8 @@ _zip_unchange(zip_t *za, zip_uint64_t idx, int allow_duplicates) {
     }
 
     renamed = za->entry[idx].changes && (za->entry[idx].changes->changed & ZIP_DIRENT_FILENAME);
-    if (!allow_duplicates && (renamed || za->entry[idx].deleted)) {
+    deleted = za->entry[idx].deleted;
+    if (!allow_duplicates && (renamed || deleted)) {
         const char *orig_name = NULL;
         const char *changed_name = NULL;
 
@@ -94,5 +95,10 @@ _zip_unchange(zip_t *za, zip_uint64_t idx, int allow_duplicates) {
 
     _zip_unchange_data(za->entry + idx);
 
+    if (renamed || deleted) {
+        _zip_name_index_update(za, idx);
+        _zip_dir_index_update(za, idx);
+    }
+
     return 0;
 }
@@ -43,6 +43,8 @@ zip_unchange_all(zip_t *za) {
     if (!_zip_hash_revert(za->names, &za->error)) {
         return -1;
     }
+    _zip_name_index_free(za);
+    _zip_dir_index_invalidate(za);
 
     ret = 0;
     for (i = 0; i < za->nentry; i++)
@@ -35,6 +35,16 @@
 #include "zipint.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZIP_UTF_8_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 
 static const zip_uint16_t _cp437_to_unicode[256] = {
@@ -95,6 +105,87 @@ static const zip_uint16_t _cp437_to_unicode[256] = {
 #define UTF_8_CONTINUE_MASK 0xc0
 #define UTF_8_CONTINUE_MATCH 0x80
 
+#define BYTES_ALL(b) (~(zip_uint64_t)0 / 0xff * (b))
+
+
+/* Return length of leading run of bytes in 0x20-0x7e.  These are
+   ASCII and map to themselves in CP437, and are by far the most
+   common bytes in file names, so they are checked a block at a time. */
+
+static zip_uint32_t
+_zip_printable_length(const zip_uint8_t *data, zip_uint32_t length) {
+    zip_uint32_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i low32 = _mm256_set1_epi8(0x1f);
+    const __m256i high32 = _mm256_set1_epi8(0x7f);
+
+    for (; length - i >= 32; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+
+        /* signed compare, so bytes >= 0x80 are below 0x1f */
+        if (_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi8(block, low32), _mm256_cmpgt_epi8(high32, block))) != -1) {
+            break;
+        }
+    }
+#endif
+#if defined(__AVX2__) || defined(ZIP_UTF_8_SSE2)
+    {
+        const __m128i low = _mm_set1_epi8(0x1f);
+        const __m128i high = _mm_set1_epi8(0x7f);
+
+        for (; length - i >= 16; i += 16) {
+            __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+
+            if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(block, low), _mm_cmplt_epi8(block, high))) != 0xffff) {
+                break;
+            }
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; length - i >= 16; i += 16) {
+        uint8x16_t block = vld1q_u8(data + i);
+
+        if (vminvq_u8(block) < 0x20 || vmaxvq_u8(block) > 0x7e) {
+            break;
+        }
+    }
+#else
+    for (; length - i >= 8; i += 8) {
+        zip_uint64_t word;
+
+        memcpy(&word, data + i, 8);
+        /* high bit set, below 0x20, or equal to 0x7f */
+        if (((word | ((word - BYTES_ALL(0x20)) & ~word) | ((word ^ BYTES_ALL(0x7f)) - BYTES_ALL(0x01))) & BYTES_ALL(0x80)) != 0) {
+            break;
+        }
+    }
+#endif
+
+    while (i < length && data[i] >= 0x20 && data[i] < 0x7f) {
+        i++;
+    }
+
+    return i;
+}
+
+
+/* Return length of leading run of bytes _zip_guess_encoding considers ASCII. */
+
+static zip_uint32_t
+_zip_ascii_length(const zip_uint8_t *data, zip_uint32_t length) {
+    zip_uint32_t i = 0;
+
+    while ((i += _zip_printable_length(data + i, length - i)) < length) {
+        if (data[i] != '\r' && data[i] != '\n' && data[i] != '\t' && data[i] != 0x7f) {
+            break;
+        }
+        i++;
+    }
+
+    return i;
+}
+
 
 zip_encoding_type_t
 _zip_guess_encoding(zip_string_t *str, zip_encoding_type_t expected_encoding) {
@@ -111,10 +202,7 @@ _zip_guess_encoding(zip_string_t *str, zip_encoding_type_t expected_encoding) {
         enc = str->encoding;
     else {
         enc = ZIP_ENCODING_ASCII;
-        for (i = 0; i < str->length; i++) {
-            if ((name[i] > 31 && name[i] < 128) || name[i] == '\r' || name[i] == '\n' || name[i] == '\t')
-                continue;
-
+        for (i = _zip_ascii_length(name, str->length); i < str->length; i += _zip_ascii_length(name + i, str->length - i)) {
             enc = ZIP_ENCODING_UTF8_GUESSED;
             if ((name[i] & UTF_8_LEN_2_MASK) == UTF_8_LEN_2_MATCH)
                 ulen = 1;
@@ -138,7 +226,7 @@ _zip_guess_encoding(zip_string_t *str, zip_encoding_type_t expected_encoding) {
                     goto done;
                 }
             }
-            i += ulen;
+            i += ulen + 1;
         }
     }
 
@@ -198,7 +286,7 @@ zip_uint8_t *
 _zip_cp437_to_utf8(const zip_uint8_t *const _cp437buf, zip_uint32_t len, zip_uint32_t *utf8_lenp, zip_error_t *error) {
     zip_uint8_t *cp437buf = (zip_uint8_t *)_cp437buf;
     zip_uint8_t *utf8buf;
-    zip_uint32_t buflen, i, offset;
+    zip_uint32_t ascii, buflen, i, offset;
 
     if (len == 0) {
         if (utf8_lenp)
@@ -206,8 +294,11 @@ _zip_cp437_to_utf8(const zip_uint8_t *const _cp437buf, zip_uint32_t len, zip_uin
         return NULL;
     }
 
-    buflen = 1;
-    for (i = 0; i < len; i++)
+    /* leading printable ASCII is copied unchanged */
+    ascii = _zip_printable_length(cp437buf, len);
+
+    buflen = ascii + 1;
+    for (i = ascii; i < len; i++)
         buflen += _zip_unicode_to_utf8_len(_cp437_to_unicode[cp437buf[i]]);
 
     if ((utf8buf = (zip_uint8_t *)malloc(buflen)) == NULL) {
@@ -215,8 +306,9 @@ _zip_cp437_to_utf8(const zip_uint8_t *const _cp437buf, zip_uint32_t len, zip_uin
         return NULL;
     }
 
-    offset = 0;
-    for (i = 0; i < len; i++)
+    memcpy(utf8buf, cp437buf, ascii);
+    offset = ascii;
+    for (i = ascii; i < len; i++)
         offset += _zip_unicode_to_utf8(_cp437_to_unicode[cp437buf[i]], utf8buf + offset);
 
     utf8buf[buflen - 1] = 0;
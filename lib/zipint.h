@@ -148,9 +148,35 @@ struct zip_compression_algorithm {
 
     /* process input data, writing to data, which has room for length bytes, update length to number of bytes written */
     zip_compression_status_t (*process)(void *ctx, zip_uint8_t *data, zip_uint64_t *length);
+
+    /* return memory allocated for context, including state of compression library */
+    zip_uint64_t (*memory_usage)(void *ctx);
 };
 typedef struct zip_compression_algorithm zip_compression_algorithm_t;
 
+/* decompressor that can restart in the middle of its data, see _zip_source_restartable_new */
+
+struct zip_restartable_decompressor {
+    /* start decompressing data read from src at its start */
+    bool (*start)(void *ud, zip_source_t *src, zip_error_t *error);
+
+    /* decompress up to length bytes at out_offset in uncompressed data, return 0 at end of data */
+    zip_int64_t (*decompress)(void *ud, zip_source_t *src, zip_uint64_t out_offset, zip_uint8_t *data, zip_uint64_t length, zip_error_t *error);
+
+    /* restart at or before offset if that is after *out_offset, must restart if offset is before it; update *out_offset */
+    bool (*restart)(void *ud, zip_source_t *src, zip_uint64_t offset, zip_uint64_t *out_offset, zip_error_t *error);
+
+    /* stop decompressing */
+    bool (*end)(void *ud, zip_error_t *error);
+
+    /* return memory allocated for ud, including state of compression library */
+    zip_uint64_t (*memory_usage)(void *ud);
+
+    /* free ud */
+    void (*free)(void *ud);
+};
+typedef struct zip_restartable_decompressor zip_restartable_decompressor_t;
+
 extern zip_compression_algorithm_t zip_algorithm_bzip2_compress;
 extern zip_compression_algorithm_t zip_algorithm_bzip2_decompress;
 extern zip_compression_algorithm_t zip_algorithm_deflate_compress;
@@ -262,15 +288,53 @@ typedef enum zip_encoding_type zip_encoding_type_t;
 struct zip_hash;
 struct zip_progress;
 
+typedef struct zip_arena zip_arena_t;
+typedef struct zip_arena_block zip_arena_block_t;
 typedef struct zip_cdir zip_cdir_t;
+typedef struct zip_checkpoint zip_checkpoint_t;
+typedef struct zip_checkpoints zip_checkpoints_t;
+typedef struct zip_compression_pool zip_compression_pool_t;
 typedef struct zip_dirent zip_dirent_t;
+typedef struct zip_dostime_cache zip_dostime_cache_t;
+typedef struct zip_dir_index zip_dir_index_t;
+typedef struct zip_dostime_cache_entry zip_dostime_cache_entry_t;
 typedef struct zip_entry zip_entry_t;
 typedef struct zip_extra_field zip_extra_field_t;
 typedef struct zip_string zip_string_t;
 typedef struct zip_buffer zip_buffer_t;
 typedef struct zip_hash zip_hash_t;
+typedef struct zip_lazy_cdir zip_lazy_cdir_t;
+typedef struct zip_name_index zip_name_index_t;
 typedef struct zip_progress zip_progress_t;
 
+typedef void (*zip_parallel_function_t)(void *ud, unsigned int index);
+
+/* minimum number of entries per thread when opening with ZIP_PARALLEL */
+#define ZIP_PARALLEL_MIN_ENTRIES 4096
+/* maximum number of threads returned by _zip_parallel_threads */
+#define ZIP_PARALLEL_MAX_THREADS 32
+
+/* bump allocator for data that lives as long as the archive */
+
+struct zip_arena {
+    zip_arena_block_t *block; /* block currently allocated from, head of list of all blocks */
+};
+
+/* UTC offsets of recently converted MS-DOS dates */
+
+#define ZIP_DOSTIME_CACHE_SIZE 16
+
+struct zip_dostime_cache_entry {
+    bool valid;          /* whether entry is in use */
+    bool transition;     /* whether UTC offset changes during day */
+    zip_uint16_t ddate;  /* MS-DOS date of day */
+    zip_int64_t offset;  /* local time minus UTC in seconds, unless transition */
+};
+
+struct zip_dostime_cache {
+    zip_dostime_cache_entry_t entry[ZIP_DOSTIME_CACHE_SIZE];
+};
+
 /* zip archive, part of API */
 
 struct zip {
@@ -296,6 +360,27 @@ struct zip {
     zip_source_t **open_source;      /* open sources using archive */
 
     zip_hash_t *names; /* hash table for name lookup */
+    zip_name_index_t *name_indexes; /* indexes for name lookup with flags, built on demand */
+    zip_dir_index_t *dir_index;     /* sorted names for zip_dir_list, built on demand */
+
+    zip_lazy_cdir_t *lazy_cdir; /* central directory entries not yet parsed (ZIP_LAZY) */
+    zip_source_t *index_src;    /* index central directory and name hash point into, if opened using one */
+
+    zip_uint64_t cdir_offset; /* offset of central directory in archive as opened */
+    zip_uint64_t cdir_size;   /* size of central directory in archive as opened */
+    zip_uint32_t cdir_crc;    /* CRC-32 of central directory, if cdir_crc_valid */
+    bool cdir_crc_valid;      /* whether cdir_crc was computed (only by zip_refresh) */
+
+    zip_arena_t arena; /* memory for unchanged directory entries */
+
+    zip_dostime_cache_t dostime_cache; /* for converting modification times */
+
+    zip_uint64_t checkpoint_interval; /* uncompressed bytes between checkpoints recorded while reading, 0 for none */
+
+    zip_uint64_t readahead;      /* bytes of data of following files to announce to source when opening a file, 0 for none */
+    zip_uint64_t readahead_next; /* index of first file not yet announced */
+
+    zip_compression_pool_t *decompression_pool; /* decompression contexts kept for reuse, or NULL */
 
     zip_progress_t *progress; /* progress callback for zip_close() */
 };
@@ -324,6 +409,7 @@ struct zip_dirent {
     zip_uint32_t changed;
     bool local_extra_fields_read; /*      whether we already read in local header extra fields */
     bool cloned;                  /*      whether this instance is cloned, and thus shares non-changed strings */
+    bool from_arena;              /*      whether this instance was allocated from archive's arena */
 
     bool crc_valid; /*      if CRC is valid (sometimes not for encrypted archives) */
 
@@ -331,7 +417,10 @@ struct zip_dirent {
     zip_uint16_t version_needed;     /* (cl) version needed to extract */
     zip_uint16_t bitflags;           /* (cl) general purpose bit flag */
     zip_int32_t comp_method;         /* (cl) compression method used (uint16 and ZIP_CM_DEFAULT (-1)) */
-    time_t last_mod;                 /* (cl) time of last modification */
+    time_t last_mod;                 /* (cl) time of last modification, if last_mod_valid */
+    bool last_mod_valid;             /*      whether last_mod was converted from dos_time and dos_date */
+    zip_uint16_t dos_time;           /* (cl) time of last modification as read from archive */
+    zip_uint16_t dos_date;           /* (cl) date of last modification as read from archive */
     zip_uint32_t crc;                /* (cl) CRC-32 of uncompressed data */
     zip_uint64_t comp_size;          /* (cl) size of compressed data */
     zip_uint64_t uncomp_size;        /* (cl) size of uncompressed data */
@@ -343,7 +432,7 @@ struct zip_dirent {
     zip_uint32_t ext_attrib;         /* (c)  external file attributes */
     zip_uint64_t offset;             /* (c)  offset of local header */
 
-    zip_uint16_t compression_level; /*      level of compression to use (never valid in orig) */
+    zip_uint32_t compression_level; /*      level of compression to use (never valid in orig) */
     zip_uint16_t encryption_method; /*      encryption method, computed from other fields */
     char *password;                 /*      file specific encryption password */
 };
@@ -359,6 +448,25 @@ struct zip_cdir {
     zip_uint64_t offset;   /* offset of central directory in file */
     zip_string_t *comment; /* zip archive comment */
     bool is_zip64;         /* central directory in zip64 format */
+    zip_uint32_t crc;      /* CRC-32 of central directory, if crc_valid */
+    bool crc_valid;
+
+    zip_lazy_cdir_t *lazy; /* raw entries, if parsing is deferred */
+};
+
+/* raw central directory, kept to parse entries on first use */
+
+struct zip_lazy_cdir {
+    zip_uint8_t *data;         /* central directory as read from archive */
+    zip_uint64_t size;         /* size of data */
+    zip_uint64_t nentry;       /* number of entries */
+    zip_uint64_t nentry_alloc; /* number of entries allocated */
+    zip_uint64_t *offset;      /* offset of each entry in data */
+    zip_uint8_t *names;        /* NUL-terminated file names for name hash */
+    zip_uint64_t names_size;   /* size of names */
+    zip_uint64_t names_used;   /* bytes used in names */
+    zip_arena_t *arena;        /* arena to allocate parsed entries from */
+    bool mapped;               /* data and offset point into index, not allocated */
 };
 
 struct zip_extra_field {
@@ -367,6 +475,7 @@ struct zip_extra_field {
     zip_uint16_t id;   /* header id */
     zip_uint16_t size; /* data size */
     zip_uint8_t *data;
+    bool from_arena; /* allocated from archive's arena */
 };
 
 enum zip_source_write_state {
@@ -394,11 +503,14 @@ struct zip_source {
     bool eof;                /* EOF reached */
     bool had_read_error;     /* a previous ZIP_SOURCE_READ reported an error */
     zip_uint64_t bytes_read; /* for sources that don't support ZIP_SOURCE_TELL. */
+    zip_uint64_t (*memory_usage)(void *ud); /* memory allocated for ud, NULL if unknown */
 };
 
 #define ZIP_SOURCE_IS_OPEN_READING(src) ((src)->open_count > 0)
 #define ZIP_SOURCE_IS_OPEN_WRITING(src) ((src)->write_state == ZIP_SOURCE_WRITE_OPEN)
 #define ZIP_SOURCE_IS_LAYERED(src) ((src)->src != NULL)
+/* commands accessing the data of the source directly, which a layered source transforming the data can't pass to the lower layer */
+#define ZIP_SOURCE_SUPPORTS_DIRECT_ACCESS (ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_READ_AT) | ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_GET_DATA) | ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_ADVISE))
 
 /* entry in zip archive directory */
 
@@ -406,10 +518,42 @@ struct zip_entry {
     zip_dirent_t *orig;
     zip_dirent_t *changes;
     zip_source_t *source;
+    zip_checkpoints_t *checkpoints; /* for reading original deflated data from the middle, or NULL */
     bool deleted;
 };
 
 
+/* shorter ranges are not announced to the archive source, the operating system reads that much anyway */
+#define ZIP_READAHEAD_MIN_SIZE (128 * 1024)
+
+
+/* state of inflate at a deflate block boundary, to resume decompression there */
+
+#define ZIP_CHECKPOINT_WINDOW_SIZE 32768
+
+struct zip_checkpoint {
+    zip_uint64_t out_offset;    /* offset in uncompressed data */
+    zip_uint64_t in_offset;     /* offset in compressed data of first byte not fully consumed */
+    zip_uint8_t bits;           /* number of bits of the byte before in_offset not yet consumed */
+    zip_uint32_t window_length; /* length of window */
+    zip_uint8_t *window;        /* uncompressed data preceding out_offset */
+};
+
+struct zip_checkpoints {
+    zip_uint64_t nentry;        /* number of checkpoints */
+    zip_uint64_t nentry_alloc;  /* number of checkpoints allocated */
+    zip_checkpoint_t *entry;    /* checkpoints, sorted by out_offset */
+};
+
+
+/* zstd seekable format: skippable frame with seek table after the data frames */
+
+#define ZIP_ZSTD_SKIPPABLE_MAGIC 0x184D2A5E
+#define ZIP_ZSTD_SEEKABLE_MAGIC 0x8F92EAB1
+#define ZIP_ZSTD_SEEK_TABLE_ENTRY_SIZE 8 /* without checksum */
+#define ZIP_ZSTD_SEEK_TABLE_FOOTER_SIZE 9
+
+
 /* file or archive comment, or filename */
 
 struct zip_string {
@@ -418,6 +562,7 @@ struct zip_string {
     enum zip_encoding_type encoding; /* autorecognized encoding */
     zip_uint8_t *converted;          /* autoconverted string */
     zip_uint32_t converted_length;   /* length of converted */
+    bool from_arena;                 /* raw string allocated from archive's arena */
 };
 
 
@@ -490,6 +635,12 @@ typedef struct _zip_pkware_keys zip_pkware_keys_t;
 
 zip_int64_t _zip_add_entry(zip_t *);
 
+void *_zip_arena_alloc(zip_arena_t *arena, size_t size, zip_error_t *error);
+void _zip_arena_fini(zip_arena_t *arena);
+void _zip_arena_init(zip_arena_t *arena);
+void _zip_arena_merge(zip_arena_t *arena, zip_arena_t *other);
+zip_uint64_t _zip_arena_memory_usage(const zip_arena_t *arena);
+
 zip_uint8_t *_zip_buffer_data(zip_buffer_t *buffer);
 bool _zip_buffer_eof(zip_buffer_t *buffer);
 void _zip_buffer_free(zip_buffer_t *buffer);
@@ -514,22 +665,41 @@ int _zip_buffer_skip(zip_buffer_t *buffer, zip_uint64_t length);
 int _zip_buffer_set_offset(zip_buffer_t *buffer, zip_uint64_t offset);
 zip_uint64_t _zip_buffer_size(zip_buffer_t *buffer);
 
+void _zip_checkpoints_free(zip_checkpoints_t *checkpoints);
+zip_uint64_t _zip_checkpoints_memory_usage(const zip_checkpoints_t *checkpoints);
+bool _zip_checkpoints_usable(zip_t *za, zip_uint64_t idx, zip_int32_t method, zip_source_t *src);
+
+void _zip_compression_pool_close(zip_compression_pool_t *pool);
+zip_uint64_t _zip_compression_pool_memory_usage(const zip_compression_pool_t *pool);
+
+zip_uint32_t _zip_cdir_crc(const zip_uint8_t *data, zip_uint64_t length);
 void _zip_cdir_free(zip_cdir_t *);
 bool _zip_cdir_grow(zip_cdir_t *cd, zip_uint64_t additional_entries, zip_error_t *error);
 zip_cdir_t *_zip_cdir_new(zip_uint64_t, zip_error_t *);
+bool _zip_cdir_read_parallel(zip_cdir_t *cd, zip_uint8_t *data, zip_arena_t *arena);
 zip_int64_t _zip_cdir_write(zip_t *za, const zip_filelist_t *filelist, zip_uint64_t survivors);
-time_t _zip_d2u_time(zip_uint16_t, zip_uint16_t);
+bool _zip_decompress_buffer(zip_t *za, zip_int32_t method, zip_uint16_t bitflags, const zip_uint8_t *data, zip_uint64_t length, zip_uint8_t *out, zip_uint64_t out_length, zip_error_t *error);
 void _zip_deregister_source(zip_t *za, zip_source_t *src);
 
+void _zip_dir_index_free(zip_t *za);
+void _zip_dir_index_invalidate(zip_t *za);
+void _zip_dir_index_update(zip_t *za, zip_uint64_t idx);
+zip_uint64_t _zip_dir_index_memory_usage(const zip_t *za);
+
+time_t _zip_d2u_time(zip_dostime_cache_t *cache, zip_uint16_t dtime, zip_uint16_t ddate);
+
+void _zip_dostime_cache_init(zip_dostime_cache_t *cache);
+
 void _zip_dirent_apply_attributes(zip_dirent_t *, zip_file_attributes_t *, bool, zip_uint32_t);
 zip_dirent_t *_zip_dirent_clone(const zip_dirent_t *);
 void _zip_dirent_free(zip_dirent_t *);
+time_t _zip_dirent_get_last_mod(zip_t *za, zip_dirent_t *de);
 void _zip_dirent_finalize(zip_dirent_t *);
 void _zip_dirent_init(zip_dirent_t *);
 bool _zip_dirent_needs_zip64(const zip_dirent_t *, zip_flags_t);
-zip_dirent_t *_zip_dirent_new(void);
+zip_dirent_t *_zip_dirent_new(zip_arena_t *arena);
 bool zip_dirent_process_ef_zip64(zip_dirent_t * zde, const zip_uint8_t * ef, zip_uint64_t got_len, bool local, zip_error_t * error);
-zip_int64_t _zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, bool local, zip_error_t *error);
+zip_int64_t _zip_dirent_read(zip_dirent_t *zde, zip_source_t *src, zip_buffer_t *buffer, bool local, zip_arena_t *arena, zip_error_t *error);
 void _zip_dirent_set_version_needed(zip_dirent_t *de, bool force_zip64);
 zip_int32_t _zip_dirent_size(zip_source_t *src, zip_uint16_t, zip_error_t *);
 int _zip_dirent_write(zip_t *za, zip_dirent_t *dirent, zip_flags_t flags);
@@ -540,7 +710,7 @@ void _zip_ef_free(zip_extra_field_t *);
 const zip_uint8_t *_zip_ef_get_by_id(const zip_extra_field_t *, zip_uint16_t *, zip_uint16_t, zip_uint16_t, zip_flags_t, zip_error_t *);
 zip_extra_field_t *_zip_ef_merge(zip_extra_field_t *, zip_extra_field_t *);
 zip_extra_field_t *_zip_ef_new(zip_uint16_t, zip_uint16_t, const zip_uint8_t *, zip_flags_t);
-bool _zip_ef_parse(const zip_uint8_t *, zip_uint16_t, zip_flags_t, zip_extra_field_t **, zip_error_t *);
+bool _zip_ef_parse(const zip_uint8_t *, zip_uint16_t, zip_flags_t, zip_extra_field_t **, zip_arena_t *, zip_error_t *);
 zip_extra_field_t *_zip_ef_remove_internal(zip_extra_field_t *);
 zip_uint16_t _zip_ef_size(const zip_extra_field_t *, zip_flags_t);
 int _zip_ef_write(zip_t *za, const zip_extra_field_t *ef, zip_flags_t flags);
@@ -557,25 +727,52 @@ const zip_uint8_t *_zip_extract_extra_field_by_id(zip_error_t *, zip_uint16_t, i
 
 int _zip_file_extra_field_prepare_for_change(zip_t *, zip_uint64_t);
 int _zip_file_fillbuf(void *, size_t, zip_file_t *);
-zip_uint64_t _zip_file_get_end(const zip_t *za, zip_uint64_t index, zip_error_t *error);
-zip_uint64_t _zip_file_get_offset(const zip_t *, zip_uint64_t, zip_error_t *);
+zip_uint64_t _zip_file_get_end(zip_t *za, zip_uint64_t index, zip_error_t *error);
+zip_uint64_t _zip_file_get_offset(zip_t *, zip_uint64_t, zip_error_t *);
+
+zip_cdir_t *_zip_find_central_dir(zip_t *za, zip_uint64_t len, bool refresh);
 
 zip_dirent_t *_zip_get_dirent(zip_t *, zip_uint64_t, zip_flags_t, zip_error_t *);
+bool _zip_get_names_parallel(zip_t *za, const zip_uint8_t **names, unsigned int nthreads, zip_error_t *error);
+
+zip_cdir_t *_zip_index_read(zip_t *za, const zip_stat_t *st, zip_source_t *index);
+zip_source_t *_zip_index_source_new(const void *data, zip_uint64_t length, zip_error_t *error);
+zip_t *_zip_index_open_file(zip_source_t *src, const char *fname, int flags, zip_error_t *error);
 
 enum zip_encoding_type _zip_guess_encoding(zip_string_t *, enum zip_encoding_type);
 zip_uint8_t *_zip_cp437_to_utf8(const zip_uint8_t *const, zip_uint32_t, zip_uint32_t *, zip_error_t *);
 
 bool _zip_hash_add(zip_hash_t *hash, const zip_uint8_t *name, zip_uint64_t index, zip_flags_t flags, zip_error_t *error);
+bool _zip_hash_add_names(zip_hash_t *hash, const zip_uint8_t **names, zip_uint64_t nnames, unsigned int nthreads, zip_error_t *error);
 bool _zip_hash_delete(zip_hash_t *hash, const zip_uint8_t *key, zip_error_t *error);
 void _zip_hash_free(zip_hash_t *hash);
+zip_uint64_t _zip_hash_memory_usage(const zip_hash_t *hash);
 zip_int64_t _zip_hash_lookup(zip_hash_t *hash, const zip_uint8_t *name, zip_flags_t flags, zip_error_t *error);
+zip_uint64_t _zip_hash_lookup_many(const zip_hash_t *hash, const zip_uint8_t *const *names, zip_uint64_t nnames, zip_flags_t flags, zip_int64_t *indices, unsigned int nthreads);
+bool _zip_hash_map(zip_hash_t *hash, const void *table, zip_uint32_t table_size, zip_uint64_t nentries, const zip_uint8_t *names, zip_uint64_t names_size, const zip_uint32_t *name_offset, zip_uint64_t nnames, zip_error_t *error);
 zip_hash_t *_zip_hash_new(zip_error_t *error);
+zip_uint64_t _zip_hash_num_entries(const zip_hash_t *hash);
+void _zip_hash_remove_unchanged(zip_hash_t *hash, const zip_uint8_t *name, zip_uint64_t index);
 bool _zip_hash_reserve_capacity(zip_hash_t *hash, zip_uint64_t capacity, zip_error_t *error);
 bool _zip_hash_revert(zip_hash_t *hash, zip_error_t *error);
+zip_uint32_t _zip_hash_table_size(const zip_hash_t *hash);
+void _zip_hash_write_table(const zip_hash_t *hash, zip_buffer_t *buffer);
+
+zip_int64_t _zip_lazy_cdir_add_entry(zip_lazy_cdir_t *lazy, zip_buffer_t *buffer, zip_error_t *error);
+void _zip_lazy_cdir_free(zip_lazy_cdir_t *lazy);
+zip_uint64_t _zip_lazy_cdir_memory_usage(const zip_lazy_cdir_t *lazy);
+bool _zip_lazy_cdir_get_name(zip_lazy_cdir_t *lazy, zip_uint64_t idx, const zip_uint8_t **namep, zip_error_t *error);
+zip_lazy_cdir_t *_zip_lazy_cdir_new(const zip_uint8_t *data, zip_uint64_t size, zip_arena_t *arena, zip_error_t *error);
+zip_lazy_cdir_t *_zip_lazy_cdir_new_mapped(const zip_uint8_t *data, zip_uint64_t size, const zip_uint64_t *offset, zip_uint64_t nentry, zip_arena_t *arena, zip_error_t *error);
+bool _zip_lazy_cdir_read_entry(zip_lazy_cdir_t *lazy, zip_entry_t *entry, zip_uint64_t idx, zip_error_t *error);
+
+void _zip_parallel_run(unsigned int n, zip_parallel_function_t function, void *ud);
+unsigned int _zip_parallel_threads(zip_uint64_t nitems, zip_uint64_t min_items_per_thread);
 
 int _zip_mkstempm(char *path, int mode, bool create_file);
 
-zip_t *_zip_open(zip_source_t *, unsigned int, zip_error_t *);
+zip_t *_zip_open(zip_source_t *src, unsigned int flags, zip_source_t *index, zip_error_t *error);
+zip_t *_zip_open_from_source(zip_source_t *src, int flags, zip_source_t *index, zip_error_t *error);
 
 void _zip_progress_end(zip_progress_t *progress);
 void _zip_progress_free(zip_progress_t *progress);
@@ -588,10 +785,11 @@ ZIP_EXTERN bool zip_secure_random(zip_uint8_t *buffer, zip_uint16_t length);
 zip_uint32_t zip_random_uint32(void);
 
 int _zip_read(zip_source_t *src, zip_uint8_t *data, zip_uint64_t length, zip_error_t *error);
-int _zip_read_at_offset(zip_source_t *src, zip_uint64_t offset, unsigned char *b, size_t length, zip_error_t *error);
+int _zip_read_at_offset(zip_source_t *src, zip_uint64_t offset, zip_uint8_t *b, zip_uint64_t length, zip_error_t *error);
 zip_uint8_t *_zip_read_data(zip_buffer_t *buffer, zip_source_t *src, size_t length, bool nulp, zip_error_t *error);
 int _zip_read_local_ef(zip_t *, zip_uint64_t);
-zip_string_t *_zip_read_string(zip_buffer_t *buffer, zip_source_t *src, zip_uint16_t length, bool nulp, zip_error_t *error);
+zip_string_t *_zip_read_string(zip_buffer_t *buffer, zip_source_t *src, zip_uint16_t length, bool nulp, zip_arena_t *arena, zip_error_t *error);
+void _zip_readahead(zip_t *za, zip_uint64_t idx, zip_uint64_t offset, zip_uint64_t length);
 int _zip_register_source(zip_t *za, zip_source_t *src);
 
 void _zip_set_open_error(int *zep, const zip_error_t *err, int ze);
@@ -599,13 +797,20 @@ void _zip_set_open_error(int *zep, const zip_error_t *err, int ze);
 bool zip_source_accept_empty(zip_source_t *src);
 zip_int64_t _zip_source_call(zip_source_t *src, void *data, zip_uint64_t length, zip_source_cmd_t command);
 bool _zip_source_eof(zip_source_t *);
+zip_source_t *_zip_source_checkpoint_inflate_new(zip_t *za, zip_uint64_t idx, zip_source_t *src, zip_error_t *error);
+zip_source_t *_zip_source_file_mmap_create(const char *fname, zip_error_t *error);
 zip_source_t *_zip_source_file_or_p(const char *, FILE *, zip_uint64_t, zip_int64_t, const zip_stat_t *, zip_error_t *error);
+void _zip_source_advise(zip_source_t *src, zip_uint64_t offset, zip_uint64_t length, int advice);
+const zip_uint8_t *_zip_source_get_data(zip_source_t *src, zip_uint64_t offset, zip_uint64_t length, zip_error_t *error);
 bool _zip_source_had_error(zip_source_t *);
 void _zip_source_invalidate(zip_source_t *src);
+zip_uint64_t _zip_source_memory_usage(const zip_source_t *src, const zip_source_t *stop);
 zip_source_t *_zip_source_new(zip_error_t *error);
+zip_source_t *_zip_source_restartable_new(zip_source_t *src, const zip_restartable_decompressor_t *decompressor, void *ud, zip_error_t *error);
 int _zip_source_set_source_archive(zip_source_t *, zip_t *);
 zip_source_t *_zip_source_window_new(zip_source_t *src, zip_uint64_t start, zip_int64_t length, zip_stat_t *st, zip_file_attributes_t *attributes, zip_t *source_archive, zip_uint64_t source_index, zip_error_t *error);
 zip_source_t *_zip_source_zip_new(zip_t *, zip_uint64_t, zip_flags_t, zip_uint64_t, zip_uint64_t, const char *, zip_error_t *error);
+zip_source_t *_zip_source_zstd_decompress(zip_t *za, zip_source_t *src, zip_uint64_t size, zip_error_t *error);
 
 int _zip_stat_merge(zip_stat_t *dst, const zip_stat_t *src, zip_error_t *error);
 int _zip_string_equal(const zip_string_t *a, const zip_string_t *b);
@@ -614,6 +819,7 @@ zip_uint32_t _zip_string_crc32(const zip_string_t *string);
 const zip_uint8_t *_zip_string_get(zip_string_t *string, zip_uint32_t *lenp, zip_flags_t flags, zip_error_t *error);
 zip_uint16_t _zip_string_length(const zip_string_t *string);
 zip_string_t *_zip_string_new(const zip_uint8_t *raw, zip_uint16_t length, zip_flags_t flags, zip_error_t *error);
+zip_string_t *_zip_string_new_arena(const zip_uint8_t *raw, zip_uint16_t length, zip_flags_t flags, zip_arena_t *arena, zip_error_t *error);
 int _zip_string_write(zip_t *za, const zip_string_t *string);
 bool _zip_winzip_aes_decrypt(zip_winzip_aes_t *ctx, zip_uint8_t *data, zip_uint64_t length);
 bool _zip_winzip_aes_encrypt(zip_winzip_aes_t *ctx, zip_uint8_t *data, zip_uint64_t length);
@@ -631,7 +837,14 @@ int _zip_changed(const zip_t *, zip_uint64_t *);
 const char *_zip_get_name(zip_t *, zip_uint64_t, zip_flags_t, zip_error_t *);
 int _zip_local_header_read(zip_t *, int);
 void *_zip_memdup(const void *, size_t, zip_error_t *);
+void *_zip_memory_alloc(zip_uint64_t *usage, zip_uint64_t size);
+void _zip_memory_free(zip_uint64_t *usage, void *ptr);
 zip_int64_t _zip_name_locate(zip_t *, const char *, zip_flags_t, zip_error_t *);
+void _zip_name_index_free(zip_t *za);
+zip_uint64_t _zip_name_index_memory_usage(const zip_t *za);
+void _zip_name_index_add(zip_t *za, zip_uint64_t first);
+bool _zip_name_index_lookup(zip_t *za, const char *fname, zip_flags_t flags, zip_int64_t *idxp);
+void _zip_name_index_update(zip_t *za, zip_uint64_t idx);
 zip_t *_zip_new(zip_error_t *);
 
 zip_int64_t _zip_file_replace(zip_t *, zip_uint64_t, const char *, zip_source_t *, zip_flags_t);
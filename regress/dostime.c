@@ -0,0 +1,161 @@
+/*
+  dostime.c -- test conversion of MS-DOS times
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zip.h"
+
+/* Modification times of entries are converted with a per-day cache of
+   the UTC offset.  Compare them with the result of mktime() for days
+   around DST transitions, in an order that evicts cache entries. */
+
+/* Central European Time, DST from last Sunday in March 02:00 to last Sunday in October 03:00 */
+#define TIMEZONE "TZ=CET-1CEST,M3.5.0,M10.5.0/3"
+
+#define DOS_DATE(year, month, day) ((zip_uint16_t)((((year)-1980) << 9) | ((month) << 5) | (day)))
+#define DOS_TIME(hour, minute, second) ((zip_uint16_t)(((hour) << 11) | ((minute) << 5) | ((second) >> 1)))
+
+static const zip_uint16_t dates[] = {
+    DOS_DATE(2021, 1, 15),  /* winter */
+    DOS_DATE(2021, 3, 27),  DOS_DATE(2021, 3, 28), /* start of DST */
+    DOS_DATE(2021, 3, 29),  DOS_DATE(2021, 7, 1),  /* summer */
+    DOS_DATE(2021, 10, 30), DOS_DATE(2021, 10, 31), /* end of DST */
+    DOS_DATE(2021, 11, 1),  DOS_DATE(2022, 3, 27), /* start of DST, same cache slot as 2021-03-27 */
+    DOS_DATE(2021, 2, 29),  /* invalid, normalized by mktime */
+};
+
+#define NDATES (sizeof(dates) / sizeof(dates[0]))
+#define TIMES_PER_DAY 48 /* every 30 minutes */
+
+static time_t expected_time(zip_uint16_t dtime, zip_uint16_t ddate);
+
+const char *progname;
+
+
+int
+main(int argc, char *argv[]) {
+    zip_source_t *src;
+    zip_t *za;
+    zip_error_t error;
+    zip_uint64_t i, n;
+    int fail = 0;
+
+    (void)argc;
+    progname = argv[0];
+
+    putenv(TIMEZONE);
+    tzset();
+
+    zip_error_init(&error);
+    if ((src = zip_source_buffer_create(NULL, 0, 0, &error)) == NULL || (za = zip_open_from_source(src, ZIP_TRUNCATE, &error)) == NULL) {
+        fprintf(stderr, "%s: can't create archive: %s\n", progname, zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        return 1;
+    }
+    zip_source_keep(src);
+
+    /* days alternate, so consecutive entries use different cache entries */
+    n = NDATES * TIMES_PER_DAY;
+    for (i = 0; i < n; i++) {
+        zip_uint16_t ddate = dates[i % NDATES];
+        zip_uint16_t dtime = DOS_TIME((i / NDATES) / 2, (i / NDATES) % 2 * 30, (i % 30) * 2);
+        zip_source_t *data;
+        char name[32];
+
+        snprintf(name, sizeof(name), "%04x-%04x", ddate, dtime);
+        if ((data = zip_source_buffer(za, NULL, 0, 0)) == NULL || zip_file_add(za, name, data, 0) < 0 || zip_file_set_dostime(za, i, dtime, ddate, 0) < 0) {
+            fprintf(stderr, "%s: can't add file '%s': %s\n", progname, name, zip_strerror(za));
+            zip_source_free(data);
+            zip_discard(za);
+            zip_source_free(src);
+            return 1;
+        }
+    }
+    if (zip_close(za) < 0) {
+        fprintf(stderr, "%s: can't write archive: %s\n", progname, zip_strerror(za));
+        zip_discard(za);
+        zip_source_free(src);
+        return 1;
+    }
+
+    if ((za = zip_open_from_source(src, ZIP_RDONLY, &error)) == NULL) {
+        fprintf(stderr, "%s: can't open archive: %s\n", progname, zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        return 1;
+    }
+    zip_error_fini(&error);
+
+    for (i = 0; i < n; i++) {
+        zip_stat_t st;
+        unsigned int ddate, dtime;
+        time_t expected;
+
+        if (zip_stat_index(za, i, 0, &st) < 0 || sscanf(st.name, "%x-%x", &ddate, &dtime) != 2) {
+            fprintf(stderr, "%s: can't stat file %" PRIu64 ": %s\n", progname, i, zip_strerror(za));
+            fail++;
+            continue;
+        }
+        expected = expected_time((zip_uint16_t)dtime, (zip_uint16_t)ddate);
+        if (st.mtime != expected) {
+            fprintf(stderr, "%s: wrong modification time for '%s': got %lld, expected %lld\n", progname, st.name, (long long)st.mtime, (long long)expected);
+            fail++;
+        }
+    }
+
+    zip_close(za);
+
+    return fail ? 1 : 0;
+}
+
+
+/* conversion without cache */
+static time_t
+expected_time(zip_uint16_t dtime, zip_uint16_t ddate) {
+    struct tm tm;
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_isdst = -1;
+    tm.tm_year = ((ddate >> 9) & 127) + 1980 - 1900;
+    tm.tm_mon = ((ddate >> 5) & 15) - 1;
+    tm.tm_mday = ddate & 31;
+    tm.tm_hour = (dtime >> 11) & 31;
+    tm.tm_min = (dtime >> 5) & 63;
+    tm.tm_sec = (dtime << 1) & 62;
+
+    return mktime(&tm);
+}
@@ -0,0 +1,243 @@
+/*
+  encoding_guess.c -- test guessing encoding of file names
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zip.h"
+
+/* File names are scanned for printable ASCII a block at a time, with
+   a scalar loop for the rest.  Put bytes that end such a run at
+   positions around block boundaries of names of lengths that are and
+   aren't multiples of the block sizes, and check that the names are
+   guessed as ASCII, UTF-8, or CP437 as expected. */
+
+#define MAX_NAME 80
+
+static const zip_uint32_t lengths[] = {33, 40, 47, 48, 49, 64, 65, 70};
+static const zip_uint32_t positions[] = {0, 1, 7, 8, 15, 16, 31, 32, 33, 47, 48, 63, 64};
+static const zip_uint8_t controls[] = {'\t', '\n', '\r', 0x7f}; /* ASCII for guessing, converted if name is CP437 */
+
+enum kind { KIND_CONTROL, KIND_CONTROL_CP437, KIND_CP437, KIND_UTF8 };
+
+typedef struct {
+    zip_uint8_t raw[MAX_NAME + 1];
+    char expected[MAX_NAME * 3 + 1];
+} name_t;
+
+static void add_byte(name_t *name, zip_uint32_t *raw_length, zip_uint32_t *expected_length, zip_uint8_t byte, const char *cp437, int is_cp437);
+static zip_uint32_t make_names(name_t *names);
+static const char *utf8_of_cp437(zip_uint8_t byte);
+
+const char *progname;
+
+
+int
+main(int argc, char *argv[]) {
+    name_t *names;
+    zip_source_t *src;
+    zip_t *za;
+    zip_error_t error;
+    zip_uint32_t i, n;
+    int fail = 0;
+
+    (void)argc;
+    progname = argv[0];
+
+    if ((names = (name_t *)malloc(sizeof(*names) * 2000)) == NULL) {
+        fprintf(stderr, "%s: malloc failure\n", progname);
+        return 1;
+    }
+    n = make_names(names);
+
+    zip_error_init(&error);
+    if ((src = zip_source_buffer_create(NULL, 0, 0, &error)) == NULL || (za = zip_open_from_source(src, ZIP_TRUNCATE, &error)) == NULL) {
+        fprintf(stderr, "%s: can't create archive: %s\n", progname, zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        free(names);
+        return 1;
+    }
+    zip_source_keep(src);
+
+    /* encoding is guessed when adding (names guessed as UTF-8 get the UTF-8 flag) and again when reading */
+    for (i = 0; i < n; i++) {
+        zip_source_t *data;
+
+        if ((data = zip_source_buffer(za, NULL, 0, 0)) == NULL || zip_file_add(za, (const char *)names[i].raw, data, ZIP_FL_ENC_GUESS) < 0) {
+            fprintf(stderr, "%s: can't add file %u: %s\n", progname, i, zip_strerror(za));
+            zip_source_free(data);
+            zip_discard(za);
+            zip_source_free(src);
+            free(names);
+            return 1;
+        }
+    }
+    if (zip_close(za) < 0) {
+        fprintf(stderr, "%s: can't write archive: %s\n", progname, zip_strerror(za));
+        zip_discard(za);
+        zip_source_free(src);
+        free(names);
+        return 1;
+    }
+
+    if ((za = zip_open_from_source(src, ZIP_RDONLY, &error)) == NULL) {
+        fprintf(stderr, "%s: can't open archive: %s\n", progname, zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        free(names);
+        return 1;
+    }
+    zip_error_fini(&error);
+
+    for (i = 0; i < n; i++) {
+        const char *name;
+
+        if ((name = zip_get_name(za, i, ZIP_FL_ENC_GUESS)) == NULL) {
+            fprintf(stderr, "%s: can't get name of file %u: %s\n", progname, i, zip_strerror(za));
+            fail++;
+            continue;
+        }
+        if (strcmp(name, names[i].expected) != 0) {
+            fprintf(stderr, "%s: wrong name for file %u: got '%s', expected '%s'\n", progname, i, name, names[i].expected);
+            fail++;
+        }
+    }
+
+    zip_close(za);
+    free(names);
+
+    return fail ? 1 : 0;
+}
+
+
+static void
+add_byte(name_t *name, zip_uint32_t *raw_length, zip_uint32_t *expected_length, zip_uint8_t byte, const char *cp437, int is_cp437) {
+    name->raw[(*raw_length)++] = byte;
+    if (is_cp437) {
+        strcpy(name->expected + *expected_length, cp437);
+        *expected_length += (zip_uint32_t)strlen(cp437);
+    }
+    else {
+        name->expected[(*expected_length)++] = (char)byte;
+    }
+}
+
+
+/* fill names with all combinations, return number of names */
+static zip_uint32_t
+make_names(name_t *names) {
+    zip_uint32_t n = 0;
+    size_t l, p, c;
+    int kind;
+
+    for (l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        zip_uint32_t length = lengths[l];
+
+        for (p = 0; p < sizeof(positions) / sizeof(positions[0]) + 1; p++) {
+            /* last entry is end of name */
+            zip_uint32_t position = p < sizeof(positions) / sizeof(positions[0]) ? positions[p] : length - 1;
+
+            if (position >= length || (p < sizeof(positions) / sizeof(positions[0]) && position == length - 1)) {
+                continue;
+            }
+
+            for (kind = KIND_CONTROL; kind <= KIND_UTF8; kind++) {
+                for (c = 0; c < (kind == KIND_CONTROL || kind == KIND_CONTROL_CP437 ? sizeof(controls) : 1); c++) {
+                    name_t *name = names + n;
+                    zip_uint32_t raw_length = 0, expected_length = 0, i;
+                    int is_cp437 = kind == KIND_CONTROL_CP437 || kind == KIND_CP437;
+
+                    /* CP437 byte at end decides encoding of name, so it must come after control character */
+                    if ((kind == KIND_CONTROL_CP437 && position == length - 1) || (kind == KIND_UTF8 && position == length - 1)) {
+                        continue;
+                    }
+
+                    for (i = 0; i < length; i++) {
+                        if (i == position) {
+                            switch (kind) {
+                            case KIND_CONTROL:
+                            case KIND_CONTROL_CP437:
+                                add_byte(name, &raw_length, &expected_length, controls[c], utf8_of_cp437(controls[c]), is_cp437);
+                                break;
+
+                            case KIND_CP437:
+                                add_byte(name, &raw_length, &expected_length, 0x82, utf8_of_cp437(0x82), is_cp437);
+                                break;
+
+                            case KIND_UTF8:
+                                /* U+00E9 */
+                                add_byte(name, &raw_length, &expected_length, 0xc3, NULL, 0);
+                                add_byte(name, &raw_length, &expected_length, 0xa9, NULL, 0);
+                                i++;
+                                break;
+                            }
+                        }
+                        else if (kind == KIND_CONTROL_CP437 && i == length - 1) {
+                            add_byte(name, &raw_length, &expected_length, 0x82, utf8_of_cp437(0x82), is_cp437);
+                        }
+                        else {
+                            /* start differs with length, so converted names of different lengths don't collide */
+                            add_byte(name, &raw_length, &expected_length, (zip_uint8_t)('a' + (length + i) % 26), NULL, 0);
+                        }
+                    }
+                    name->raw[raw_length] = 0;
+                    name->expected[expected_length] = 0;
+                    n++;
+                }
+            }
+        }
+    }
+
+    return n;
+}
+
+
+static const char *
+utf8_of_cp437(zip_uint8_t byte) {
+    switch (byte) {
+    case '\t':
+        return "\xe2\x97\x8b"; /* U+25CB */
+    case '\n':
+        return "\xe2\x97\x99"; /* U+25D9 */
+    case '\r':
+        return "\xe2\x99\xaa"; /* U+266A */
+    case 0x7f:
+        return "\xe2\x8c\x82"; /* U+2302 */
+    case 0x82:
+        return "\xc3\xa9"; /* U+00E9 */
+    default:
+        return NULL;
+    }
+}
@@ -0,0 +1,196 @@
+/*
+  memory_usage.c -- test memory usage reporting
+  Copyright (C) 2026 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <info@libzip.org>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zip.h"
+
+/* The amounts reported depend on the platform, so only check that
+   they are consistent and change as expected. */
+
+#define DECOMPRESS_BUFFER_SIZE 8192
+#define INFLATE_WINDOW_SIZE 32768
+
+static int check_archive(const char *archive, int flags);
+static int check_consistent(const char *what, const zip_memory_usage_t *usage);
+
+const char *progname;
+
+
+int
+main(int argc, char *argv[]) {
+    int fail = 0;
+
+    progname = argv[0];
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s archive\n", progname);
+        return 1;
+    }
+
+    fail += check_archive(argv[1], 0);
+    fail += check_archive(argv[1], ZIP_RDONLY | ZIP_LAZY);
+
+    return fail ? 1 : 0;
+}
+
+
+static int
+check_archive(const char *archive, int flags) {
+    zip_t *za;
+    zip_file_t *zf;
+    zip_memory_usage_t before, after;
+    struct {
+        zip_memory_usage_t usage;
+        zip_uint64_t added_later;
+    } newer;
+    zip_uint64_t file_usage;
+    char buf[100];
+    int err, fail = 0;
+
+    if ((za = zip_open(archive, flags, &err)) == NULL) {
+        zip_error_t error;
+        zip_error_init_with_code(&error, err);
+        fprintf(stderr, "%s: can't open zip archive '%s': %s\n", progname, archive, zip_error_strerror(&error));
+        zip_error_fini(&error);
+        return 1;
+    }
+
+    before.size = sizeof(before) - 1;
+    if (zip_get_memory_usage(za, &before) == 0 || zip_error_code_zip(zip_get_error(za)) != ZIP_ER_INVAL) {
+        fprintf(stderr, "%s: too small size of memory usage structure not rejected\n", progname);
+        fail++;
+    }
+    zip_error_clear(za);
+
+    if (zip_get_memory_usage(za, NULL) == 0 || zip_error_code_zip(zip_get_error(za)) != ZIP_ER_INVAL) {
+        fprintf(stderr, "%s: missing memory usage structure not rejected\n", progname);
+        fail++;
+    }
+    zip_error_clear(za);
+
+    /* as passed by caller compiled against a later version */
+    newer.usage.size = sizeof(newer);
+    newer.added_later = 42;
+    if (zip_get_memory_usage(za, &newer.usage) < 0) {
+        fprintf(stderr, "%s: can't get memory usage into larger structure: %s\n", progname, zip_strerror(za));
+        fail++;
+    }
+    else if (newer.usage.size != sizeof(newer) || newer.added_later != 42) {
+        fprintf(stderr, "%s: unknown members of larger memory usage structure changed\n", progname);
+        fail++;
+    }
+
+    before.size = sizeof(before);
+    if (zip_get_memory_usage(za, &before) < 0) {
+        fprintf(stderr, "%s: can't get memory usage: %s\n", progname, zip_strerror(za));
+        zip_discard(za);
+        return fail + 1;
+    }
+    fail += check_consistent("after open", &before);
+    if (before.sources == 0) {
+        fprintf(stderr, "%s: no memory reported for archive source\n", progname);
+        fail++;
+    }
+    if ((flags & ZIP_LAZY) && before.central_directory == 0) {
+        fprintf(stderr, "%s: no memory reported for raw central directory\n", progname);
+        fail++;
+    }
+
+    if ((zf = zip_fopen_index(za, 0, 0)) == NULL) {
+        fprintf(stderr, "%s: can't open file: %s\n", progname, zip_strerror(za));
+        zip_close(za);
+        return fail + 1;
+    }
+    if (zip_fread(zf, buf, sizeof(buf)) < 0) {
+        fprintf(stderr, "%s: can't read file: %s\n", progname, zip_file_strerror(zf));
+        fail++;
+    }
+    file_usage = zip_file_get_memory_usage(zf);
+    /* includes the decompression buffer and the state of zlib */
+    if (file_usage < DECOMPRESS_BUFFER_SIZE + INFLATE_WINDOW_SIZE) {
+        fprintf(stderr, "%s: memory reported for open file too small: %" PRIu64 "\n", progname, file_usage);
+        fail++;
+    }
+
+    after.size = sizeof(after);
+    zip_get_memory_usage(za, &after);
+    fail += check_consistent("after reading", &after);
+    if (after.strings < before.strings || after.entries < before.entries) {
+        fprintf(stderr, "%s: memory reported for entries decreased while reading\n", progname);
+        fail++;
+    }
+    /* with ZIP_LAZY, the entry is parsed when it is opened */
+    if ((flags & ZIP_LAZY) && after.strings == before.strings) {
+        fprintf(stderr, "%s: no memory reported for file name of parsed entry\n", progname);
+        fail++;
+    }
+    zip_fclose(zf);
+
+    if (!(flags & ZIP_RDONLY)) {
+        before = after;
+        if (zip_file_set_comment(za, 0, "a comment", 9, 0) < 0 || zip_set_archive_comment(za, "another comment", 15) < 0) {
+            fprintf(stderr, "%s: can't set comments: %s\n", progname, zip_strerror(za));
+            fail++;
+        }
+        zip_get_memory_usage(za, &after);
+        fail += check_consistent("after setting comments", &after);
+        if (after.strings <= before.strings || after.archive <= before.archive || after.entries <= before.entries) {
+            fprintf(stderr, "%s: memory reported for comments did not increase\n", progname);
+            fail++;
+        }
+    }
+
+    zip_discard(za);
+
+    return fail;
+}
+
+
+static int
+check_consistent(const char *what, const zip_memory_usage_t *usage) {
+    zip_uint64_t sum = usage->archive + usage->entries + usage->strings + usage->extra_fields + usage->name_lookup + usage->central_directory + usage->sources + usage->checkpoints + usage->unused;
+
+    if (usage->total != sum) {
+        fprintf(stderr, "%s: %s: total %" PRIu64 " is not sum of parts %" PRIu64 "\n", progname, what, usage->total, sum);
+        return 1;
+    }
+    if (usage->archive == 0 || usage->entries == 0 || usage->name_lookup == 0) {
+        fprintf(stderr, "%s: %s: no memory reported for archive, entries, or name lookup\n", progname, what);
+        return 1;
+    }
+
+    return 0;
+}
@@ -42,10 +42,11 @@
 
 #include "zip.h"
 #define TRYOPEN_USAGE                  \
-    "usage: %s [-cent] file\n\n"       \
+    "usage: %s [-centp] file\n\n"      \
     "\t-c\tcheck consistency\n"        \
     "\t-e\texclusively open archive\n" \
     "\t-n\tcreate new file\n"          \
+    "\t-p\topen using threads\n"       \
     "\t-t\ttruncate file to size 0\n"
 
 
@@ -59,7 +60,7 @@ main(int argc, char *argv[]) {
 
     flags = 0;
 
-    while ((c = getopt(argc, argv, "cent")) != -1) {
+    while ((c = getopt(argc, argv, "centp")) != -1) {
         switch (c) {
         case 'c':
             flags |= ZIP_CHECKCONS;
@@ -70,6 +71,9 @@ main(int argc, char *argv[]) {
         case 'n':
             flags |= ZIP_CREATE;
             break;
+        case 'p':
+            flags |= ZIP_PARALLEL;
+            break;
         case 't':
             flags |= ZIP_TRUNCATE;
             break;
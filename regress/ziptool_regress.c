@@ -4,9 +4,12 @@
 
 #define ZIP_MIN(a, b) ((a) < (b) ? (a) : (b))
 
+/* key of archives read by xor_read_all */
+#define XOR_KEY 0x5a
+
 #define FOR_REGRESS
 
-typedef enum { SOURCE_TYPE_NONE, SOURCE_TYPE_IN_MEMORY, SOURCE_TYPE_HOLE } source_type_t;
+typedef enum { SOURCE_TYPE_NONE, SOURCE_TYPE_IN_MEMORY, SOURCE_TYPE_HOLE, SOURCE_TYPE_INDEX, SOURCE_TYPE_INDEX_FILE } source_type_t;
 
 source_type_t source_type = SOURCE_TYPE_NONE;
 zip_uint64_t fragment_size = 0;
@@ -15,25 +18,50 @@ unsigned int z_files_count;
 
 static int add_nul(char *argv[]);
 static int cancel(char *argv[]);
+static int dir_list_rename(char *argv[]);
 static int regress_fopen(char *argv[]);
 static int regress_fread(char *argv[]);
 static int regress_fseek(char *argv[]);
 static int is_seekable(char *argv[]);
+static int print_checkpoints(char *argv[]);
+static int regress_read_all(char *argv[]);
+static int regress_read_files(char *argv[]);
+static int read_interleaved(char *argv[]);
+static int source_read_at(char *argv[]);
+static int stream_list_unseekable(char *argv[]);
 static int unchange_one(char *argv[]);
 static int unchange_all(char *argv[]);
+static int xor_read_all(char *argv[]);
 static int zin_close(char *argv[]);
 
-#define OPTIONS_REGRESS "F:Hm"
+#define OPTIONS_REGRESS "F:HILmMRX"
 
-#define USAGE_REGRESS " [-Hm] [-F fragment-size]"
+#define USAGE_REGRESS " [-HILmMRX] [-F fragment-size]"
 
 #define GETOPT_REGRESS                              \
     case 'H':                                       \
         source_type = SOURCE_TYPE_HOLE;             \
         break;                                      \
+    case 'I':                                       \
+        source_type = SOURCE_TYPE_INDEX;            \
+        flags |= ZIP_RDONLY;                        \
+        break;                                      \
+    case 'L':                                       \
+        flags |= ZIP_RDONLY | ZIP_LAZY;             \
+        break;                                      \
     case 'm':                                       \
         source_type = SOURCE_TYPE_IN_MEMORY;        \
         break;                                      \
+    case 'M':                                       \
+        flags |= ZIP_RDONLY | ZIP_MMAP;             \
+        break;                                      \
+    case 'R':                                       \
+        flags |= ZIP_RDONLY;                        \
+        break;                                      \
+    case 'X':                                       \
+        source_type = SOURCE_TYPE_INDEX_FILE;       \
+        flags |= ZIP_RDONLY;                        \
+        break;                                      \
     case 'F':                                       \
         fragment_size = strtoull(optarg, NULL, 10); \
         break;
@@ -43,12 +71,20 @@ static int zin_close(char *argv[]);
 #define DISPATCH_REGRESS \
     {"add_nul", 2, "name length", "add NUL bytes", add_nul}, \
     {"cancel", 1, "limit", "cancel writing archive when limit% have been written (calls print_progress)", cancel}, \
+    {"dir_list_rename", 5, "directory flags count index name", "list directory, renaming entry after count names", dir_list_rename}, \
     {"fopen", 1, "name", "open archive entry", regress_fopen}, \
     {"fread", 2, "file_index length", "read from fopened file and print", regress_fread}, \
     {"fseek", 3, "file_index offset whence", "seek in fopened file", regress_fseek}, \
     {"is_seekable", 1, "index", "report if entry is seekable", is_seekable}, \
+    {"print_checkpoints", 1, "index", "print offsets of checkpoints of entry", print_checkpoints}, \
+    {"read_all", 1, "index", "read whole entry at once and print its length", regress_read_all}, \
+    {"read_files", 1, "max_memory", "read all entries with zip_read_files and print their lengths", regress_read_files}, \
+    {"read_interleaved", 3, "index1 index2 length", "read two entries alternately in chunks of length", read_interleaved}, \
+    {"source_read_at", 3, "file offset length", "read from file at offset, at most 3 bytes per source call", source_read_at}, \
+    {"stream_list_unseekable", 2, "archivename password", "read other archive sequentially from source that can't seek and list its entries", stream_list_unseekable}, \
     {"unchange", 1, "index", "revert changes for entry", unchange_one}, \
     {"unchange_all", 0, "", "revert all changes", unchange_all}, \
+    {"xor_read_all", 1, "archivename", "read entries of other archive stored XORed through layered source (from memory with -m)", xor_read_all}, \
     {"zin_close", 1, "index", "close input zip_source (for internal tests)", zin_close}
 
 #define PRECLOSE_REGRESS                                         \
@@ -122,6 +158,47 @@ cancel(char *argv[]) {
     return 0;
 }
 
+static int
+dir_list_rename(char *argv[]) {
+    zip_dir_list_t *list;
+    zip_flags_t flags;
+    zip_uint64_t count, n, idx;
+    const char *name;
+    zip_int64_t name_idx;
+
+    flags = get_flags(argv[1]);
+    count = strtoull(argv[2], NULL, 10);
+    idx = strtoull(argv[3], NULL, 10);
+
+    if ((list = zip_dir_list_open(za, argv[0], flags)) == NULL) {
+        fprintf(stderr, "can't list directory '%s': %s\n", argv[0], zip_strerror(za));
+        return -1;
+    }
+    zip_error_clear(za);
+    n = 0;
+    while ((name = zip_dir_list_next(list, &name_idx)) != NULL) {
+        if (name_idx < 0) {
+            printf("name '%s' implicit directory\n", name);
+        }
+        else {
+            printf("name '%s' index %" PRId64 "\n", name, name_idx);
+        }
+        if (++n == count) {
+            if (zip_file_rename(za, idx, argv[4], 0) < 0) {
+                fprintf(stderr, "can't rename file at index '%" PRIu64 "' to '%s': %s\n", idx, argv[4], zip_strerror(za));
+                zip_dir_list_close(list);
+                return -1;
+            }
+        }
+    }
+    zip_dir_list_close(list);
+    if (zip_error_code_zip(zip_get_error(za)) != ZIP_ER_OK) {
+        fprintf(stderr, "can't list directory '%s': %s\n", argv[0], zip_strerror(za));
+        return -1;
+    }
+    return 0;
+}
+
 static int
 is_seekable(char *argv[]) {
     zip_uint64_t idx;
@@ -146,6 +223,171 @@ is_seekable(char *argv[]) {
     return 0;
 }
 
+/* offsets are read from the exported checkpoints */
+static zip_uint64_t
+get_64(const zip_uint8_t *p) {
+    zip_uint64_t value = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static int
+print_checkpoints(char *argv[]) {
+    zip_uint64_t idx, count, offset, i;
+    zip_int64_t length;
+    zip_uint8_t *data;
+
+    idx = strtoull(argv[0], NULL, 10);
+    if ((length = zip_file_get_checkpoints(za, idx, NULL, 0)) < 0) {
+        fprintf(stderr, "can't get checkpoints for file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        return -1;
+    }
+    if ((data = (zip_uint8_t *)malloc((size_t)length)) == NULL) {
+        fprintf(stderr, "malloc failure\n");
+        return -1;
+    }
+    if (zip_file_get_checkpoints(za, idx, data, (zip_uint64_t)length) < 0) {
+        fprintf(stderr, "can't get checkpoints for file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        free(data);
+        return -1;
+    }
+
+    count = get_64(data + 28);
+    printf("%" PRIu64 " checkpoints\n", count);
+    offset = 36;
+    for (i = 0; i < count; i++) {
+        printf("checkpoint at %" PRIu64 "\n", get_64(data + offset));
+        offset += 19 + (zip_uint64_t)(data[offset + 17] | (data[offset + 18] << 8));
+    }
+
+    free(data);
+    return 0;
+}
+
+static int
+regress_read_all(char *argv[]) {
+    zip_uint64_t idx;
+    zip_stat_t sb;
+    zip_uint8_t *buf;
+    zip_int64_t n;
+
+    idx = strtoull(argv[0], NULL, 10);
+    if (zip_stat_index(za, idx, 0, &sb) < 0) {
+        fprintf(stderr, "zip_stat_index failed on '%" PRIu64 "' failed: %s\n", idx, zip_strerror(za));
+        return -1;
+    }
+    if ((buf = (zip_uint8_t *)malloc(sb.size > 0 ? (size_t)sb.size : 1)) == NULL) {
+        fprintf(stderr, "malloc failure\n");
+        return -1;
+    }
+
+    /* data is checked against the CRC-32 */
+    if ((n = zip_file_read_all(za, idx, buf, sb.size, 0)) < 0) {
+        fprintf(stderr, "can't read file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        free(buf);
+        return -1;
+    }
+    printf("read %" PRId64 " bytes from index %" PRIu64 "\n", n, idx);
+    free(buf);
+    return 0;
+}
+
+static int
+read_files_callback(zip_t *archive, zip_uint64_t idx, const void *data, zip_uint64_t length, void *ud) {
+    (void)archive;
+    (void)data;
+    (void)ud;
+
+    printf("read %" PRIu64 " bytes from index %" PRIu64 "\n", length, idx);
+    return 0;
+}
+
+static int
+regress_read_files(char *argv[]) {
+    zip_uint64_t *indices;
+    zip_int64_t count;
+    zip_uint64_t i, max_memory;
+    int ret;
+
+    max_memory = strtoull(argv[0], NULL, 10);
+
+    if ((count = zip_get_num_entries(za, 0)) <= 0) {
+        return 0;
+    }
+    if ((indices = (zip_uint64_t *)malloc(sizeof(*indices) * (size_t)count)) == NULL) {
+        fprintf(stderr, "malloc failure\n");
+        return -1;
+    }
+    for (i = 0; i < (zip_uint64_t)count; i++) {
+        indices[i] = i;
+    }
+
+    /* data is checked against the CRC-32 */
+    if ((ret = zip_read_files(za, indices, (zip_uint64_t)count, 0, max_memory, read_files_callback, NULL)) < 0) {
+        fprintf(stderr, "can't read files: %s\n", zip_strerror(za));
+    }
+    free(indices);
+    return ret;
+}
+
+static int
+read_interleaved(char *argv[]) {
+    zip_uint64_t idx[2], total[2], length;
+    zip_file_t *zf[2];
+    char buf[8192];
+    int done[2];
+    int i, ret;
+
+    idx[0] = strtoull(argv[0], NULL, 10);
+    idx[1] = strtoull(argv[1], NULL, 10);
+    length = ZIP_MIN(strtoull(argv[2], NULL, 10), sizeof(buf));
+
+    for (i = 0; i < 2; i++) {
+        if ((zf[i] = zip_fopen_index(za, idx[i], 0)) == NULL) {
+            fprintf(stderr, "can't open file at index '%" PRIu64 "': %s\n", idx[i], zip_strerror(za));
+            if (i > 0) {
+                zip_fclose(zf[0]);
+            }
+            return -1;
+        }
+        total[i] = 0;
+        done[i] = 0;
+    }
+
+    /* data is checked against the CRC-32 when the end of a file is reached */
+    ret = 0;
+    while (ret == 0 && !(done[0] && done[1])) {
+        for (i = 0; i < 2; i++) {
+            zip_int64_t n;
+
+            if (done[i]) {
+                continue;
+            }
+            if ((n = zip_fread(zf[i], buf, length)) < 0) {
+                fprintf(stderr, "can't read file at index '%" PRIu64 "': %s\n", idx[i], zip_file_strerror(zf[i]));
+                ret = -1;
+                break;
+            }
+            if (n == 0) {
+                done[i] = 1;
+            }
+            total[i] += (zip_uint64_t)n;
+        }
+    }
+
+    for (i = 0; i < 2; i++) {
+        if (ret == 0) {
+            printf("read %" PRIu64 " bytes from index %" PRIu64 "\n", total[i], idx[i]);
+        }
+        zip_fclose(zf[i]);
+    }
+    return ret;
+}
+
 static int
 regress_fseek(char *argv[]) {
     zip_uint64_t file_idx;
@@ -179,6 +421,261 @@ unchange_all(char *argv[]) {
 }
 
 
+static zip_int64_t
+unseekable_callback(zip_source_t *src, void *ud, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
+    switch (cmd) {
+    case ZIP_SOURCE_SUPPORTS:
+        return ZIP_SOURCE_SUPPORTS_READABLE;
+
+    default:
+        return zip_source_pass_to_lower_layer(src, data, len, cmd);
+    }
+}
+
+
+/* makes zip_source_read_at continue after short reads */
+static zip_int64_t
+short_read_at_callback(zip_source_t *src, void *ud, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
+    switch (cmd) {
+    case ZIP_SOURCE_READ_AT: {
+        zip_source_args_read_at_t *args = (zip_source_args_read_at_t *)data;
+
+        return zip_source_read_at(src, args->data, ZIP_MIN(args->length, 3), args->offset);
+    }
+
+    case ZIP_SOURCE_SUPPORTS:
+        /* data is not changed, so reading from the lower layer directly is fine */
+        return zip_source_pass_to_lower_layer(src, data, len, cmd) | (*(zip_int64_t *)data & ZIP_SOURCE_MAKE_COMMAND_BITMASK(ZIP_SOURCE_READ_AT));
+
+    default:
+        return zip_source_pass_to_lower_layer(src, data, len, cmd);
+    }
+}
+
+
+/* XORs data with XOR_KEY, so the data of the lower layer can't be used directly */
+static zip_int64_t
+xor_callback(zip_source_t *src, void *ud, void *data, zip_uint64_t len, zip_source_cmd_t cmd) {
+    zip_int64_t n, i;
+
+    switch (cmd) {
+    case ZIP_SOURCE_READ:
+        if ((n = zip_source_read(src, data, len)) < 0) {
+            return -1;
+        }
+        for (i = 0; i < n; i++) {
+            ((zip_uint8_t *)data)[i] ^= XOR_KEY;
+        }
+        return n;
+
+    default:
+        return zip_source_pass_to_lower_layer(src, data, len, cmd);
+    }
+}
+
+
+static int
+source_read_at(char *argv[]) {
+    zip_source_t *src, *layered;
+    zip_error_t error;
+    zip_uint64_t offset, length;
+    zip_uint8_t buf[64];
+    zip_int64_t n;
+    int ret;
+
+    offset = strtoull(argv[1], NULL, 10);
+    length = ZIP_MIN(strtoull(argv[2], NULL, 10), sizeof(buf));
+
+    zip_error_init(&error);
+    if ((src = zip_source_file_create(argv[0], 0, -1, &error)) == NULL) {
+        fprintf(stderr, "can't open file '%s': %s\n", argv[0], zip_error_strerror(&error));
+        zip_error_fini(&error);
+        return -1;
+    }
+    if ((layered = zip_source_layered_create(src, short_read_at_callback, NULL, &error)) == NULL) {
+        fprintf(stderr, "can't create layered source: %s\n", zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        return -1;
+    }
+    zip_source_free(src);
+    zip_error_fini(&error);
+
+    if (zip_source_open(layered) < 0) {
+        fprintf(stderr, "can't open source: %s\n", zip_error_strerror(zip_source_error(layered)));
+        zip_source_free(layered);
+        return -1;
+    }
+
+    ret = 0;
+    if ((n = zip_source_read_at(layered, buf, length, offset)) < 0) {
+        fprintf(stderr, "can't read at offset %" PRIu64 ": %s\n", offset, zip_error_strerror(zip_source_error(layered)));
+        ret = -1;
+    }
+    else {
+        printf("read_at %" PRId64 " bytes: ", n);
+        hexdump(buf, (zip_uint16_t)n);
+        printf("\n");
+
+        /* read position must not have moved */
+        if ((n = zip_source_read(layered, buf, 4)) < 0) {
+            fprintf(stderr, "can't read: %s\n", zip_error_strerror(zip_source_error(layered)));
+            ret = -1;
+        }
+        else {
+            printf("read %" PRId64 " bytes: ", n);
+            hexdump(buf, (zip_uint16_t)n);
+            printf("\n");
+        }
+    }
+
+    zip_source_close(layered);
+    zip_source_free(layered);
+    return ret;
+}
+
+
+static int
+stream_list_unseekable(char *argv[]) {
+    zip_source_t *src, *layered;
+    zip_error_t error;
+
+    zip_error_init(&error);
+    if ((src = zip_source_file_create(argv[0], 0, -1, &error)) == NULL) {
+        fprintf(stderr, "can't open zip archive '%s': %s\n", argv[0], zip_error_strerror(&error));
+        zip_error_fini(&error);
+        return -1;
+    }
+    if ((layered = zip_source_layered_create(src, unseekable_callback, NULL, &error)) == NULL) {
+        fprintf(stderr, "can't create layered source: %s\n", zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        return -1;
+    }
+    zip_source_free(src);
+    zip_error_fini(&error);
+
+    return list_stream(argv[0], layered, argv[1]);
+}
+
+
+static int
+xor_read_all(char *argv[]) {
+    zip_source_t *src, *layered;
+    zip_t *xza;
+    zip_error_t error;
+    zip_int64_t i, n;
+    int ret;
+
+    zip_error_init(&error);
+    if (source_type == SOURCE_TYPE_IN_MEMORY) {
+        /* buffer source supports ZIP_SOURCE_GET_DATA */
+        FILE *fp;
+        struct stat st;
+        char *buf;
+
+        if ((fp = fopen(argv[0], "rb")) == NULL || fstat(fileno(fp), &st) < 0) {
+            fprintf(stderr, "can't open zip archive '%s': %s\n", argv[0], strerror(errno));
+            if (fp != NULL) {
+                fclose(fp);
+            }
+            zip_error_fini(&error);
+            return -1;
+        }
+        if ((buf = malloc((size_t)st.st_size)) == NULL || fread(buf, (size_t)st.st_size, 1, fp) < 1) {
+            fprintf(stderr, "can't read zip archive '%s'\n", argv[0]);
+            free(buf);
+            fclose(fp);
+            zip_error_fini(&error);
+            return -1;
+        }
+        fclose(fp);
+        if ((src = zip_source_buffer_create(buf, (zip_uint64_t)st.st_size, 1, &error)) == NULL) {
+            free(buf);
+        }
+    }
+    else {
+        src = zip_source_file_create(argv[0], 0, -1, &error);
+    }
+    if (src == NULL) {
+        fprintf(stderr, "can't open zip archive '%s': %s\n", argv[0], zip_error_strerror(&error));
+        zip_error_fini(&error);
+        return -1;
+    }
+    if ((layered = zip_source_layered_create(src, xor_callback, NULL, &error)) == NULL) {
+        fprintf(stderr, "can't create layered source: %s\n", zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        return -1;
+    }
+    zip_source_free(src);
+    if ((xza = zip_open_from_source(layered, ZIP_RDONLY, &error)) == NULL) {
+        fprintf(stderr, "can't open zip archive '%s': %s\n", argv[0], zip_error_strerror(&error));
+        zip_source_free(layered);
+        zip_error_fini(&error);
+        return -1;
+    }
+    zip_error_fini(&error);
+
+    ret = 0;
+    n = zip_get_num_entries(xza, 0);
+    for (i = 0; i < n && ret == 0; i++) {
+        zip_stat_t st;
+        zip_file_t *zf;
+        zip_uint8_t *streamed, *all;
+        zip_int64_t m;
+        zip_uint64_t length;
+
+        if (zip_stat_index(xza, (zip_uint64_t)i, 0, &st) < 0) {
+            fprintf(stderr, "can't stat entry %" PRId64 ": %s\n", i, zip_strerror(xza));
+            ret = -1;
+            break;
+        }
+        if ((streamed = (zip_uint8_t *)malloc(st.size + 1)) == NULL || (all = (zip_uint8_t *)malloc(st.size + 1)) == NULL) {
+            fprintf(stderr, "malloc failure\n");
+            free(streamed);
+            ret = -1;
+            break;
+        }
+
+        /* once as stream, once in one go */
+        if ((zf = zip_fopen_index(xza, (zip_uint64_t)i, 0)) == NULL) {
+            fprintf(stderr, "can't open entry %" PRId64 ": %s\n", i, zip_strerror(xza));
+            ret = -1;
+        }
+        else {
+            length = 0;
+            while ((m = zip_fread(zf, streamed + length, st.size + 1 - length)) > 0) {
+                length += (zip_uint64_t)m;
+            }
+            if (m < 0) {
+                fprintf(stderr, "can't read entry %" PRId64 ": %s\n", i, zip_file_strerror(zf));
+                ret = -1;
+            }
+            zip_fclose(zf);
+        }
+        if (ret == 0 && (m = zip_file_read_all(xza, (zip_uint64_t)i, all, st.size, 0)) < 0) {
+            fprintf(stderr, "can't read all of entry %" PRId64 ": %s\n", i, zip_strerror(xza));
+            ret = -1;
+        }
+        if (ret == 0) {
+            if (length != st.size || (zip_uint64_t)m != st.size || memcmp(streamed, all, st.size) != 0) {
+                fprintf(stderr, "data of entry %" PRId64 " read at once differs from streamed data\n", i);
+                ret = -1;
+            }
+            else {
+                printf("%s: %" PRIu64 " bytes\n", st.name, length);
+            }
+        }
+        free(streamed);
+        free(all);
+    }
+
+    zip_discard(xza);
+    return ret;
+}
+
+
 static int
 unchange_one(char *argv[]) {
     zip_uint64_t idx;
@@ -293,6 +790,86 @@ read_hole(const char *archive, int flags, zip_error_t *error) {
 }
 
 
+/* create index of archive in memory and reopen archive using it */
+static zip_t *
+read_with_index(const char *archive, int flags, zip_error_t *error) {
+    zip_source_t *src;
+    zip_t *zs;
+    zip_int64_t length;
+    void *index;
+    int err;
+
+    if ((zs = zip_open(archive, flags, &err)) == NULL) {
+        zip_error_set(error, err, errno);
+        return NULL;
+    }
+    if ((length = zip_get_index(zs, NULL, 0)) < 0) {
+        zip_error_set(error, zip_error_code_zip(zip_get_error(zs)), 0);
+        zip_discard(zs);
+        return NULL;
+    }
+    if ((index = malloc((size_t)length)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        zip_discard(zs);
+        return NULL;
+    }
+    if (zip_get_index(zs, index, (zip_uint64_t)length) < 0) {
+        zip_error_set(error, zip_error_code_zip(zip_get_error(zs)), 0);
+        free(index);
+        zip_discard(zs);
+        return NULL;
+    }
+    zip_discard(zs);
+
+    if ((src = zip_source_file_create(archive, 0, -1, error)) == NULL || (zs = zip_open_from_source_with_index(src, flags, index, (zip_uint64_t)length, error)) == NULL) {
+        zip_source_free(src);
+        zs = NULL;
+    }
+    free(index);
+
+    return zs;
+}
+
+
+/* write index file of archive and reopen archive using it */
+static zip_t *
+read_with_index_file(const char *archive, int flags, zip_error_t *error) {
+    zip_t *zs;
+    char *index_name;
+    size_t length = strlen(archive) + strlen(".zidx") + 1;
+    int err;
+
+    if ((index_name = (char *)malloc(length)) == NULL) {
+        zip_error_set(error, ZIP_ER_MEMORY, 0);
+        return NULL;
+    }
+    snprintf(index_name, length, "%s.zidx", archive);
+
+    if ((zs = zip_open(archive, flags, &err)) == NULL) {
+        zip_error_set(error, err, errno);
+        free(index_name);
+        return NULL;
+    }
+    if (zip_write_index(zs, index_name) < 0) {
+        zip_error_set(error, zip_error_code_zip(zip_get_error(zs)), zip_error_code_system(zip_get_error(zs)));
+        zip_discard(zs);
+        free(index_name);
+        return NULL;
+    }
+    zip_discard(zs);
+
+    zs = zip_open(archive, flags | ZIP_INDEX, &err);
+    /* archive keeps using index after it is removed */
+    remove(index_name);
+    free(index_name);
+    if (zs == NULL) {
+        zip_error_set(error, err, errno);
+    }
+
+    return zs;
+}
+
+
 static int get_whence(const char *str) {
     if (strcasecmp(str, "set") == 0) {
         return SEEK_SET;
@@ -571,6 +1148,14 @@ ziptool_open(const char *archive, int flags, zip_error_t *error, zip_uint64_t of
     case SOURCE_TYPE_HOLE:
         za = read_hole(archive, flags, error);
         break;
+
+    case SOURCE_TYPE_INDEX:
+        za = read_with_index(archive, flags, error);
+        break;
+
+    case SOURCE_TYPE_INDEX_FILE:
+        za = read_with_index_file(archive, flags, error);
+        break;
     }
 
     return za;
@@ -69,6 +69,7 @@ static zip_flags_t get_flags(const char *arg);
 static zip_int32_t get_compression_method(const char *arg);
 static zip_uint16_t get_encryption_method(const char *arg);
 static void hexdump(const zip_uint8_t *data, zip_uint16_t len);
+static int list_stream(const char *archive, zip_source_t *src, const char *password);
 int ziptool_post_close(const char *archive);
 
 #ifndef FOR_REGRESS
@@ -251,6 +252,91 @@ cat_partial(char *argv[]) {
     return cat_impl(idx, start, len);
 }
 
+static int
+cat_all(char *argv[]) {
+    /* output file contents to stdout, reading whole file at once */
+    zip_uint64_t idx;
+    zip_stat_t sb;
+    void *data;
+    zip_int64_t n;
+
+    idx = strtoull(argv[0], NULL, 10);
+
+#ifdef _WIN32
+    /* Need to set stdout to binary mode for Windows */
+    setmode(fileno(stdout), _O_BINARY);
+#endif
+    if (zip_stat_index(za, idx, 0, &sb) < 0) {
+        fprintf(stderr, "zip_stat_index failed on '%" PRIu64 "' failed: %s\n", idx, zip_strerror(za));
+        return -1;
+    }
+    if ((sb.valid & ZIP_STAT_SIZE) == 0 || sb.size > SIZE_MAX) {
+        fprintf(stderr, "can't get size of file at index '%" PRIu64 "'\n", idx);
+        return -1;
+    }
+    if ((data = malloc(sb.size > 0 ? (size_t)sb.size : 1)) == NULL) {
+        fprintf(stderr, "malloc failure\n");
+        return -1;
+    }
+    if ((n = zip_file_read_all(za, idx, data, sb.size, 0)) < 0) {
+        fprintf(stderr, "can't read file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        free(data);
+        return -1;
+    }
+    if (n > 0 && fwrite(data, (size_t)n, 1, stdout) != 1) {
+        fprintf(stderr, "can't write contents of file at index '%" PRIu64 "' to stdout: %s\n", idx, strerror(errno));
+        free(data);
+        return -1;
+    }
+    free(data);
+    return 0;
+}
+
+static int
+cat_files_callback(zip_t *archive, zip_uint64_t idx, const void *data, zip_uint64_t length, void *ud) {
+    (void)archive;
+    (void)ud;
+
+    if (length > 0 && fwrite(data, (size_t)length, 1, stdout) != 1) {
+        fprintf(stderr, "can't write contents of file at index '%" PRIu64 "' to stdout: %s\n", idx, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int
+cat_files(char *argv[]) {
+    /* output contents of all files to stdout */
+    zip_int64_t count;
+    zip_uint64_t *indices;
+    zip_uint64_t i;
+    int ret;
+
+    (void)argv;
+
+#ifdef _WIN32
+    /* Need to set stdout to binary mode for Windows */
+    setmode(fileno(stdout), _O_BINARY);
+#endif
+    if ((count = zip_get_num_entries(za, 0)) <= 0) {
+        return 0;
+    }
+    if ((indices = (zip_uint64_t *)malloc(sizeof(*indices) * (size_t)count)) == NULL) {
+        fprintf(stderr, "malloc failure\n");
+        return -1;
+    }
+    for (i = 0; i < (zip_uint64_t)count; i++) {
+        indices[i] = i;
+    }
+
+    if ((ret = zip_read_files(za, indices, (zip_uint64_t)count, 0, 0, cat_files_callback, NULL)) < 0) {
+        fprintf(stderr, "can't read files: %s\n", zip_strerror(za));
+    }
+    free(indices);
+
+    return ret;
+}
+
 static int
 count_extra(char *argv[]) {
     zip_int16_t count;
@@ -328,6 +414,47 @@ delete_extra_by_id(char *argv[]) {
     return 0;
 }
 
+static int
+dir_exists(char *argv[]) {
+    int ret;
+
+    if ((ret = zip_dir_exists(za, argv[0], 0)) < 0) {
+        fprintf(stderr, "can't check directory '%s': %s\n", argv[0], zip_strerror(za));
+        return -1;
+    }
+    printf("directory '%s' %s\n", argv[0], ret ? "exists" : "does not exist");
+    return 0;
+}
+
+static int
+dir_list(char *argv[]) {
+    zip_dir_list_t *list;
+    zip_flags_t flags;
+    const char *name;
+    zip_int64_t idx;
+
+    flags = get_flags(argv[1]);
+    if ((list = zip_dir_list_open(za, argv[0], flags)) == NULL) {
+        fprintf(stderr, "can't list directory '%s': %s\n", argv[0], zip_strerror(za));
+        return -1;
+    }
+    zip_error_clear(za);
+    while ((name = zip_dir_list_next(list, &idx)) != NULL) {
+        if (idx < 0) {
+            printf("name '%s' implicit directory\n", name);
+        }
+        else {
+            printf("name '%s' index %" PRId64 "\n", name, idx);
+        }
+    }
+    zip_dir_list_close(list);
+    if (zip_error_code_zip(zip_get_error(za)) != ZIP_ER_OK) {
+        fprintf(stderr, "can't list directory '%s': %s\n", argv[0], zip_strerror(za));
+        return -1;
+    }
+    return 0;
+}
+
 static int
 get_archive_comment(char *argv[]) {
     const char *comment;
@@ -340,6 +467,63 @@ get_archive_comment(char *argv[]) {
     return 0;
 }
 
+static int
+get_checkpoints(char *argv[]) {
+    zip_uint64_t idx;
+    zip_int64_t length;
+    void *data;
+    FILE *fp;
+
+    /* export checkpoints of entry to file */
+    idx = strtoull(argv[0], NULL, 10);
+    if ((length = zip_file_get_checkpoints(za, idx, NULL, 0)) < 0) {
+        fprintf(stderr, "can't get checkpoints for file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        return -1;
+    }
+    if ((data = malloc((size_t)length)) == NULL) {
+        fprintf(stderr, "malloc failure\n");
+        return -1;
+    }
+    if (zip_file_get_checkpoints(za, idx, data, (zip_uint64_t)length) < 0) {
+        fprintf(stderr, "can't get checkpoints for file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        free(data);
+        return -1;
+    }
+    if ((fp = fopen(argv[1], "wb")) == NULL) {
+        fprintf(stderr, "can't create '%s': %s\n", argv[1], strerror(errno));
+        free(data);
+        return -1;
+    }
+    if (fwrite(data, (size_t)length, 1, fp) != 1 || fclose(fp) != 0) {
+        fprintf(stderr, "can't write '%s': %s\n", argv[1], strerror(errno));
+        free(data);
+        return -1;
+    }
+    free(data);
+    return 0;
+}
+
+static int
+get_data(char *argv[]) {
+    const void *data;
+    zip_uint64_t idx, len;
+    /* output file data to stdout without copying it */
+    idx = strtoull(argv[0], NULL, 10);
+    if ((data = zip_file_get_data(za, idx, &len, 0)) == NULL) {
+        fprintf(stderr, "can't get data for file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        return -1;
+    }
+#ifdef _WIN32
+    /* Need to set stdout to binary mode for Windows */
+    setmode(fileno(stdout), _O_BINARY);
+#endif
+    if (len > 0 && fwrite(data, (size_t)len, 1, stdout) != 1) {
+        fprintf(stderr, "can't write file contents to stdout: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
 static int
 get_extra(char *argv[]) {
     zip_flags_t geflags;
@@ -431,6 +615,57 @@ name_locate(char *argv[]) {
     return 0;
 }
 
+static int
+name_locate_many(char *argv[]) {
+    const char **names;
+    zip_int64_t *indices, nfound;
+    zip_uint64_t i, nnames;
+    zip_flags_t flags;
+    char *p;
+
+    flags = get_flags(argv[1]);
+
+    nnames = 1;
+    for (p = argv[0]; (p = strchr(p, ',')) != NULL; p++) {
+        nnames++;
+    }
+    names = (const char **)malloc(sizeof(*names) * nnames);
+    indices = (zip_int64_t *)malloc(sizeof(*indices) * nnames);
+    if (names == NULL || indices == NULL) {
+        fprintf(stderr, "malloc failure\n");
+        free(names);
+        free(indices);
+        return -1;
+    }
+    p = argv[0];
+    for (i = 0; i < nnames; i++) {
+        names[i] = p;
+        if ((p = strchr(p, ',')) != NULL) {
+            *(p++) = '\0';
+        }
+    }
+
+    if ((nfound = zip_name_locate_many(za, names, nnames, indices, flags)) < 0) {
+        fprintf(stderr, "can't find entries using flags '%s': %s\n", argv[1], zip_strerror(za));
+        free(names);
+        free(indices);
+        return -1;
+    }
+    for (i = 0; i < nnames; i++) {
+        if (indices[i] < 0) {
+            printf("name '%s' using flags '%s' not found\n", names[i], argv[1]);
+        }
+        else {
+            printf("name '%s' using flags '%s' found at index %" PRId64 "\n", names[i], argv[1], indices[i]);
+        }
+    }
+    printf("%" PRId64 " of %" PRIu64 " names found\n", nfound, nnames);
+
+    free(names);
+    free(indices);
+    return 0;
+}
+
 struct progress_userdata_s {
     double percentage;
     double limit;
@@ -461,6 +696,28 @@ zrename(char *argv[]) {
     return 0;
 }
 
+static int
+refresh(char *argv[]) {
+    /* read entries added to archive, which is now in file archivename */
+    zip_source_t *src;
+    zip_error_t error;
+
+    zip_error_init(&error);
+    if ((src = zip_source_file_create(argv[0], 0, -1, &error)) == NULL) {
+        fprintf(stderr, "can't open file '%s': %s\n", argv[0], zip_error_strerror(&error));
+        zip_error_fini(&error);
+        return -1;
+    }
+    zip_error_fini(&error);
+
+    if (zip_refresh(za, src) < 0) {
+        fprintf(stderr, "can't refresh archive from '%s': %s\n", argv[0], zip_strerror(za));
+        zip_source_free(src);
+        return -1;
+    }
+    return 0;
+}
+
 static int
 replace_file_contents(char *argv[]) {
     /* replace file contents with data from command line */
@@ -504,6 +761,63 @@ set_archive_comment(char *argv[]) {
     return 0;
 }
 
+static int
+set_checkpoint_interval(char *argv[]) {
+    zip_uint64_t interval;
+
+    interval = strtoull(argv[0], NULL, 10);
+    if (zip_set_checkpoint_interval(za, interval) < 0) {
+        fprintf(stderr, "can't set checkpoint interval to %" PRIu64 ": %s\n", interval, zip_strerror(za));
+        return -1;
+    }
+    return 0;
+}
+
+static int
+set_checkpoints(char *argv[]) {
+    zip_uint64_t idx;
+    char *data;
+    size_t length, n;
+    FILE *fp;
+
+    /* import checkpoints of entry from file */
+    idx = strtoull(argv[0], NULL, 10);
+    if ((fp = fopen(argv[1], "rb")) == NULL) {
+        fprintf(stderr, "can't open '%s': %s\n", argv[1], strerror(errno));
+        return -1;
+    }
+    data = NULL;
+    length = 0;
+    do {
+        char *tmp;
+
+        if ((tmp = (char *)realloc(data, length + 8192)) == NULL) {
+            fprintf(stderr, "malloc failure\n");
+            free(data);
+            fclose(fp);
+            return -1;
+        }
+        data = tmp;
+        n = fread(data + length, 1, 8192, fp);
+        length += n;
+    } while (n == 8192);
+    if (ferror(fp)) {
+        fprintf(stderr, "can't read '%s': %s\n", argv[1], strerror(errno));
+        free(data);
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    if (zip_file_set_checkpoints(za, idx, data, length) < 0) {
+        fprintf(stderr, "can't set checkpoints for file at index '%" PRIu64 "': %s\n", idx, zip_strerror(za));
+        free(data);
+        return -1;
+    }
+    free(data);
+    return 0;
+}
+
 static int
 set_file_comment(char *argv[]) {
     zip_uint64_t idx;
@@ -608,6 +922,90 @@ set_password(char *argv[]) {
     return 0;
 }
 
+static int
+set_readahead(char *argv[]) {
+    zip_uint64_t length;
+
+    length = strtoull(argv[0], NULL, 10);
+    if (zip_set_readahead(za, length) < 0) {
+        fprintf(stderr, "can't set read-ahead to %" PRIu64 ": %s\n", length, zip_strerror(za));
+        return -1;
+    }
+    return 0;
+}
+
+static int
+stream_list(char *argv[]) {
+    /* read archive sequentially, without using central directory */
+    zip_source_t *src;
+    zip_error_t error;
+
+    zip_error_init(&error);
+    if ((src = zip_source_file_create(argv[0], 0, -1, &error)) == NULL) {
+        fprintf(stderr, "can't open zip archive '%s': %s\n", argv[0], zip_error_strerror(&error));
+        zip_error_fini(&error);
+        return -1;
+    }
+    zip_error_fini(&error);
+
+    return list_stream(argv[0], src, argv[1]);
+}
+
+static int
+list_stream(const char *archive, zip_source_t *src, const char *password) {
+    zip_stream_t *zs;
+    zip_stat_t sb;
+    zip_error_t error;
+    int ret;
+
+    zip_error_init(&error);
+    if ((zs = zip_stream_open(src, &error)) == NULL) {
+        fprintf(stderr, "can't open zip archive '%s': %s\n", archive, zip_error_strerror(&error));
+        zip_source_free(src);
+        zip_error_fini(&error);
+        return -1;
+    }
+    zip_error_fini(&error);
+    if (strlen(password) > 0 && zip_stream_set_default_password(zs, password) < 0) {
+        fprintf(stderr, "can't set default password to '%s'\n", password);
+        zip_stream_close(zs);
+        return -1;
+    }
+
+    while ((ret = zip_stream_next(zs, &sb)) > 0) {
+        zip_file_t *zf;
+        zip_uint64_t size;
+        zip_int64_t n;
+        char buf[8192];
+
+        if ((zf = zip_stream_fopen(zs, 0)) == NULL) {
+            fprintf(stderr, "can't open entry '%s': %s\n", sb.name, zip_error_strerror(zip_stream_get_error(zs)));
+            zip_stream_close(zs);
+            return -1;
+        }
+        size = 0;
+        while ((n = zip_fread(zf, buf, sizeof(buf))) > 0) {
+            size += (zip_uint64_t)n;
+        }
+        if (n < 0) {
+            fprintf(stderr, "can't read entry '%s': %s\n", sb.name, zip_file_strerror(zf));
+            zip_fclose(zf);
+            zip_stream_close(zs);
+            return -1;
+        }
+        zip_fclose(zf);
+        printf("%s: %" PRIu64 " bytes\n", sb.name, size);
+    }
+    if (ret < 0) {
+        fprintf(stderr, "can't read zip archive '%s': %s\n", archive, zip_error_strerror(zip_stream_get_error(zs)));
+        zip_stream_close(zs);
+        return -1;
+    }
+    zip_stream_close(zs);
+
+    return 0;
+}
+
 static int
 zstat(char *argv[]) {
     zip_uint64_t idx;
@@ -664,6 +1062,8 @@ get_flags(const char *arg) {
         flags |= ZIP_FL_NODIR;
     if (strchr(arg, 'l') != NULL)
         flags |= ZIP_FL_LOCAL;
+    if (strchr(arg, 'R') != NULL)
+        flags |= ZIP_FL_RECURSIVE;
     if (strchr(arg, 'u') != NULL)
         flags |= ZIP_FL_UNCHANGED;
     if (strchr(arg, '8') != NULL)
@@ -779,22 +1179,32 @@ dispatch_table_t dispatch_table[] = {{"add", 2, "name content", "add file called
                                      {"add_file", 4, "name file_to_add offset len", "add file to archive, len bytes starting from offset", add_file},
                                      {"add_from_zip", 5, "name archivename index offset len", "add file from another archive, len bytes starting from offset", add_from_zip},
                                      {"cat", 1, "index", "output file contents to stdout", cat},
+                                     {"cat_all", 1, "index", "output file contents to stdout, reading whole file at once", cat_all},
+                                     {"cat_files", 0, "", "output contents of all files to stdout", cat_files},
                                      {"cat_partial", 3, "index start length", "output partial file contents to stdout", cat_partial},
                                      {"count_extra", 2, "index flags", "show number of extra fields for archive entry", count_extra},
                                      {"count_extra_by_id", 3, "index extra_id flags", "show number of extra fields of type extra_id for archive entry", count_extra_by_id},
                                      {"delete", 1, "index", "remove entry", delete},
                                      {"delete_extra", 3, "index extra_idx flags", "remove extra field", delete_extra},
                                      {"delete_extra_by_id", 4, "index extra_id extra_index flags", "remove extra field of type extra_id", delete_extra_by_id},
+                                     {"dir_exists", 1, "name", "check if directory exists, explicitly or implicitly", dir_exists},
+                                     {"dir_list", 2, "prefix flags", "list entries in directory", dir_list},
                                      {"get_archive_comment", 0, "", "show archive comment", get_archive_comment},
+                                     {"get_checkpoints", 2, "index file", "write checkpoints for seeking in file to file", get_checkpoints},
+                                     {"get_data", 1, "index", "output file data to stdout without copying it", get_data},
                                      {"get_extra", 3, "index extra_index flags", "show extra field", get_extra},
                                      {"get_extra_by_id", 4, "index extra_id extra_index flags", "show extra field of type extra_id", get_extra_by_id},
                                      {"get_file_comment", 1, "index", "get file comment", get_file_comment},
                                      {"get_num_entries", 1, "flags", "get number of entries in archive", get_num_entries},
                                      {"name_locate", 2, "name flags", "find entry in archive", name_locate},
+                                     {"name_locate_many", 2, "names flags", "find entries in archive, names separated by commas", name_locate_many},
                                      {"print_progress", 0, "", "print progress during zip_close()", print_progress},
+                                     {"refresh", 1, "archivename", "read entries added to archive, which is now in file archivename", refresh},
                                      {"rename", 2, "index name", "rename entry", zrename},
                                      {"replace_file_contents", 2, "index data", "replace entry with data", replace_file_contents},
                                      {"set_archive_comment", 1, "comment", "set archive comment", set_archive_comment},
+                                     {"set_checkpoint_interval", 1, "interval", "record checkpoints for seeking in deflated files every interval bytes", set_checkpoint_interval},
+                                     {"set_checkpoints", 2, "index file", "read checkpoints for seeking in file from file", set_checkpoints},
                                      {"set_extra", 5, "index extra_id extra_index flags value", "set extra field", set_extra},
                                      {"set_file_comment", 2, "index comment", "set file comment", set_file_comment},
                                      {"set_file_compression", 3, "index method compression_flags", "set file compression method", set_file_compression},
@@ -803,7 +1213,9 @@ dispatch_table_t dispatch_table[] = {{"add", 2, "name content", "add file called
                                      {"set_file_mtime", 2, "index timestamp", "set file modification time", set_file_mtime},
                                      {"set_file_mtime_all", 1, "timestamp", "set file modification time for all files", set_file_mtime_all},
                                      {"set_password", 1, "password", "set default password for encryption", set_password},
-                                     {"stat", 1, "index", "print information about entry", zstat}
+                                     {"set_readahead", 1, "length", "announce length bytes of following files when opening a file", set_readahead},
+                                     {"stat", 1, "index", "print information about entry", zstat},
+                                     {"stream_list", 2, "archivename password", "read other archive sequentially and list its entries", stream_list}
 #ifdef DISPATCH_REGRESS
                                      ,
                                      DISPATCH_REGRESS